@@ -0,0 +1,30 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/src/build_config.cc" "CMakeFiles/dmlc.dir/src/build_config.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/build_config.cc.o.d"
+  "/root/repo/src/config.cc" "CMakeFiles/dmlc.dir/src/config.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/config.cc.o.d"
+  "/root/repo/src/data.cc" "CMakeFiles/dmlc.dir/src/data.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/data.cc.o.d"
+  "/root/repo/src/io.cc" "CMakeFiles/dmlc.dir/src/io.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/io.cc.o.d"
+  "/root/repo/src/io/filesys.cc" "CMakeFiles/dmlc.dir/src/io/filesys.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/io/filesys.cc.o.d"
+  "/root/repo/src/io/indexed_recordio_split.cc" "CMakeFiles/dmlc.dir/src/io/indexed_recordio_split.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/io/indexed_recordio_split.cc.o.d"
+  "/root/repo/src/io/input_split_base.cc" "CMakeFiles/dmlc.dir/src/io/input_split_base.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/io/input_split_base.cc.o.d"
+  "/root/repo/src/io/line_split.cc" "CMakeFiles/dmlc.dir/src/io/line_split.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/io/line_split.cc.o.d"
+  "/root/repo/src/io/local_filesys.cc" "CMakeFiles/dmlc.dir/src/io/local_filesys.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/io/local_filesys.cc.o.d"
+  "/root/repo/src/io/recordio_split.cc" "CMakeFiles/dmlc.dir/src/io/recordio_split.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/io/recordio_split.cc.o.d"
+  "/root/repo/src/recordio.cc" "CMakeFiles/dmlc.dir/src/recordio.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/recordio.cc.o.d"
+  "/root/repo/src/trace.cc" "CMakeFiles/dmlc.dir/src/trace.cc.o" "gcc" "CMakeFiles/dmlc.dir/src/trace.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,33 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/dmlc.dir/src/build_config.cc.o"
+  "CMakeFiles/dmlc.dir/src/build_config.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/config.cc.o"
+  "CMakeFiles/dmlc.dir/src/config.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/data.cc.o"
+  "CMakeFiles/dmlc.dir/src/data.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/io.cc.o"
+  "CMakeFiles/dmlc.dir/src/io.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/io/filesys.cc.o"
+  "CMakeFiles/dmlc.dir/src/io/filesys.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/io/indexed_recordio_split.cc.o"
+  "CMakeFiles/dmlc.dir/src/io/indexed_recordio_split.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/io/input_split_base.cc.o"
+  "CMakeFiles/dmlc.dir/src/io/input_split_base.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/io/line_split.cc.o"
+  "CMakeFiles/dmlc.dir/src/io/line_split.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/io/local_filesys.cc.o"
+  "CMakeFiles/dmlc.dir/src/io/local_filesys.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/io/recordio_split.cc.o"
+  "CMakeFiles/dmlc.dir/src/io/recordio_split.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/recordio.cc.o"
+  "CMakeFiles/dmlc.dir/src/recordio.cc.o.d"
+  "CMakeFiles/dmlc.dir/src/trace.cc.o"
+  "CMakeFiles/dmlc.dir/src/trace.cc.o.d"
+  "libdmlc.a"
+  "libdmlc.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/dmlc.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
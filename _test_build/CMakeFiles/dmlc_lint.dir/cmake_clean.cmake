@@ -0,0 +1,8 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/dmlc_lint"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang )
+  include(CMakeFiles/dmlc_lint.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,50 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/test/unittest/unittest_any.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_any.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_any.cc.o.d"
+  "/root/repo/test/unittest/unittest_array_view.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_array_view.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_array_view.cc.o.d"
+  "/root/repo/test/unittest/unittest_arrow_parser.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_arrow_parser.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_arrow_parser.cc.o.d"
+  "/root/repo/test/unittest/unittest_batch_row_iter.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_batch_row_iter.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_batch_row_iter.cc.o.d"
+  "/root/repo/test/unittest/unittest_compact_row_block.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_compact_row_block.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_compact_row_block.cc.o.d"
+  "/root/repo/test/unittest/unittest_config.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_config.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_config.cc.o.d"
+  "/root/repo/test/unittest/unittest_dataset_stats.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_dataset_stats.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_dataset_stats.cc.o.d"
+  "/root/repo/test/unittest/unittest_disk_row_iter.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_disk_row_iter.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_disk_row_iter.cc.o.d"
+  "/root/repo/test/unittest/unittest_env.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_env.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_env.cc.o.d"
+  "/root/repo/test/unittest/unittest_inputsplit.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_inputsplit.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_inputsplit.cc.o.d"
+  "/root/repo/test/unittest/unittest_json.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_json.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_json.cc.o.d"
+  "/root/repo/test/unittest/unittest_lazy_text_iter.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_lazy_text_iter.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_lazy_text_iter.cc.o.d"
+  "/root/repo/test/unittest/unittest_lockfree.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_lockfree.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_lockfree.cc.o.d"
+  "/root/repo/test/unittest/unittest_logging.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_logging.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_logging.cc.o.d"
+  "/root/repo/test/unittest/unittest_main.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_main.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_main.cc.o.d"
+  "/root/repo/test/unittest/unittest_metrics.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_metrics.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_metrics.cc.o.d"
+  "/root/repo/test/unittest/unittest_optional.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_optional.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_optional.cc.o.d"
+  "/root/repo/test/unittest/unittest_param.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_param.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_param.cc.o.d"
+  "/root/repo/test/unittest/unittest_parser.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_parser.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_parser.cc.o.d"
+  "/root/repo/test/unittest/unittest_quantile_sketch.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_quantile_sketch.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_quantile_sketch.cc.o.d"
+  "/root/repo/test/unittest/unittest_row_block_recordio.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_recordio.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_recordio.cc.o.d"
+  "/root/repo/test/unittest/unittest_row_block_text_writer.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_text_writer.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_text_writer.cc.o.d"
+  "/root/repo/test/unittest/unittest_serializer.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_serializer.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_serializer.cc.o.d"
+  "/root/repo/test/unittest/unittest_shared_row_iter.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_shared_row_iter.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_shared_row_iter.cc.o.d"
+  "/root/repo/test/unittest/unittest_sparse_kernel.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_sparse_kernel.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_sparse_kernel.cc.o.d"
+  "/root/repo/test/unittest/unittest_tempdir.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_tempdir.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_tempdir.cc.o.d"
+  "/root/repo/test/unittest/unittest_thread_group.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_thread_group.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_thread_group.cc.o.d"
+  "/root/repo/test/unittest/unittest_thread_local.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_thread_local.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_thread_local.cc.o.d"
+  "/root/repo/test/unittest/unittest_threaditer.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer.cc.o.d"
+  "/root/repo/test/unittest/unittest_threaditer_exc_handling.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer_exc_handling.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer_exc_handling.cc.o.d"
+  "/root/repo/test/unittest/unittest_trace.cc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_trace.cc.o" "gcc" "test/unittest/CMakeFiles/dmlc_unit_tests.dir/unittest_trace.cc.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  "/root/repo/_test_build/CMakeFiles/dmlc.dir/DependInfo.cmake"
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
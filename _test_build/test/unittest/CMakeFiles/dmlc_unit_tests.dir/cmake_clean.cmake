@@ -0,0 +1,71 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_any.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_any.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_array_view.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_array_view.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_arrow_parser.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_arrow_parser.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_batch_row_iter.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_batch_row_iter.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_compact_row_block.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_compact_row_block.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_config.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_config.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_dataset_stats.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_dataset_stats.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_disk_row_iter.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_disk_row_iter.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_env.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_env.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_inputsplit.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_inputsplit.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_json.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_json.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_lazy_text_iter.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_lazy_text_iter.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_lockfree.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_lockfree.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_logging.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_logging.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_main.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_main.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_metrics.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_metrics.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_optional.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_optional.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_param.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_param.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_parser.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_parser.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_quantile_sketch.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_quantile_sketch.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_recordio.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_recordio.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_text_writer.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_row_block_text_writer.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_serializer.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_serializer.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_shared_row_iter.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_shared_row_iter.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_sparse_kernel.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_sparse_kernel.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_tempdir.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_tempdir.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_thread_group.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_thread_group.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_thread_local.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_thread_local.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer_exc_handling.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_threaditer_exc_handling.cc.o.d"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_trace.cc.o"
+  "CMakeFiles/dmlc_unit_tests.dir/unittest_trace.cc.o.d"
+  "dmlc_unit_tests"
+  "dmlc_unit_tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/dmlc_unit_tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
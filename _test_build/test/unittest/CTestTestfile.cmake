@@ -0,0 +1,8 @@
+# CMake generated Testfile for 
+# Source directory: /root/repo/test/unittest
+# Build directory: /root/repo/_test_build/test/unittest
+# 
+# This file includes the relevant testing commands required for 
+# testing this directory and lists subdirectories to be tested as well.
+add_test(AllTestsInDMLCUnitTests "/dmlc_unit_tests")
+set_tests_properties(AllTestsInDMLCUnitTests PROPERTIES  _BACKTRACE_TRIPLES "/root/repo/test/unittest/CMakeLists.txt;64;add_test;/root/repo/test/unittest/CMakeLists.txt;0;")
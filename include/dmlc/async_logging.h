@@ -0,0 +1,272 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file async_logging.h
+ * \brief asynchronous backend of the logging macros, enabled by
+ *  compiling with DMLC_LOG_ASYNC=1 and disabled at run time by
+ *  setting the environment variable DMLC_LOG_ASYNC=0
+ */
+#ifndef DMLC_ASYNC_LOGGING_H_
+#define DMLC_ASYNC_LOGGING_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "./base.h"
+
+namespace dmlc {
+/*!
+ * \brief asynchronous log writer.
+ *  Each thread appends its messages to a ring buffer of its own without locking,
+ *  a background thread drains the buffers periodically and writes them in
+ *  batches. When the buffer of a thread is full the message is dropped and
+ *  counted, the count of dropped messages is written with the next batch.
+ *  Messages of one thread keep their order, messages of different threads
+ *  may interleave differently than they were logged.
+ */
+class AsyncLogger {
+ public:
+  /*! \brief writes a batch of log text */
+  typedef std::function<void(const char *data, size_t size)> Sink;
+  /*! \brief default number of messages buffered per thread */
+  static const size_t kDefaultCapacity = 4096;
+  /*! \brief interval between two flushes of the background thread in milliseconds */
+  static const int kFlushIntervalMs = 10;
+  /*!
+   * \brief constructor, starts the background thread
+   * \param capacity number of messages buffered per thread
+   * \param sink where the log text goes, standard error if empty
+   */
+  explicit AsyncLogger(size_t capacity = kDefaultCapacity, Sink sink = Sink())
+      : capacity_(capacity), sink_(sink), id_(NextId()),
+        stopped_(false), dropped_(0), reported_dropped_(0) {
+    if (!sink_) {
+      sink_ = [](const char *data, size_t size) {
+#ifdef __ANDROID__
+        std::fwrite(data, 1, size, stdout);
+        std::fflush(stdout);
+#else
+        std::fwrite(data, 1, size, stderr);
+        std::fflush(stderr);
+#endif
+      };
+    }
+    flusher_ = std::thread([this]() { this->RunFlusher(); });
+  }
+  /*! \brief destructor, writes the pending messages */
+  ~AsyncLogger() {
+    this->Stop();
+  }
+  /*!
+   * \return the logger used by the logging macros. It is disabled, writing
+   *  synchronously, when the environment variable DMLC_LOG_ASYNC is 0.
+   */
+  static AsyncLogger *Get() {
+    // never destroyed so that logging in static destructors stays valid,
+    // pending messages are written by Stop at exit
+    static AsyncLogger *inst = Create();
+    return inst;
+  }
+  /*!
+   * \brief log a message without blocking, it may be dropped if the buffer
+   *  of the calling thread is full
+   * \param msg the message with its trailing newline, its content is taken
+   */
+  void Push(std::string *msg) {
+    if (stopped_.load(std::memory_order_acquire)) {
+      std::lock_guard<std::mutex> lock(drain_mutex_);
+      sink_(msg->data(), msg->length());
+      return;
+    }
+    Ring *ring = this->LocalRing();
+    const size_t head = ring->head.load(std::memory_order_relaxed);
+    const size_t tail = ring->tail.load(std::memory_order_acquire);
+    if (head - tail == capacity_) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    ring->slots[head % capacity_].swap(*msg);
+    ring->head.store(head + 1, std::memory_order_release);
+    if (head - tail + 1 == capacity_ / 2) {
+      // wake the flusher early when the buffer fills up
+      cond_.notify_one();
+    }
+  }
+  /*! \brief write all the messages logged so far, blocks until they are written */
+  void Flush() {
+    this->Drain();
+  }
+  /*!
+   * \brief write the pending messages and stop the background thread,
+   *  later messages are written synchronously
+   */
+  void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (stopped_.load()) return;
+      stopped_.store(true, std::memory_order_release);
+    }
+    cond_.notify_one();
+    if (flusher_.joinable()) flusher_.join();
+    this->Drain();
+  }
+  /*! \return number of messages dropped because a buffer was full */
+  size_t NumDropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  /*! \brief single producer, single consumer ring of messages */
+  struct Ring {
+    std::vector<std::string> slots;
+    std::atomic<size_t> head;
+    std::atomic<size_t> tail;
+    std::atomic<bool> closed;
+    explicit Ring(size_t capacity) : slots(capacity), head(0), tail(0), closed(false) {}
+  };
+  /*! \brief rings of the calling thread, marked closed when the thread exits */
+  struct LocalRings {
+    std::vector<std::pair<uint64_t, std::shared_ptr<Ring> > > rings;
+    ~LocalRings() {
+      for (size_t i = 0; i < rings.size(); ++i) {
+        rings[i].second->closed.store(true, std::memory_order_release);
+      }
+    }
+  };
+  /*! \brief number of messages buffered per thread */
+  size_t capacity_;
+  /*! \brief where the log text goes */
+  Sink sink_;
+  /*! \brief identifies the logger in the thread local rings */
+  uint64_t id_;
+  /*! \brief rings of all the threads that logged */
+  std::vector<std::shared_ptr<Ring> > rings_;
+  /*! \brief protects rings_ and the wake up of the flusher */
+  std::mutex mutex_;
+  /*! \brief wakes the flusher */
+  std::condition_variable cond_;
+  /*! \brief serializes the consumers of the rings and the sink */
+  std::mutex drain_mutex_;
+  /*! \brief whether the flusher stopped */
+  std::atomic<bool> stopped_;
+  /*! \brief number of dropped messages */
+  std::atomic<size_t> dropped_;
+  /*! \brief number of dropped messages already reported */
+  size_t reported_dropped_;
+  /*! \brief the background thread */
+  std::thread flusher_;
+  /*! \return a new logger identifier */
+  static uint64_t NextId() {
+    static std::atomic<uint64_t> next(0);
+    return next++;
+  }
+  /*! \return the logger of the logging macros, see Get */
+  static AsyncLogger *Create() {
+    AsyncLogger *logger = new AsyncLogger();
+    const char *env = std::getenv("DMLC_LOG_ASYNC");
+    if (env != NULL && std::strcmp(env, "0") == 0) logger->Stop();
+    std::atexit([]() { Get()->Stop(); });
+    return logger;
+  }
+  /*! \return the ring of the calling thread, registered on first use */
+  Ring *LocalRing() {
+    static thread_local LocalRings local;
+    for (size_t i = 0; i < local.rings.size(); ++i) {
+      if (local.rings[i].first == id_) return local.rings[i].second.get();
+    }
+    std::shared_ptr<Ring> ring = std::make_shared<Ring>(capacity_);
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      rings_.push_back(ring);
+    }
+    local.rings.push_back(std::make_pair(id_, ring));
+    return ring.get();
+  }
+  /*! \brief write the messages of all the rings */
+  void Drain() {
+    std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+    std::vector<std::shared_ptr<Ring> > rings;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      rings = rings_;
+    }
+    std::string batch;
+    for (size_t i = 0; i < rings.size(); ++i) {
+      Ring *ring = rings[i].get();
+      const size_t tail = ring->tail.load(std::memory_order_relaxed);
+      const size_t head = ring->head.load(std::memory_order_acquire);
+      for (size_t pos = tail; pos != head; ++pos) {
+        std::string &slot = ring->slots[pos % capacity_];
+        batch += slot;
+        slot.clear();
+      }
+      ring->tail.store(head, std::memory_order_release);
+    }
+    const size_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_) {
+      batch += "[async logging] " + std::to_string(dropped - reported_dropped_) +
+          " messages dropped\n";
+      reported_dropped_ = dropped;
+    }
+    if (batch.length() != 0) sink_(batch.data(), batch.length());
+    // forget the rings of the threads that exited once they are empty
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < rings_.size();) {
+      Ring *ring = rings_[i].get();
+      if (ring->closed.load(std::memory_order_acquire) &&
+          ring->tail.load() == ring->head.load(std::memory_order_acquire)) {
+        rings_[i] = rings_.back();
+        rings_.pop_back();
+      } else {
+        ++i;
+      }
+    }
+  }
+  /*! \brief body of the background thread */
+  void RunFlusher() {
+    const int interval = kFlushIntervalMs;
+    while (!stopped_.load(std::memory_order_acquire)) {
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait_for(lock, std::chrono::milliseconds(interval),
+                       [this]() { return stopped_.load(); });
+      }
+      this->Drain();
+    }
+  }
+};
+
+/*!
+ * \return the current time of day as hh:mm:ss, formatted again only
+ *  when the second changes
+ */
+inline const char *CachedHumanDate() {
+  static thread_local time_t last = static_cast<time_t>(-1);
+  static thread_local char buffer[9];
+  time_t now = time(NULL);
+  if (now != last) {
+    struct tm *pnow;
+#if !defined(_WIN32)
+    struct tm tm_now;
+    pnow = localtime_r(&now, &tm_now);
+#else
+    pnow = localtime(&now);  // NOLINT(*)
+#endif
+    snprintf(buffer, sizeof(buffer), "%02d:%02d:%02d",
+             pnow->tm_hour, pnow->tm_min, pnow->tm_sec);
+    last = now;
+  }
+  return buffer;
+}
+}  // namespace dmlc
+#endif  // DMLC_ASYNC_LOGGING_H_
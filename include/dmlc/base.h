@@ -37,6 +37,23 @@
 #define DMLC_LOG_CUSTOMIZE 0
 #endif
 
+/*!
+ * \brief Whether LOG(INFO), LOG(WARNING) and LOG(ERROR) go through the
+ *  asynchronous logger of dmlc/async_logging.h instead of writing to stderr
+ *  directly, it can still be disabled at run time with DMLC_LOG_ASYNC=0.
+ */
+#ifndef DMLC_LOG_ASYNC
+#define DMLC_LOG_ASYNC 0
+#endif
+
+/*!
+ * \brief Whether the DMLC_TRACE_SCOPE macros of dmlc/trace.h record the
+ *  hot paths of the io and parsing pipeline, they compile to nothing otherwise.
+ */
+#ifndef DMLC_ENABLE_TRACE
+#define DMLC_ENABLE_TRACE 0
+#endif
+
 /*! \brief whether compile with hdfs support */
 #ifndef DMLC_USE_HDFS
 #define DMLC_USE_HDFS 0
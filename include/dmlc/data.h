@@ -7,6 +7,8 @@
 #ifndef DMLC_DATA_H_
 #define DMLC_DATA_H_
 
+#include <algorithm>
+#include <memory>
 #include <string>
 #include <vector>
 #include <map>
@@ -235,6 +237,144 @@ struct RowBlock {
   }
 };
 
+/*!
+ * \brief statistics of a dataset, collected while the data is first read
+ *  so that consumers do not need an extra pass over the data.
+ *  Feature occurrence counts are exact for indices below kExactFeatures,
+ *  larger indices are counted in a count-min sketch whose estimates never
+ *  fall below the true count.
+ */
+struct DatasetStats {
+  /*! \brief maximum number of distinct labels in the histogram */
+  static const size_t kMaxLabels = 1024;
+  /*! \brief feature indices below it are counted exactly */
+  static const size_t kExactFeatures = 1UL << 16UL;
+  /*! \brief width of each row of the count-min sketch */
+  static const size_t kSketchWidth = 1UL << 14UL;
+  /*! \brief number of rows of the count-min sketch */
+  static const size_t kSketchDepth = 4;
+  /*! \brief number of rows */
+  uint64_t num_row;
+  /*! \brief number of non-zero entries */
+  uint64_t num_nonzero;
+  /*! \brief maximum feature index plus one */
+  uint64_t num_col;
+  /*! \brief maximum field index plus one, 0 if the data has no field */
+  uint64_t num_field;
+  /*! \brief number of rows of each label */
+  std::map<real_t, uint64_t> label_count;
+  /*! \brief whether some labels were dropped from label_count, beyond kMaxLabels */
+  bool label_overflow;
+  /*! \brief exact occurrence counts of the features below kExactFeatures */
+  std::vector<uint64_t> feature_count;
+  /*! \brief count-min sketch of the other features, kSketchDepth x kSketchWidth */
+  std::vector<uint64_t> feature_sketch;
+  /*! \brief constructor */
+  DatasetStats() {
+    this->Clear();
+  }
+  /*! \brief clear the statistics */
+  inline void Clear() {
+    num_row = num_nonzero = num_col = num_field = 0;
+    label_count.clear();
+    label_overflow = false;
+    feature_count.clear();
+    feature_sketch.clear();
+  }
+  /*!
+   * \brief add the rows of a block
+   * \param batch the rows to add
+   */
+  template<typename IndexType, typename DType>
+  inline void Add(const RowBlock<IndexType, DType> &batch);
+  /*!
+   * \brief occurrence count of a feature
+   * \param index the feature index
+   * \return the count, an upper bound for indices not below kExactFeatures
+   */
+  inline uint64_t FeatureCount(uint64_t index) const {
+    if (index < kExactFeatures) {
+      return index < feature_count.size() ? feature_count[index] : 0;
+    }
+    if (feature_sketch.empty()) return 0;
+    uint64_t ret = feature_sketch[SketchBucket(index, 0)];
+    for (size_t d = 1; d < kSketchDepth; ++d) {
+      ret = std::min(ret, feature_sketch[d * kSketchWidth + SketchBucket(index, d)]);
+    }
+    return ret;
+  }
+  /*!
+   * \brief save the statistics to a stream
+   * \param fo the output stream
+   */
+  inline void Save(Stream *fo) const {
+    fo->Write(num_row);
+    fo->Write(num_nonzero);
+    fo->Write(num_col);
+    fo->Write(num_field);
+    fo->Write(label_count);
+    fo->Write(label_overflow);
+    fo->Write(feature_count);
+    fo->Write(feature_sketch);
+  }
+  /*!
+   * \brief load the statistics from a stream
+   * \param fi the input stream
+   * \return false if the stream ends early
+   */
+  inline bool Load(Stream *fi) {
+    return fi->Read(&num_row) && fi->Read(&num_nonzero) &&
+        fi->Read(&num_col) && fi->Read(&num_field) &&
+        fi->Read(&label_count) && fi->Read(&label_overflow) &&
+        fi->Read(&feature_count) && fi->Read(&feature_sketch);
+  }
+
+ private:
+  /*! \brief bucket of a feature in row d of the sketch */
+  inline static size_t SketchBucket(uint64_t index, size_t d) {
+    static const uint64_t kMul[kSketchDepth] = {
+      0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL,
+      0x94d049bb133111ebULL, 0xd6e8feb86659fd93ULL};
+    uint64_t h = (index ^ (index >> 29)) * kMul[d];
+    return static_cast<size_t>((h ^ (h >> 32)) % kSketchWidth);
+  }
+};
+
+/*!
+ * \brief random access to the pages of a dataset cached on disk,
+ *  for external memory algorithms that schedule their own reads.
+ *  Decoded pages are kept in a least recently used cache within a memory budget.
+ *  The methods are thread safe.
+ * \tparam IndexType type of index in RowBlock
+ * \tparam DType type of label and value in RowBlock
+ */
+template<typename IndexType, typename DType = real_t>
+class RowBlockPageReader {
+ public:
+  /*! \brief a decoded page, it stays valid while the pointer is held even if evicted */
+  typedef std::shared_ptr<const RowBlock<IndexType, DType> > PagePtr;
+  /*! \brief virtual destructor */
+  virtual ~RowBlockPageReader(void) {}
+  /*! \return number of pages */
+  virtual size_t NumPages() const = 0;
+  /*!
+   * \brief get a page, reading and decoding it if it is not cached
+   * \param index index of the page, in [0, NumPages())
+   * \return the page
+   */
+  virtual PagePtr GetPage(size_t index) = 0;
+  /*!
+   * \brief hint that the pages will be needed soon, they are read
+   *  into the cache in the background in the given order
+   * \param pages indices of the pages
+   */
+  virtual void Prefetch(const std::vector<size_t> &pages) = 0;
+  /*! \return number of GetPage calls served from the cache */
+  virtual size_t NumHits() const = 0;
+  /*! \return number of GetPage calls that read the page */
+  virtual size_t NumMisses() const = 0;
+};
+
 /*!
  * \brief Data structure that holds the data
  * Row block iterator interface that gets RowBlocks
@@ -271,6 +411,23 @@ class RowBlockIter : public DataIter<RowBlock<IndexType, DType> > {
          const char *type);
   /*! \return maximum feature dimension in the dataset */
   virtual size_t NumCol() const = 0;
+  /*!
+   * \return statistics of the dataset collected when it was first read,
+   *  NULL if the iterator does not collect them
+   */
+  virtual const DatasetStats *Stats() const {
+    return NULL;
+  }
+  /*!
+   * \brief create a random access reader over the pages of the data,
+   *  supported when the data is cached on disk
+   * \param memory_budget number of bytes of decoded pages to keep in memory
+   * \return the reader, owned by the caller, NULL if not supported
+   */
+  virtual RowBlockPageReader<IndexType, DType> *
+  CreatePageReader(size_t memory_budget) const {
+    return NULL;
+  }
 };
 
 /*!
@@ -319,6 +476,92 @@ class Parser : public DataIter<RowBlock<IndexType, DType> > {
        unsigned num_parts);
 };
 
+/*!
+ * \brief the lines of a text chunk, parsed only when they are accessed.
+ *  Labels and rows are cached once parsed, so each line is converted at
+ *  most once. The accessors are not thread safe, and the views they
+ *  return are valid until the iterator moves to the next block.
+ * \tparam IndexType type of index in RowBlock
+ * \tparam DType type of label and value in RowBlock
+ */
+template<typename IndexType, typename DType = real_t>
+class LazyRowBlock {
+ public:
+  /*! \brief virtual destructor */
+  virtual ~LazyRowBlock(void) {}
+  /*! \return number of rows of the block */
+  virtual size_t Size(void) const = 0;
+  /*!
+   * \brief get the text of a row
+   * \param rowid the row
+   * \param begin receives the first character of the line
+   * \param end receives the end of the line, without the end of line characters
+   */
+  virtual void Line(size_t rowid, const char **begin, const char **end) const = 0;
+  /*!
+   * \return the label of a row, only the label is parsed
+   * \param rowid the row
+   */
+  virtual real_t Label(size_t rowid) const = 0;
+  /*!
+   * \return a row, parsed on the first access
+   * \param rowid the row
+   */
+  virtual Row<IndexType, DType> GetRow(size_t rowid) const = 0;
+  /*!
+   * \return a block of some rows in the given order, valid until the next Select
+   * \param rowids the rows
+   */
+  virtual RowBlock<IndexType, DType> Select(const std::vector<size_t> &rowids) const = 0;
+  /*! \return all the rows as one block, parsed in parallel on the first call */
+  virtual RowBlock<IndexType, DType> All(void) const = 0;
+  /*! \return number of rows of the block parsed so far */
+  virtual size_t NumParsed(void) const = 0;
+};
+
+/*!
+ * \brief iterator over the chunks of a text dataset that only indexes
+ *  the line boundaries, for workloads that look at a few labels or rows
+ *  before deciding which rows they need.
+ *
+ * \code
+ *   std::unique_ptr<dmlc::LazyRowBlockIter<uint32_t> > iter(
+ *       dmlc::LazyRowBlockIter<uint32_t>::Create("train.libsvm", 0, 1, "libsvm"));
+ *   std::vector<size_t> positives;
+ *   while (iter->Next()) {
+ *     const dmlc::LazyRowBlock<uint32_t> &block = iter->Value();
+ *     positives.clear();
+ *     for (size_t i = 0; i < block.Size(); ++i) {
+ *       if (block.Label(i) > 0) positives.push_back(i);
+ *     }
+ *     Train(block.Select(positives));
+ *   }
+ * \endcode
+ * \tparam IndexType type of index in RowBlock
+ * \tparam DType type of label and value in RowBlock
+ *  Create function was only implemented for IndexType uint64_t and uint32_t
+ *  and DType real_t
+ */
+template<typename IndexType, typename DType = real_t>
+class LazyRowBlockIter : public DataIter<LazyRowBlock<IndexType, DType> > {
+ public:
+  /*!
+   * \brief create the iterator
+   * \param uri the uri of the input, with the parser arguments after '?'
+   * \param part_index the part id of current input
+   * \param num_parts total number of splits
+   * \param type format of the text: "libsvm", "libfm" or "csv"
+   * \return the created iterator
+   */
+  static LazyRowBlockIter<IndexType, DType> *
+  Create(const char *uri,
+         unsigned part_index,
+         unsigned num_parts,
+         const char *type);
+  /*! \return size of bytes read so far */
+  virtual size_t BytesRead(void) const = 0;
+};
+
 /*!
  * \brief registry entry of parser factory
  * \tparam IndexType The type of index
@@ -393,5 +636,42 @@ RowBlock<IndexType, DType>::operator[](size_t rowid) const {
   return inst;
 }
 
+template<typename IndexType, typename DType>
+inline void DatasetStats::Add(const RowBlock<IndexType, DType> &batch) {
+  for (size_t i = 0; i < batch.size; ++i) {
+    const real_t label = static_cast<real_t>(batch.label[i]);
+    std::map<real_t, uint64_t>::iterator it = label_count.find(label);
+    if (it != label_count.end()) {
+      ++it->second;
+    } else if (label_count.size() < kMaxLabels) {
+      label_count[label] = 1;
+    } else {
+      label_overflow = true;
+    }
+  }
+  num_row += batch.size;
+  const size_t begin = batch.offset[0], end = batch.offset[batch.size];
+  num_nonzero += end - begin;
+  for (size_t j = begin; j < end; ++j) {
+    const uint64_t index = static_cast<uint64_t>(batch.index[j]);
+    num_col = std::max(num_col, index + 1);
+    if (index < kExactFeatures) {
+      if (index >= feature_count.size()) {
+        const size_t n = std::max<size_t>(index + 1, feature_count.size() * 2);
+        feature_count.resize(n < kExactFeatures ? n : kExactFeatures);
+      }
+      ++feature_count[index];
+    } else {
+      if (feature_sketch.empty()) feature_sketch.resize(kSketchDepth * kSketchWidth);
+      for (size_t d = 0; d < kSketchDepth; ++d) {
+        ++feature_sketch[d * kSketchWidth + SketchBucket(index, d)];
+      }
+    }
+    if (batch.field != NULL) {
+      num_field = std::max(num_field, static_cast<uint64_t>(batch.field[j]) + 1);
+    }
+  }
+}
+
 }  // namespace dmlc
 #endif  // DMLC_DATA_H_
@@ -7,6 +7,8 @@
  */
 #ifndef DMLC_LOGGING_H_
 #define DMLC_LOGGING_H_
+#include <atomic>
+#include <chrono>
 #include <cstdio>
 #include <cstdlib>
 #include <string>
@@ -20,6 +22,10 @@
 #include DMLC_EXECINFO_H
 #endif
 
+#if DMLC_LOG_ASYNC
+#include "./async_logging.h"
+#endif
+
 namespace dmlc {
 /*!
  * \brief exception class that will be thrown by
@@ -32,11 +38,61 @@ struct Error : public std::runtime_error {
    */
   explicit Error(const std::string &s) : std::runtime_error(s) {}
 };
+
+/*!
+ * \brief decide whether LOG_EVERY_N logs, true on the 1st, (n+1)th, ... call
+ * \param counter number of calls of the call site
+ * \param n logging period in calls, 0 logs every call like 1
+ */
+inline bool LogEveryN(std::atomic<uint64_t> *counter, uint64_t n) {
+  if (n <= 1) return true;
+  return counter->fetch_add(1, std::memory_order_relaxed) % n == 0;
+}
+/*!
+ * \brief decide whether LOG_FIRST_N logs, true on the first n calls,
+ *  later calls only read the counter
+ * \param counter number of calls of the call site, saturating after n
+ * \param n number of calls that log
+ */
+inline bool LogFirstN(std::atomic<uint64_t> *counter, uint64_t n) {
+  if (counter->load(std::memory_order_relaxed) >= n) return false;
+  return counter->fetch_add(1, std::memory_order_relaxed) < n;
+}
+/*!
+ * \brief decide whether LOG_EVERY_T logs, true at most once per period,
+ *  calls within the period only read the state
+ * \param next earliest time of the next message in nanoseconds of the steady clock
+ * \param seconds logging period in seconds
+ */
+inline bool LogEveryT(std::atomic<int64_t> *next, double seconds) {
+  const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  int64_t expected = next->load(std::memory_order_relaxed);
+  if (now < expected) return false;
+  // only one of the threads passing the deadline together logs
+  return next->compare_exchange_strong(
+      expected, now + static_cast<int64_t>(seconds * 1e9), std::memory_order_relaxed);
+}
 }  // namespace dmlc
 
+/*!
+ * \brief state of a logging call site, a static variable of its own
+ *  in each place the macro is expanded
+ */
+#define DMLC_LOG_SITE_STATE(type)                                     \
+  ([]() -> std::atomic<type> * {                                      \
+    static std::atomic<type> state(0);                                \
+    return &state;                                                    \
+  }())
+
 #if DMLC_USE_GLOG
 #include <glog/logging.h>
 
+#ifndef LOG_EVERY_T
+#define LOG_EVERY_T(severity, seconds) \
+  LOG_IF(severity, dmlc::LogEveryT(DMLC_LOG_SITE_STATE(int64_t), (seconds)))
+#endif
+
 namespace dmlc {
 /*!
  * \brief optionally redirect to google's init log
@@ -155,6 +211,8 @@ DEFINE_CHECK_FUNC(_NE, !=)
 
 #if DMLC_LOG_CUSTOMIZE
 #define LOG_INFO dmlc::CustomLogMessage(__FILE__, __LINE__)
+#elif DMLC_LOG_ASYNC
+#define LOG_INFO dmlc::AsyncLogMessage(__FILE__, __LINE__)
 #else
 #define LOG_INFO dmlc::LogMessage(__FILE__, __LINE__)
 #endif
@@ -184,8 +242,13 @@ DEFINE_CHECK_FUNC(_NE, !=)
 #define DLOG_IF(severity, condition) LOG_IF(severity, condition)
 #endif
 
-// Poor man version of LOG_EVERY_N
-#define LOG_EVERY_N(severity, n) LOG(severity)
+// Rate limited logging, the state is kept per call site and shared by the threads
+#define LOG_EVERY_N(severity, n) \
+  LOG_IF(severity, dmlc::LogEveryN(DMLC_LOG_SITE_STATE(uint64_t), (n)))
+#define LOG_FIRST_N(severity, n) \
+  LOG_IF(severity, dmlc::LogFirstN(DMLC_LOG_SITE_STATE(uint64_t), (n)))
+#define LOG_EVERY_T(severity, seconds) \
+  LOG_IF(severity, dmlc::LogEveryT(DMLC_LOG_SITE_STATE(int64_t), (seconds)))
 
 #endif  // DMLC_GLOG_DEFINED
 
@@ -267,6 +330,28 @@ class CustomLogMessage {
  private:
   std::ostringstream log_stream_;
 };
+
+#if DMLC_LOG_ASYNC
+// logger handing the messages to the background thread of AsyncLogger
+class AsyncLogMessage {
+ public:
+  AsyncLogMessage(const char* file, int line) {
+    log_stream_ << "[" << CachedHumanDate() << "] " << file << ":"
+                << line << ": ";
+  }
+  ~AsyncLogMessage() {
+    log_stream_ << '\n';
+    std::string msg = log_stream_.str();
+    AsyncLogger::Get()->Push(&msg);
+  }
+  std::ostream& stream() { return log_stream_; }
+
+ private:
+  std::ostringstream log_stream_;
+  AsyncLogMessage(const AsyncLogMessage&);
+  void operator=(const AsyncLogMessage&);
+};
+#endif  // DMLC_LOG_ASYNC
 #else
 class DummyOStream {
  public:
@@ -348,6 +433,14 @@ inline std::string StackTrace(const size_t stack_size = 0) {
 
 #endif  // DMLC_LOG_STACK_TRACE
 
+// write the pending asynchronous messages before a fatal error, returns file
+inline const char* FlushAsync(const char* file) {
+#if DMLC_LOG_ASYNC
+  AsyncLogger::Get()->Flush();
+#endif
+  return file;
+}
+
 #if defined(_LIBCPP_SGX_NO_IOSTREAMS)
 class LogMessageFatal : public LogMessage {
  public:
@@ -362,7 +455,7 @@ class LogMessageFatal : public LogMessage {
 #elif DMLC_LOG_FATAL_THROW == 0
 class LogMessageFatal : public LogMessage {
  public:
-  LogMessageFatal(const char* file, int line) : LogMessage(file, line) {}
+  LogMessageFatal(const char* file, int line) : LogMessage(FlushAsync(file), line) {}
   ~LogMessageFatal() {
     log_stream_ << "\n\n" << StackTrace() << "\n";
     abort();
@@ -391,6 +484,7 @@ class LogMessageFatal {
 #if DMLC_LOG_BEFORE_THROW
     LOG(ERROR) << log_stream_.str();
 #endif
+    FlushAsync(NULL);
     throw Error(log_stream_.str());
   }
 
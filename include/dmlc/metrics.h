@@ -0,0 +1,305 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file metrics.h
+ * \brief counters and histograms cheap enough to update per record.
+ *  Each thread updates a cell of its own from a ThreadLocalRegistry, only
+ *  that thread writes it, so an update is a plain load and store without a
+ *  locked instruction; readers merge the cells of the live threads with what
+ *  the exited threads left.
+ * \code
+ *   static dmlc::Counter *rows = dmlc::MetricRegistry::Get()->GetCounter("parser.rows");
+ *   static dmlc::Histogram *latency = dmlc::MetricRegistry::Get()->GetHistogram(
+ *       "parser.chunk_seconds", dmlc::Histogram::ExponentialBounds(1e-6, 2.0, 24));
+ *   {
+ *     dmlc::HistogramTimer timer(latency);
+ *     rows->Add(ParseChunk());
+ *   }
+ *   dmlc::JSONWriter writer(&std::cout);
+ *   writer.Write(dmlc::MetricRegistry::Get()->Snapshot());
+ * \endcode
+ */
+#ifndef DMLC_METRICS_H_
+#define DMLC_METRICS_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "./base.h"
+#include "./json.h"
+#include "./logging.h"
+#include "./thread_local.h"
+#include "./timer.h"
+
+namespace dmlc {
+/*! \brief a monotonically accumulating integer */
+class Counter {
+ public:
+  Counter()
+      : retired_(0),
+        cells_(Cells::InitHook(), [this](Cell *cell) {
+            retired_.fetch_add(cell->value.load(std::memory_order_relaxed));
+          }) {}
+  /*!
+   * \brief add to the counter
+   * \param value the increment
+   */
+  inline void Add(int64_t value = 1) {
+    Cell *cell = cells_.Get();
+    cell->value.store(cell->value.load(std::memory_order_relaxed) + value,
+                      std::memory_order_relaxed);
+  }
+  /*! \return the sum of the increments of all the threads */
+  inline int64_t Value() {
+    int64_t total = retired_.load();
+    cells_.ForEach([&total](const Cell &cell) {
+        total += cell.value.load(std::memory_order_relaxed);
+      });
+    return total;
+  }
+
+ private:
+  /*! \brief the increments of one thread */
+  struct Cell {
+    std::atomic<int64_t> value;
+    Cell() : value(0) {}
+  };
+  typedef ThreadLocalRegistry<Cell> Cells;
+  /*! \brief the increments of the exited threads */
+  std::atomic<int64_t> retired_;
+  /*! \brief the cells of the live threads */
+  Cells cells_;
+};
+
+/*! \brief merged content of a histogram */
+struct HistogramSnapshot {
+  /*! \brief upper bounds of the buckets, the last bucket is unbounded */
+  std::vector<double> bounds;
+  /*! \brief number of observations per bucket, one more than bounds */
+  std::vector<uint64_t> counts;
+  /*! \brief number of observations */
+  uint64_t count;
+  /*! \brief sum of the observations */
+  double sum;
+  HistogramSnapshot() : count(0), sum(0.0) {}
+  /*! \return the mean of the observations, 0 if there is none */
+  inline double Mean() const {
+    return count == 0 ? 0.0 : sum / count;
+  }
+  /*!
+   * \return an upper estimate of the q-quantile, the upper bound of the
+   *  bucket holding it, the last bound if it falls in the unbounded bucket
+   * \param q the quantile in [0, 1]
+   */
+  inline double Quantile(double q) const {
+    CHECK(q >= 0.0 && q <= 1.0) << "quantile out of range";
+    if (count == 0 || bounds.size() == 0) return 0.0;
+    const double rank = q * count;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < bounds.size(); ++i) {
+      seen += counts[i];
+      if (seen >= rank && seen != 0) return bounds[i];
+    }
+    return bounds.back();
+  }
+  /*! \brief write the snapshot as a JSON object */
+  inline void Save(JSONWriter *writer) const {
+    writer->BeginObject();
+    writer->WriteObjectKeyValue("count", count);
+    writer->WriteObjectKeyValue("sum", sum);
+    writer->WriteObjectKeyValue("bounds", bounds);
+    writer->WriteObjectKeyValue("counts", counts);
+    writer->EndObject();
+  }
+};
+
+/*! \brief distribution of observed values over fixed buckets */
+class Histogram {
+ public:
+  /*!
+   * \brief constructor
+   * \param bounds increasing upper bounds of the buckets, a value goes to the
+   *  first bucket whose bound is not less than it, or to an extra unbounded bucket
+   */
+  explicit Histogram(const std::vector<double> &bounds)
+      : bounds_(bounds),
+        cells_([this](Cell *cell) { this->InitCell(cell); },
+               [this](Cell *cell) { this->RetireCell(cell); }) {
+    for (size_t i = 1; i < bounds_.size(); ++i) {
+      CHECK(bounds_[i - 1] < bounds_[i]) << "histogram bounds must be increasing";
+    }
+    retired_.bounds = bounds_;
+    retired_.counts.resize(bounds_.size() + 1, 0);
+  }
+  /*!
+   * \return the bounds start, start * factor, ..., count of them
+   * \param start the first bound
+   * \param factor ratio of two consecutive bounds
+   * \param count number of bounds
+   */
+  static std::vector<double> ExponentialBounds(double start, double factor, size_t count) {
+    CHECK(start > 0.0 && factor > 1.0) << "invalid exponential bounds";
+    std::vector<double> bounds(count);
+    for (size_t i = 0; i < count; ++i) {
+      bounds[i] = start;
+      start *= factor;
+    }
+    return bounds;
+  }
+  /*!
+   * \brief record a value
+   * \param value the observed value
+   */
+  inline void Observe(double value) {
+    const size_t bucket =
+        std::lower_bound(bounds_.begin(), bounds_.end(), value) - bounds_.begin();
+    Cell *cell = cells_.Get();
+    std::atomic<uint64_t> &slot = cell->counts[bucket];
+    slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    cell->sum.store(cell->sum.load(std::memory_order_relaxed) + value,
+                    std::memory_order_relaxed);
+  }
+  /*! \return the observations of all the threads */
+  inline HistogramSnapshot Snapshot() {
+    HistogramSnapshot snapshot;
+    {
+      std::lock_guard<std::mutex> lock(retired_mutex_);
+      snapshot = retired_;
+    }
+    snapshot.count = 0;
+    cells_.ForEach([&snapshot](const Cell &cell) {
+        snapshot.sum += cell.sum.load(std::memory_order_relaxed);
+        for (size_t i = 0; i < cell.counts.size(); ++i) {
+          snapshot.counts[i] += cell.counts[i].load(std::memory_order_relaxed);
+        }
+      });
+    for (size_t i = 0; i < snapshot.counts.size(); ++i) {
+      snapshot.count += snapshot.counts[i];
+    }
+    return snapshot;
+  }
+
+ private:
+  /*! \brief the observations of one thread */
+  struct Cell {
+    std::vector<std::atomic<uint64_t> > counts;
+    std::atomic<double> sum;
+    Cell() : sum(0.0) {}
+  };
+  /*! \brief upper bounds of the buckets */
+  std::vector<double> bounds_;
+  /*! \brief the observations of the exited threads */
+  HistogramSnapshot retired_;
+  /*! \brief protects retired_ */
+  std::mutex retired_mutex_;
+  /*! \brief the cells of the live threads */
+  ThreadLocalRegistry<Cell> cells_;
+  /*! \brief size the buckets of a new cell */
+  inline void InitCell(Cell *cell) {
+    std::vector<std::atomic<uint64_t> > counts(bounds_.size() + 1);
+    for (size_t i = 0; i < counts.size(); ++i) counts[i].store(0);
+    cell->counts.swap(counts);
+  }
+  /*! \brief add the observations of an exiting thread to retired_ */
+  inline void RetireCell(Cell *cell) {
+    std::lock_guard<std::mutex> lock(retired_mutex_);
+    retired_.sum += cell->sum.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < cell->counts.size(); ++i) {
+      retired_.counts[i] += cell->counts[i].load(std::memory_order_relaxed);
+    }
+  }
+};
+
+/*! \brief observes the seconds spent in a scope into a histogram */
+class HistogramTimer {
+ public:
+  /*!
+   * \brief start timing the scope
+   * \param histogram the histogram the duration is observed into
+   */
+  explicit HistogramTimer(Histogram *histogram) : histogram_(histogram) {}
+  ~HistogramTimer() {
+    histogram_->Observe(watch_.Elapsed());
+  }
+
+ private:
+  /*! \brief the histogram to observe into */
+  Histogram *histogram_;
+  /*! \brief measures the scope */
+  Stopwatch watch_;
+};
+
+/*! \brief merged values of all the metrics of a registry */
+struct MetricsSnapshot {
+  /*! \brief value of each counter */
+  std::map<std::string, int64_t> counters;
+  /*! \brief content of each histogram */
+  std::map<std::string, HistogramSnapshot> histograms;
+  /*! \brief write the snapshot as a JSON object */
+  inline void Save(JSONWriter *writer) const {
+    writer->BeginObject();
+    writer->WriteObjectKeyValue("counters", counters);
+    writer->WriteObjectKeyValue("histograms", histograms);
+    writer->EndObject();
+  }
+};
+
+/*! \brief named metrics of the process */
+class MetricRegistry {
+ public:
+  /*! \return the global registry */
+  static MetricRegistry *Get() {
+    // never destroyed so that metrics updated in static destructors stay valid
+    static MetricRegistry *inst = new MetricRegistry();
+    return inst;
+  }
+  /*!
+   * \return the counter of the name, created on first use,
+   *  valid as long as the registry
+   * \param name name of the counter
+   */
+  inline Counter *GetCounter(const std::string &name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Counter> &counter = counters_[name];
+    if (counter == nullptr) counter.reset(new Counter());
+    return counter.get();
+  }
+  /*!
+   * \return the histogram of the name, created on first use,
+   *  valid as long as the registry
+   * \param name name of the histogram
+   * \param bounds upper bounds of the buckets, ignored if the histogram exists
+   */
+  inline Histogram *GetHistogram(const std::string &name, const std::vector<double> &bounds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_ptr<Histogram> &histogram = histograms_[name];
+    if (histogram == nullptr) histogram.reset(new Histogram(bounds));
+    return histogram.get();
+  }
+  /*! \return the current values of all the metrics */
+  inline MetricsSnapshot Snapshot() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    MetricsSnapshot snapshot;
+    for (auto &kv : counters_) {
+      snapshot.counters[kv.first] = kv.second->Value();
+    }
+    for (auto &kv : histograms_) {
+      snapshot.histograms[kv.first] = kv.second->Snapshot();
+    }
+    return snapshot;
+  }
+
+ private:
+  /*! \brief the counters by name */
+  std::map<std::string, std::unique_ptr<Counter> > counters_;
+  /*! \brief the histograms by name */
+  std::map<std::string, std::unique_ptr<Histogram> > histograms_;
+  /*! \brief protects counters_ and histograms_ */
+  std::mutex mutex_;
+};
+}  // namespace dmlc
+#endif  // DMLC_METRICS_H_
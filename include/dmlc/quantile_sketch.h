@@ -0,0 +1,516 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file quantile_sketch.h
+ * \brief mergeable weighted quantile sketch,
+ *  used to compute per-feature cut points in the ingest pass
+ */
+#ifndef DMLC_QUANTILE_SKETCH_H_
+#define DMLC_QUANTILE_SKETCH_H_
+
+#include <cmath>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include "./base.h"
+#include "./data.h"
+#include "./io.h"
+#include "./logging.h"
+#include "./omp.h"
+
+namespace dmlc {
+/*!
+ * \brief weighted quantile summary, keeps a small ordered set of values
+ *  together with lower/upper bounds of their ranks.
+ *
+ *  The summary follows the combine/prune scheme of weighted GK summaries:
+ *  combining two summaries of disjoint data is exact in the rank bounds,
+ *  pruning to n entries adds at most Total() / n rank error.
+ *
+ * \tparam DType type of the value
+ * \tparam RType type of rank and weight
+ */
+template<typename DType = real_t, typename RType = double>
+struct WeightedQuantileSummary {
+  /*! \brief an entry in the summary */
+  struct Entry {
+    /*! \brief minimum rank of the value */
+    RType rmin;
+    /*! \brief maximum rank of the value */
+    RType rmax;
+    /*! \brief weight of the value itself */
+    RType wmin;
+    /*! \brief the value of the entry */
+    DType value;
+    Entry() {}
+    Entry(RType rmin, RType rmax, RType wmin, DType value)
+        : rmin(rmin), rmax(rmax), wmin(wmin), value(value) {}
+    /*! \return minimum rank of the next value in the data */
+    inline RType RMinNext() const {
+      return rmin + wmin;
+    }
+    /*! \return maximum rank of the previous value in the data */
+    inline RType RMaxPrev() const {
+      return rmax - wmin;
+    }
+  };
+  /*! \brief entries ordered by value */
+  std::vector<Entry> data;
+  /*! \return number of entries in the summary */
+  inline size_t Size() const {
+    return data.size();
+  }
+  /*! \return total weight summarized */
+  inline RType Total() const {
+    return data.empty() ? RType(0) : data.back().rmax;
+  }
+  /*!
+   * \brief build the exact summary of a set of weighted values
+   * \param entries (value, weight) pairs, will be sorted in place
+   */
+  inline void SetFromUnsorted(std::vector<std::pair<DType, RType> > *entries) {
+    std::sort(entries->begin(), entries->end());
+    data.clear();
+    RType wsum = 0;
+    for (size_t i = 0; i < entries->size();) {
+      const DType value = (*entries)[i].first;
+      RType w = 0;
+      for (; i < entries->size() && (*entries)[i].first == value; ++i) {
+        w += (*entries)[i].second;
+      }
+      data.push_back(Entry(wsum, wsum + w, w, value));
+      wsum += w;
+    }
+  }
+  /*!
+   * \brief set the summary to be the combination of two summaries
+   *  that describe disjoint sets of data
+   * \param sa first summary
+   * \param sb second summary
+   */
+  inline void SetCombine(const WeightedQuantileSummary &sa,
+                         const WeightedQuantileSummary &sb) {
+    if (sa.data.empty()) {
+      data = sb.data; return;
+    }
+    if (sb.data.empty()) {
+      data = sa.data; return;
+    }
+    const std::vector<Entry> &a = sa.data, &b = sb.data;
+    data.clear();
+    data.reserve(a.size() + b.size());
+    size_t i = 0, j = 0;
+    RType aprev_rmin = 0, bprev_rmin = 0;
+    while (i < a.size() && j < b.size()) {
+      if (a[i].value == b[j].value) {
+        data.push_back(Entry(a[i].rmin + b[j].rmin, a[i].rmax + b[j].rmax,
+                             a[i].wmin + b[j].wmin, a[i].value));
+        aprev_rmin = a[i].RMinNext();
+        bprev_rmin = b[j].RMinNext();
+        ++i; ++j;
+      } else if (a[i].value < b[j].value) {
+        data.push_back(Entry(a[i].rmin + bprev_rmin, a[i].rmax + b[j].RMaxPrev(),
+                             a[i].wmin, a[i].value));
+        aprev_rmin = a[i].RMinNext();
+        ++i;
+      } else {
+        data.push_back(Entry(b[j].rmin + aprev_rmin, b[j].rmax + a[i].RMaxPrev(),
+                             b[j].wmin, b[j].value));
+        bprev_rmin = b[j].RMinNext();
+        ++j;
+      }
+    }
+    for (; i < a.size(); ++i) {
+      data.push_back(Entry(a[i].rmin + bprev_rmin, a[i].rmax + b.back().rmax,
+                           a[i].wmin, a[i].value));
+    }
+    for (; j < b.size(); ++j) {
+      data.push_back(Entry(b[j].rmin + aprev_rmin, b[j].rmax + a.back().rmax,
+                           b[j].wmin, b[j].value));
+    }
+  }
+  /*!
+   * \brief set the summary to be a pruned version of src with at most maxsize entries,
+   *  the minimum and maximum value are always kept
+   * \param src source summary
+   * \param maxsize maximum number of entries, must be at least 2
+   */
+  inline void SetPrune(const WeightedQuantileSummary &src, size_t maxsize) {
+    CHECK_GE(maxsize, 2U);
+    if (src.data.size() <= maxsize) {
+      data = src.data; return;
+    }
+    const std::vector<Entry> &s = src.data;
+    const RType begin = s[0].rmax;
+    const RType range = s.back().rmin - s[0].rmax;
+    const size_t n = maxsize - 1;
+    data.clear();
+    data.push_back(s[0]);
+    size_t i = 1, lastidx = 0;
+    for (size_t k = 1; k < n; ++k) {
+      const RType dx2 = 2 * ((k * range) / n + begin);
+      // find the first i such that dx2 < rmax[i + 1] + rmin[i + 1]
+      while (i < s.size() - 1 && dx2 >= s[i + 1].rmax + s[i + 1].rmin) ++i;
+      if (i == s.size() - 1) break;
+      if (dx2 < s[i].RMinNext() + s[i + 1].RMaxPrev()) {
+        if (i != lastidx) {
+          data.push_back(s[i]); lastidx = i;
+        }
+      } else {
+        if (i + 1 != lastidx) {
+          data.push_back(s[i + 1]); lastidx = i + 1;
+        }
+      }
+    }
+    if (lastidx != s.size() - 1) {
+      data.push_back(s.back());
+    }
+  }
+  /*!
+   * \brief query the value whose rank is closest to rank
+   * \param rank the rank in [0, Total()]
+   * \return the value
+   */
+  inline DType Query(RType rank) const {
+    CHECK_NE(data.size(), 0U) << "query on empty summary";
+    const RType dx2 = 2 * rank;
+    for (size_t i = 0; i + 1 < data.size(); ++i) {
+      if (dx2 < data[i].RMinNext() + data[i + 1].RMaxPrev()) {
+        return data[i].value;
+      }
+    }
+    return data.back().value;
+  }
+  /*!
+   * \brief save the summary to a binary stream
+   * \param fo output stream
+   */
+  inline void Save(Stream *fo) const {
+    uint64_t n = static_cast<uint64_t>(data.size());
+    fo->Write(n);
+    for (size_t i = 0; i < data.size(); ++i) {
+      fo->Write(data[i].rmin);
+      fo->Write(data[i].rmax);
+      fo->Write(data[i].wmin);
+      fo->Write(data[i].value);
+    }
+  }
+  /*!
+   * \brief load the summary from a binary stream
+   * \param fi input stream
+   * \return whether the load was successful
+   */
+  inline bool Load(Stream *fi) {
+    uint64_t n;
+    if (!fi->Read(&n)) return false;
+    data.resize(static_cast<size_t>(n));
+    for (size_t i = 0; i < data.size(); ++i) {
+      CHECK(fi->Read(&data[i].rmin) && fi->Read(&data[i].rmax) &&
+            fi->Read(&data[i].wmin) && fi->Read(&data[i].value))
+          << "Bad WeightedQuantileSummary format";
+    }
+    return true;
+  }
+};
+
+/*!
+ * \brief streaming weighted quantile sketch of a single variable.
+ *
+ *  Incoming values are buffered, summarized in batches and merged into a
+ *  binary hierarchy of summaries, each pruned to a fixed size. The rank
+ *  error of the final summary is about eps * Total().
+ *
+ * \tparam DType type of the value
+ * \tparam RType type of rank and weight
+ */
+template<typename DType = real_t, typename RType = double>
+class WeightedQuantileSketch {
+ public:
+  /*! \brief type of summary */
+  typedef WeightedQuantileSummary<DType, RType> Summary;
+  /*!
+   * \brief constructor
+   * \param eps the desired relative rank error
+   */
+  explicit WeightedQuantileSketch(double eps = 0.01) {
+    this->Init(eps);
+  }
+  /*!
+   * \brief reset the sketch
+   * \param eps the desired relative rank error
+   */
+  inline void Init(double eps) {
+    CHECK(eps > 0.0 && eps < 1.0) << "eps must be in (0, 1)";
+    // each level of the hierarchy loses up to 1 / limit_size in rank,
+    // reserve room for 8 levels (256 batches) before exceeding eps
+    limit_size_ = static_cast<size_t>(std::ceil(8.0 / eps)) + 2;
+    buffer_.clear();
+    levels_.clear();
+  }
+  /*!
+   * \brief add a weighted value to the sketch
+   * \param value the value
+   * \param weight the weight of the value
+   */
+  inline void Push(DType value, RType weight = 1) {
+    if (weight <= 0) return;
+    buffer_.push_back(std::make_pair(value, weight));
+    if (buffer_.size() >= 2 * limit_size_) this->Flush();
+  }
+  /*!
+   * \brief merge an existing summary, e.g. from another worker, into the sketch
+   * \param summary the summary of data disjoint to the data in the sketch
+   */
+  inline void PushSummary(const Summary &summary) {
+    if (summary.Size() == 0) return;
+    Summary pruned;
+    pruned.SetPrune(summary, limit_size_);
+    this->PushLevel(&pruned, 0);
+  }
+  /*!
+   * \brief get the summary of all the data pushed so far
+   * \param out the output summary, pruned to the limit size of the sketch
+   */
+  inline void GetSummary(Summary *out) {
+    this->Flush();
+    Summary acc, tmp;
+    for (size_t l = 0; l < levels_.size(); ++l) {
+      if (levels_[l].Size() == 0) continue;
+      tmp.SetCombine(acc, levels_[l]);
+      acc.SetPrune(tmp, limit_size_);
+    }
+    std::swap(out->data, acc.data);
+  }
+
+ private:
+  /*! \brief maximum size of each summary */
+  size_t limit_size_;
+  /*! \brief buffered values not yet summarized */
+  std::vector<std::pair<DType, RType> > buffer_;
+  /*! \brief level l summarizes about 2^l batches */
+  std::vector<Summary> levels_;
+  /*! \brief summarize the buffer into the hierarchy */
+  inline void Flush() {
+    if (buffer_.size() == 0) return;
+    Summary exact, pruned;
+    exact.SetFromUnsorted(&buffer_);
+    buffer_.clear();
+    pruned.SetPrune(exact, limit_size_);
+    this->PushLevel(&pruned, 0);
+  }
+  /*! \brief carry a summary into the hierarchy, starting at level */
+  inline void PushLevel(Summary *summary, size_t level) {
+    Summary tmp;
+    for (; level < levels_.size(); ++level) {
+      if (levels_[level].Size() == 0) {
+        std::swap(levels_[level].data, summary->data);
+        return;
+      }
+      tmp.SetCombine(levels_[level], *summary);
+      summary->SetPrune(tmp, limit_size_);
+      levels_[level].data.clear();
+    }
+    levels_.push_back(Summary());
+    std::swap(levels_.back().data, summary->data);
+  }
+};
+
+/*!
+ * \brief per-feature weighted quantile sketch over RowBlocks.
+ *
+ *  Consumes RowBlocks from any Parser or RowBlockIter, sketches the value
+ *  distribution of every feature (weighted by the instance weight) and can
+ *  be serialized and merged with sketches of other workers.
+ *
+ * Usage example:
+ * \code
+ *
+ *   FeatureQuantileSketch<> sketch(0.01);
+ *   parser->BeforeFirst();
+ *   while (parser->Next()) {
+ *     sketch.Push(parser->Value());
+ *     // other work fused into the same pass
+ *   }
+ *   std::vector<real_t> cuts = sketch.GetCuts(fid, 256);
+ * \endcode
+ *
+ * \tparam DType type of the value
+ */
+template<typename DType = real_t>
+class FeatureQuantileSketch {
+ public:
+  /*! \brief type of summary */
+  typedef WeightedQuantileSummary<DType, double> Summary;
+  /*!
+   * \brief constructor
+   * \param eps the desired relative rank error
+   * \param nthread number of threads used when pushing a block
+   */
+  explicit FeatureQuantileSketch(double eps = 0.01, int nthread = 0)
+      : eps_(eps), nthread_(nthread) {
+    CHECK(eps > 0.0 && eps < 1.0) << "eps must be in (0, 1)";
+    if (nthread_ <= 0) nthread_ = omp_get_max_threads();
+  }
+  /*! \return number of features seen so far */
+  inline size_t NumCol() const {
+    return sketches_.size();
+  }
+  /*!
+   * \brief add a block of rows to the sketch,
+   *  features are partitioned among threads
+   * \param batch the rows to be added
+   * \tparam IndexType type of the feature index
+   */
+  template<typename IndexType>
+  inline void Push(const RowBlock<IndexType, DType> &batch) {
+    if (batch.size == 0) return;
+    const size_t begin = batch.offset[0], end = batch.offset[batch.size];
+    IndexType max_index = 0;
+    for (size_t i = begin; i < end; ++i) {
+      max_index = std::max(max_index, batch.index[i]);
+    }
+    if (end != begin && static_cast<size_t>(max_index) >= sketches_.size()) {
+      sketches_.resize(static_cast<size_t>(max_index) + 1,
+                       WeightedQuantileSketch<DType, double>(eps_));
+    }
+    // sort the entries of the block by feature once, so that each thread only
+    // visits the entries of its own features, the cost does not depend on
+    // the number of features absent from the block
+    const size_t nnz = end - begin;
+    entry_.resize(nnz);
+    for (size_t r = 0, k = 0; r < batch.size; ++r) {
+      const double w = batch.weight == NULL ? 1.0 : batch.weight[r];
+      for (size_t j = batch.offset[r]; j < batch.offset[r + 1]; ++j, ++k) {
+        entry_[k].fid = static_cast<size_t>(batch.index[j]);
+        entry_[k].value = batch.value == NULL ? DType(1) : batch.value[j];
+        entry_[k].weight = w;
+      }
+    }
+    // stable, the entries of a feature are pushed in row order
+    std::stable_sort(entry_.begin(), entry_.end(),
+                     [](const Entry &a, const Entry &b) { return a.fid < b.fid; });
+    // cut the entries into ranges of about the same size, ending between features
+    const int nthread = static_cast<int>(
+        std::max<size_t>(1, std::min<size_t>(nthread_, nnz)));
+    #pragma omp parallel num_threads(nthread)
+    {
+      const size_t tid = static_cast<size_t>(omp_get_thread_num());
+      size_t jbegin = tid * nnz / nthread, jend = (tid + 1) * nnz / nthread;
+      while (jbegin != 0 && jbegin < nnz && entry_[jbegin].fid == entry_[jbegin - 1].fid) {
+        ++jbegin;
+      }
+      while (jend != 0 && jend < nnz && entry_[jend].fid == entry_[jend - 1].fid) ++jend;
+      for (size_t j = jbegin; j < jend; ++j) {
+        sketches_[entry_[j].fid].Push(entry_[j].value, entry_[j].weight);
+      }
+    }
+  }
+  /*!
+   * \brief sketch all the data of an iterator, starting from the beginning
+   * \param iter the iterator, can be a Parser or RowBlockIter
+   * \tparam IndexType type of the feature index
+   */
+  template<typename IndexType>
+  inline void PushIter(DataIter<RowBlock<IndexType, DType> > *iter) {
+    iter->BeforeFirst();
+    while (iter->Next()) {
+      this->Push(iter->Value());
+    }
+  }
+  /*!
+   * \brief get the summary of a feature
+   * \param fid the feature index
+   * \param out the output summary
+   */
+  inline void GetSummary(size_t fid, Summary *out) {
+    CHECK_LT(fid, sketches_.size()) << "feature index exceed bound";
+    sketches_[fid].GetSummary(out);
+  }
+  /*!
+   * \brief get the cut points of a feature
+   * \param fid the feature index
+   * \param max_bins maximum number of bins
+   * \return ascending distinct values that include the minimum and maximum of
+   *  the feature, consecutive values delimit a bin; empty if feature is absent
+   */
+  inline std::vector<DType> GetCuts(size_t fid, size_t max_bins) {
+    CHECK_GE(max_bins, 1U);
+    std::vector<DType> cuts;
+    if (fid >= sketches_.size()) return cuts;
+    Summary summary, pruned;
+    sketches_[fid].GetSummary(&summary);
+    pruned.SetPrune(summary, max_bins + 1);
+    for (size_t i = 0; i < pruned.Size(); ++i) {
+      cuts.push_back(pruned.data[i].value);
+    }
+    return cuts;
+  }
+  /*!
+   * \brief merge sketch of another worker, which sketched different data
+   * \param other the other sketch
+   */
+  inline void Merge(FeatureQuantileSketch *other) {
+    if (other->sketches_.size() > sketches_.size()) {
+      sketches_.resize(other->sketches_.size(),
+                       WeightedQuantileSketch<DType, double>(eps_));
+    }
+    Summary summary;
+    for (size_t fid = 0; fid < other->sketches_.size(); ++fid) {
+      other->sketches_[fid].GetSummary(&summary);
+      sketches_[fid].PushSummary(summary);
+    }
+  }
+  /*!
+   * \brief save the summaries of all features to a binary stream
+   * \param fo output stream
+   */
+  inline void Save(Stream *fo) {
+    uint64_t ncol = static_cast<uint64_t>(sketches_.size());
+    fo->Write(eps_);
+    fo->Write(ncol);
+    Summary summary;
+    for (size_t fid = 0; fid < sketches_.size(); ++fid) {
+      sketches_[fid].GetSummary(&summary);
+      summary.Save(fo);
+    }
+  }
+  /*!
+   * \brief load sketch saved by Save, the loaded summaries are merged
+   *  into the current sketch
+   * \param fi input stream
+   * \return whether the load was successful
+   */
+  inline bool Load(Stream *fi) {
+    double eps;
+    uint64_t ncol;
+    if (!fi->Read(&eps)) return false;
+    CHECK(fi->Read(&ncol)) << "Bad FeatureQuantileSketch format";
+    if (ncol > sketches_.size()) {
+      sketches_.resize(static_cast<size_t>(ncol),
+                       WeightedQuantileSketch<DType, double>(eps_));
+    }
+    Summary summary;
+    for (size_t fid = 0; fid < ncol; ++fid) {
+      CHECK(summary.Load(fi)) << "Bad FeatureQuantileSketch format";
+      sketches_[fid].PushSummary(summary);
+    }
+    return true;
+  }
+
+ private:
+  /*! \brief relative rank error */
+  double eps_;
+  /*! \brief number of threads */
+  int nthread_;
+  /*! \brief sketch of each feature */
+  std::vector<WeightedQuantileSketch<DType, double> > sketches_;
+  /*! \brief an entry of a block */
+  struct Entry {
+    size_t fid;
+    DType value;
+    double weight;
+  };
+  /*! \brief the entries of the block sorted by feature, for Push */
+  std::vector<Entry> entry_;
+};
+}  // namespace dmlc
+#endif  // DMLC_QUANTILE_SKETCH_H_
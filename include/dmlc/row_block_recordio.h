@@ -0,0 +1,208 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file row_block_recordio.h
+ * \brief binary format storing RowBlocks as RecordIO records,
+ *  read back by the "rowblock" data parser without numeric parsing
+ */
+#ifndef DMLC_ROW_BLOCK_RECORDIO_H_
+#define DMLC_ROW_BLOCK_RECORDIO_H_
+
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include "./base.h"
+#include "./data.h"
+#include "./endian.h"
+#include "./logging.h"
+#include "./recordio.h"
+
+namespace dmlc {
+/*!
+ * \brief header of a record holding a RowBlock.
+ *
+ *  The header is followed by the arrays offset, label, weight, qid,
+ *  field, index and value, each starting at a multiple of 8 bytes from the
+ *  beginning of the record. Offsets are uint64 starting from 0, weights
+ *  are float32, qids are uint64, fields and indices use index_bytes and
+ *  labels and values use value_bytes. All numbers are little endian.
+ *  The maximum indices are kept in the header so that readers do not
+ *  need to scan the entries.
+ */
+struct RowBlockRecordHeader {
+  /*! \brief magic number of the record */
+  static const uint32_t kMagic = 0x4b4c4252;
+  /*! \brief current version of the format */
+  static const uint16_t kVersion = 1;
+  /*! \brief flag of optional arrays */
+  enum Flag {
+    kHasWeight = 1, kHasQid = 2, kHasField = 4, kHasValue = 8
+  };
+  /*! \brief magic number */
+  uint32_t magic;
+  /*! \brief format version */
+  uint16_t version;
+  /*! \brief bytes of each index */
+  uint8_t index_bytes;
+  /*! \brief bytes of each label and value */
+  uint8_t value_bytes;
+  /*! \brief whether label and value are floating point */
+  uint8_t value_is_float;
+  /*! \brief combination of Flag */
+  uint8_t flags;
+  /*! \brief reserved, zero */
+  uint16_t reserved0;
+  /*! \brief reserved, zero */
+  uint32_t reserved1;
+  /*! \brief number of rows */
+  uint64_t num_rows;
+  /*! \brief number of non-zero entries */
+  uint64_t num_nonzero;
+  /*! \brief maximum feature index in the record */
+  uint64_t max_index;
+  /*! \brief maximum field index in the record */
+  uint64_t max_field;
+  /*! \return bytes of an array of n elements of elem_bytes, padded to 8 bytes */
+  inline static size_t AlignedBytes(size_t n, size_t elem_bytes) {
+    return (n * elem_bytes + 7UL) & ~7UL;
+  }
+  /*! \return size of the record described by the header */
+  inline size_t RecordBytes(void) const {
+    const size_t nrow = static_cast<size_t>(num_rows);
+    const size_t nnz = static_cast<size_t>(num_nonzero);
+    return sizeof(RowBlockRecordHeader) +
+        AlignedBytes(nrow + 1, sizeof(uint64_t)) +
+        AlignedBytes(nrow, value_bytes) +
+        ((flags & kHasWeight) ? AlignedBytes(nrow, sizeof(float)) : 0) +
+        ((flags & kHasQid) ? AlignedBytes(nrow, sizeof(uint64_t)) : 0) +
+        ((flags & kHasField) ? AlignedBytes(nnz, index_bytes) : 0) +
+        AlignedBytes(nnz, index_bytes) +
+        ((flags & kHasValue) ? AlignedBytes(nnz, value_bytes) : 0);
+  }
+};
+
+/*!
+ * \brief writer that stores RowBlocks into a RecordIO stream,
+ *  splitting them into records of bounded number of rows so that the
+ *  output can be partitioned finely when read back.
+ *
+ * \code
+ *   std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create("data.rec", "w"));
+ *   dmlc::RowBlockRecordIOWriter<uint32_t> writer(fo.get());
+ *   while (parser->Next()) writer.Write(parser->Value());
+ *   // read back with Parser<uint32_t>::Create("data.rec", part, nparts, "rowblock")
+ * \endcode
+ * \tparam IndexType type of index
+ * \tparam DType type of label and value
+ */
+template<typename IndexType, typename DType = real_t>
+class RowBlockRecordIOWriter {
+ public:
+  /*!
+   * \brief constructor
+   * \param stream the output stream, not owned
+   * \param rows_per_record maximum number of rows in each record
+   * \param index optional stream, not owned, receiving a "record offset" line
+   *  per record in the format of the indexed_recordio splits, the offsets
+   *  are counted by the writer, so the output stream needs not be seekable
+   */
+  explicit RowBlockRecordIOWriter(Stream *stream, size_t rows_per_record = 4096,
+                                  Stream *index = NULL)
+      : writer_(stream), rows_per_record_(rows_per_record), index_(index),
+        num_records_(0), offset_(0) {
+    SeekStream *seek_stream = dynamic_cast<SeekStream*>(stream);
+    if (index != NULL && seek_stream != NULL) offset_ = seek_stream->Tell();
+    CHECK(DMLC_LITTLE_ENDIAN) << "RowBlock records are only supported on little endian hosts";
+    CHECK_NE(rows_per_record, 0U);
+  }
+  /*! \return number of records written so far */
+  inline size_t NumRecords() const {
+    return num_records_;
+  }
+  /*!
+   * \brief write the rows of a block
+   * \param batch the rows to write
+   */
+  inline void Write(const RowBlock<IndexType, DType> &batch) {
+    for (size_t begin = 0; begin < batch.size; begin += rows_per_record_) {
+      size_t end = std::min(batch.size, begin + rows_per_record_);
+      this->WriteRecord(batch.Slice(begin, end));
+    }
+  }
+
+ private:
+  /*! \brief the record writer */
+  RecordIOWriter writer_;
+  /*! \brief maximum rows per record */
+  size_t rows_per_record_;
+  /*! \brief the index stream, NULL if no index is written */
+  Stream *index_;
+  /*! \brief number of records written */
+  size_t num_records_;
+  /*! \brief offset of the next record in the output stream */
+  size_t offset_;
+  /*! \brief buffer of the record */
+  std::string buffer_;
+  // append n elements to the record buffer at pos, padded to 8 bytes
+  inline void Append(size_t *pos, const void *data, size_t n, size_t elem_bytes) {
+    if (n != 0) std::memcpy(&buffer_[*pos], data, n * elem_bytes);
+    *pos += RowBlockRecordHeader::AlignedBytes(n, elem_bytes);
+  }
+  // write a single block as a record
+  inline void WriteRecord(const RowBlock<IndexType, DType> &batch) {
+    const size_t base = batch.offset[0];
+    RowBlockRecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = RowBlockRecordHeader::kMagic;
+    header.version = RowBlockRecordHeader::kVersion;
+    header.index_bytes = sizeof(IndexType);
+    header.value_bytes = sizeof(DType);
+    header.value_is_float = std::is_floating_point<DType>::value ? 1 : 0;
+    header.flags = (batch.weight != NULL ? RowBlockRecordHeader::kHasWeight : 0) |
+        (batch.qid != NULL ? RowBlockRecordHeader::kHasQid : 0) |
+        (batch.field != NULL ? RowBlockRecordHeader::kHasField : 0) |
+        (batch.value != NULL ? RowBlockRecordHeader::kHasValue : 0);
+    header.num_rows = batch.size;
+    header.num_nonzero = batch.offset[batch.size] - base;
+    const size_t nrow = batch.size;
+    const size_t nnz = static_cast<size_t>(header.num_nonzero);
+    for (size_t i = base; i < base + nnz; ++i) {
+      header.max_index = std::max<uint64_t>(header.max_index, batch.index[i]);
+      if (batch.field != NULL) {
+        header.max_field = std::max<uint64_t>(header.max_field, batch.field[i]);
+      }
+    }
+    // zero filled, so that the padding is deterministic
+    buffer_.assign(header.RecordBytes(), '\0');
+    size_t pos = 0;
+    this->Append(&pos, &header, 1, sizeof(header));
+    uint64_t *offset = reinterpret_cast<uint64_t*>(&buffer_[pos]);
+    for (size_t i = 0; i <= nrow; ++i) {
+      offset[i] = static_cast<uint64_t>(batch.offset[i] - base);
+    }
+    pos += RowBlockRecordHeader::AlignedBytes(nrow + 1, sizeof(uint64_t));
+    this->Append(&pos, batch.label, nrow, sizeof(DType));
+    if (batch.weight != NULL) this->Append(&pos, batch.weight, nrow, sizeof(real_t));
+    if (batch.qid != NULL) this->Append(&pos, batch.qid, nrow, sizeof(uint64_t));
+    if (batch.field != NULL) this->Append(&pos, batch.field + base, nnz, sizeof(IndexType));
+    this->Append(&pos, batch.index + base, nnz, sizeof(IndexType));
+    if (batch.value != NULL) this->Append(&pos, batch.value + base, nnz, sizeof(DType));
+    CHECK_EQ(pos, buffer_.length());
+    if (index_ != NULL) {
+      std::ostringstream line;
+      line << num_records_ << '\t' << offset_ << '\n';
+      const std::string &text = line.str();
+      index_->Write(text.c_str(), text.length());
+    }
+    // each part of the record has an 8 byte head, the record is split
+    // at every magic number of its data, which is dropped
+    const size_t except_counter = writer_.except_counter();
+    writer_.WriteRecord(buffer_);
+    offset_ += 8 + ((buffer_.length() + 3) / 4) * 4 +
+        4 * (writer_.except_counter() - except_counter);
+    ++num_records_;
+  }
+};
+}  // namespace dmlc
+#endif  // DMLC_ROW_BLOCK_RECORDIO_H_
@@ -0,0 +1,375 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file row_block_text_writer.h
+ * \brief writer of RowBlocks in the libsvm, libfm and csv text formats
+ *  that the data parsers read back
+ */
+#ifndef DMLC_ROW_BLOCK_TEXT_WRITER_H_
+#define DMLC_ROW_BLOCK_TEXT_WRITER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "./base.h"
+#include "./common.h"
+#include "./data.h"
+#include "./io.h"
+#include "./logging.h"
+#include "./omp.h"
+#include "./parameter.h"
+
+namespace dmlc {
+/*! \brief maximum number of characters written by ToChars */
+const size_t kMaxNumberChars = 32;
+
+/*!
+ * \brief write the decimal digits of an unsigned integer
+ * \param out the output, at least kMaxNumberChars long
+ * \param value the value
+ * \return the end of the written characters
+ */
+inline char *ToChars(char *out, uint64_t value) {
+  static const char kDigitPairs[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+  char buf[24];
+  char *p = buf + sizeof(buf);
+  while (value >= 100) {
+    const size_t pair = static_cast<size_t>(value % 100) * 2;
+    value /= 100;
+    *--p = kDigitPairs[pair + 1];
+    *--p = kDigitPairs[pair];
+  }
+  if (value >= 10) {
+    *--p = kDigitPairs[value * 2 + 1];
+    *--p = kDigitPairs[value * 2];
+  } else {
+    *--p = static_cast<char>('0' + value);
+  }
+  const size_t n = buf + sizeof(buf) - p;
+  std::memcpy(out, p, n);
+  return out + n;
+}
+
+/*!
+ * \brief write the decimal digits of a signed integer
+ * \param out the output, at least kMaxNumberChars long
+ * \param value the value
+ * \return the end of the written characters
+ */
+inline char *ToChars(char *out, int64_t value) {
+  if (value >= 0) return ToChars(out, static_cast<uint64_t>(value));
+  *out++ = '-';
+  return ToChars(out, static_cast<uint64_t>(0) - static_cast<uint64_t>(value));
+}
+
+/*! \brief overload of ToChars for unsigned 32 bit integers */
+inline char *ToChars(char *out, uint32_t value) {
+  return ToChars(out, static_cast<uint64_t>(value));
+}
+
+/*! \brief overload of ToChars for signed 32 bit integers */
+inline char *ToChars(char *out, int32_t value) {
+  return ToChars(out, static_cast<int64_t>(value));
+}
+
+/*!
+ * \brief write the shortest decimal that reads back as the same float.
+ *  Values below 2^24 having such a decimal with at most 12 fractional
+ *  digits, which covers most of the data in practice, are formatted
+ *  without printf.
+ * \param out the output, at least kMaxNumberChars long
+ * \param value the value
+ * \return the end of the written characters
+ */
+inline char *ToChars(char *out, float value) {
+  static const double kPow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6,
+                                  1e7, 1e8, 1e9, 1e10, 1e11, 1e12};
+  if (std::isnan(value)) {
+    std::memcpy(out, "nan", 3);
+    return out + 3;
+  }
+  if (std::signbit(value)) {
+    *out++ = '-';
+    value = -value;
+  }
+  if (std::isinf(value)) {
+    std::memcpy(out, "inf", 3);
+    return out + 3;
+  }
+  const double v = value;
+  // below 2^24 the decimal with the fewest fractional digits is the shortest
+  for (int k = 0; k < 13 && v < 16777216.0; ++k) {
+    const double scaled = std::floor(v * kPow10[k] + 0.5);
+    if (scaled >= 1e15) break;
+    if (static_cast<float>(scaled / kPow10[k]) != value) continue;
+    // the digits of scaled with a decimal point k digits from the right
+    char digits[24];
+    const size_t n = ToChars(digits, static_cast<uint64_t>(scaled)) - digits;
+    if (k == 0) {
+      std::memcpy(out, digits, n);
+      return out + n;
+    }
+    if (n <= static_cast<size_t>(k)) {
+      *out++ = '0';
+      *out++ = '.';
+      for (size_t i = n; i < static_cast<size_t>(k); ++i) *out++ = '0';
+      std::memcpy(out, digits, n);
+      return out + n;
+    }
+    std::memcpy(out, digits, n - k);
+    out += n - k;
+    *out++ = '.';
+    std::memcpy(out, digits + n - k, k);
+    return out + k;
+  }
+  // 9 significant digits always read back as the same float
+  for (int precision = 1; precision <= 9; ++precision) {
+    const int n = snprintf(out, kMaxNumberChars - 1, "%.*g", precision, v);
+    if (precision == 9 || std::strtof(out, NULL) == value) return out + n;
+  }
+  return out;
+}
+
+/*! \brief parameters of RowBlockTextWriter */
+struct RowBlockTextWriterParam : public Parameter<RowBlockTextWriterParam> {
+  /*! \brief output format */
+  std::string format;
+  /*! \brief whether to write 1-based indices */
+  int indexing_mode;
+  /*! \brief number of feature columns of the csv format */
+  int num_col;
+  /*! \brief column of the label in the csv format */
+  int label_column;
+  /*! \brief column of the weight in the csv format */
+  int weight_column;
+  /*! \brief delimiter of the csv format */
+  std::string delimiter;
+  DMLC_DECLARE_PARAMETER(RowBlockTextWriterParam) {
+    DMLC_DECLARE_FIELD(format).set_default("libsvm")
+        .describe("Output format: libsvm, libfm or csv.");
+    DMLC_DECLARE_FIELD(indexing_mode).set_default(0)
+        .describe("If >0, write 1-based feature indices in the libsvm and libfm formats, "
+                  "otherwise 0-based ones.");
+    DMLC_DECLARE_FIELD(num_col).set_default(0)
+        .describe("Number of feature columns of the csv format, "
+                  "0 to use the largest index of the first block plus one.");
+    DMLC_DECLARE_FIELD(label_column).set_default(-1)
+        .describe("Column index (0-based) of the label in the csv format, -1 for none. "
+                  "The default matches the csv parser, which reads no label column "
+                  "unless told to.");
+    DMLC_DECLARE_FIELD(weight_column).set_default(-1)
+        .describe("Column index of the instance weight in the csv format, -1 for none.");
+    DMLC_DECLARE_FIELD(delimiter).set_default(",")
+        .describe("Delimiter of the csv format.");
+  }
+};
+
+/*!
+ * \brief writes RowBlocks as text.
+ *  The rows of a block are formatted by several threads into buffers
+ *  that are kept from block to block, and the buffers are written to the
+ *  stream in the order of the rows. The output reads back through
+ *  Parser::Create with the same format; libsvm and libfm lines are
+ *  label[:weight] [qid:id] [field:]index[:value] ..., and csv lines hold
+ *  num_col feature columns plus the optional label and weight columns,
+ *  with 0 for the features absent from a row. The csv label and weight
+ *  columns default to none on both sides, pass the same label_column and
+ *  weight_column to the writer and the parser.
+ *
+ * \code
+ *   std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create("part.csv", "w"));
+ *   dmlc::RowBlockTextWriter<uint32_t> writer(fo.get(), {{"format", "csv"}});
+ *   while (parser->Next()) writer.Write(parser->Value());
+ * \endcode
+ * \tparam IndexType type of index
+ * \tparam DType type of label and value
+ */
+template<typename IndexType, typename DType = real_t>
+class RowBlockTextWriter {
+ public:
+  /*!
+   * \brief constructor
+   * \param stream the output stream, not owned
+   * \param args arguments of RowBlockTextWriterParam
+   * \param nthread number of formatting threads, 0 for omp_get_max_threads()
+   */
+  RowBlockTextWriter(Stream *stream, const std::map<std::string, std::string> &args,
+                     int nthread = 0)
+      : stream_(stream), nthread_(nthread > 0 ? nthread : omp_get_max_threads()),
+        bytes_written_(0) {
+    param_.Init(args);
+    CHECK(param_.format == "libsvm" || param_.format == "libfm" || param_.format == "csv")
+        << "RowBlockTextWriter: unknown format " << param_.format;
+    CHECK_EQ(param_.delimiter.length(), 1U) << "RowBlockTextWriter: delimiter must be one char";
+    CHECK(param_.label_column != param_.weight_column || param_.label_column < 0)
+        << "RowBlockTextWriter: label and weight need distinct columns";
+    num_col_ = param_.num_col > 0 ? static_cast<size_t>(param_.num_col) : 0;
+  }
+  /*!
+   * \brief write the rows of a block
+   * \param batch the rows to write
+   */
+  inline void Write(const RowBlock<IndexType, DType> &batch) {
+    if (batch.size == 0) return;
+    if (param_.format == "csv" && num_col_ == 0) {
+      for (size_t i = batch.offset[0]; i < batch.offset[batch.size]; ++i) {
+        num_col_ = std::max(num_col_, static_cast<size_t>(batch.index[i]) + 1);
+      }
+    }
+    if (param_.format == "csv") {
+      const size_t ncolumn = num_col_ + (param_.label_column >= 0 ? 1 : 0) +
+          (param_.weight_column >= 0 ? 1 : 0);
+      CHECK(param_.label_column < static_cast<int>(ncolumn) &&
+            param_.weight_column < static_cast<int>(ncolumn))
+          << "RowBlockTextWriter: label or weight column beyond the last column";
+    }
+    // small blocks are not worth waking up threads for
+    const size_t kMinRowsPerThread = 256;
+    const int nthread = static_cast<int>(std::max<size_t>(1, std::min<size_t>(
+        nthread_, (batch.size + kMinRowsPerThread - 1) / kMinRowsPerThread)));
+    if (buffers_.size() < static_cast<size_t>(nthread)) buffers_.resize(nthread);
+    const size_t nstep = (batch.size + nthread - 1) / nthread;
+    if (nthread == 1) {
+      this->FormatRows(batch, 0, batch.size, &buffers_[0]);
+    } else {
+#pragma omp parallel num_threads(nthread)
+      {
+        omp_exc_.Run([&] {
+          const size_t tid = omp_get_thread_num();
+          const size_t begin = std::min(tid * nstep, batch.size);
+          const size_t end = std::min(begin + nstep, batch.size);
+          this->FormatRows(batch, begin, end, &buffers_[tid]);
+        });
+      }
+      omp_exc_.Rethrow();
+    }
+    for (int i = 0; i < nthread; ++i) {
+      stream_->Write(buffers_[i].data.data(), buffers_[i].size);
+      bytes_written_ += buffers_[i].size;
+    }
+  }
+  /*! \return number of bytes written so far */
+  inline size_t BytesWritten() const {
+    return bytes_written_;
+  }
+
+ private:
+  /*! \brief text formatted by a thread, data is kept from block to block */
+  struct Buffer {
+    /*! \brief the characters, possibly followed by unused space */
+    std::vector<char> data;
+    /*! \brief number of characters */
+    size_t size;
+    /*! \brief dense row of the csv format */
+    std::vector<DType> dense;
+    Buffer() : size(0) {}
+  };
+  /*! \brief the parameters */
+  RowBlockTextWriterParam param_;
+  /*! \brief the output stream */
+  Stream *stream_;
+  /*! \brief maximum number of formatting threads */
+  int nthread_;
+  /*! \brief number of feature columns of the csv format */
+  size_t num_col_;
+  /*! \brief number of bytes written */
+  size_t bytes_written_;
+  /*! \brief one buffer per formatting thread */
+  std::vector<Buffer> buffers_;
+  /*! \brief catches the errors of the formatting threads */
+  OMPException omp_exc_;
+  /*! \brief format the rows [begin, end) of a block into a buffer */
+  inline void FormatRows(const RowBlock<IndexType, DType> &batch,
+                         size_t begin, size_t end, Buffer *buffer) const {
+    buffer->size = 0;
+    const bool csv = param_.format == "csv";
+    if (csv) buffer->dense.assign(num_col_, DType(0));
+    for (size_t i = begin; i < end; ++i) {
+      // an upper bound of the length of the row, so that numbers are written
+      // without checks, the buffer grows with the rows rather than the worst case
+      const size_t bound = csv ? (num_col_ + 2) * (kMaxNumberChars + 1) :
+          3 * kMaxNumberChars + 8 +
+          (batch.offset[i + 1] - batch.offset[i]) * (3 * kMaxNumberChars + 3);
+      if (buffer->data.size() < buffer->size + bound) {
+        buffer->data.resize(std::max(buffer->size + bound, 2 * buffer->data.size()));
+      }
+      char *out = buffer->data.data() + buffer->size;
+      if (csv) {
+        out = this->FormatCSVRow(batch, i, out, &buffer->dense);
+      } else {
+        out = this->FormatSparseRow(batch, i, out);
+      }
+      buffer->size = out - buffer->data.data();
+    }
+  }
+  /*! \brief format a row in the libsvm or libfm format */
+  inline char *FormatSparseRow(const RowBlock<IndexType, DType> &batch, size_t row,
+                               char *out) const {
+    const IndexType base = param_.indexing_mode > 0 ? 1 : 0;
+    const bool has_field = param_.format == "libfm";
+    if (has_field) {
+      CHECK(batch.field != NULL) << "RowBlockTextWriter: libfm needs the fields of the rows";
+    }
+    out = ToChars(out, batch.label[row]);
+    if (batch.weight != NULL) {
+      *out++ = ':';
+      out = ToChars(out, batch.weight[row]);
+    }
+    if (batch.qid != NULL) {
+      std::memcpy(out, " qid:", 5);
+      out = ToChars(out + 5, static_cast<uint64_t>(batch.qid[row]));
+    }
+    for (size_t j = batch.offset[row]; j < batch.offset[row + 1]; ++j) {
+      *out++ = ' ';
+      if (has_field) {
+        out = ToChars(out, static_cast<uint64_t>(batch.field[j] + base));
+        *out++ = ':';
+      }
+      out = ToChars(out, static_cast<uint64_t>(batch.index[j] + base));
+      if (batch.value != NULL) {
+        *out++ = ':';
+        out = ToChars(out, batch.value[j]);
+      }
+    }
+    *out++ = '\n';
+    return out;
+  }
+  /*! \brief format a row in the csv format, dense is all zero and left so */
+  inline char *FormatCSVRow(const RowBlock<IndexType, DType> &batch, size_t row,
+                            char *out, std::vector<DType> *dense) const {
+    const size_t begin = batch.offset[row], end = batch.offset[row + 1];
+    for (size_t j = begin; j < end; ++j) {
+      CHECK_LT(static_cast<size_t>(batch.index[j]), num_col_)
+          << "RowBlockTextWriter: feature index beyond num_col";
+      (*dense)[batch.index[j]] = batch.value != NULL ? batch.value[j] : DType(1);
+    }
+    const size_t ncolumn = num_col_ + (param_.label_column >= 0 ? 1 : 0) +
+        (param_.weight_column >= 0 ? 1 : 0);
+    const char delimiter = param_.delimiter[0];
+    size_t feature = 0;
+    for (size_t column = 0; column < ncolumn; ++column) {
+      if (column != 0) *out++ = delimiter;
+      if (static_cast<int>(column) == param_.label_column) {
+        out = ToChars(out, batch.label[row]);
+      } else if (static_cast<int>(column) == param_.weight_column) {
+        out = ToChars(out, batch.weight != NULL ? batch.weight[row] : 1.0f);
+      } else {
+        out = ToChars(out, (*dense)[feature++]);
+      }
+    }
+    *out++ = '\n';
+    for (size_t j = begin; j < end; ++j) (*dense)[batch.index[j]] = DType(0);
+    return out;
+  }
+};
+}  // namespace dmlc
+#endif  // DMLC_ROW_BLOCK_TEXT_WRITER_H_
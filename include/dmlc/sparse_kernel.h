@@ -0,0 +1,246 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file sparse_kernel.h
+ * \brief batched sparse linear algebra kernels over RowBlock,
+ *  SpMV, transposed SpMV (gradient scatter) and small SpMM
+ */
+#ifndef DMLC_SPARSE_KERNEL_H_
+#define DMLC_SPARSE_KERNEL_H_
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "./base.h"
+#include "./common.h"
+#include "./data.h"
+#include "./logging.h"
+#include "./omp.h"
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace dmlc {
+/*! \brief internal implementation of the sparse kernels */
+namespace sparse_kernel_detail {
+/*!
+ * \brief dot product of a sparse vector and a dense vector,
+ *  the indices are assumed to be in range
+ */
+template<typename IndexType, typename DType, typename V>
+inline V ScalarDot(const IndexType *index, const DType *value, size_t n, const V *w) {
+  V s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+  size_t i = 0;
+  if (value == NULL) {
+    for (; i + 4 <= n; i += 4) {
+      s0 += w[index[i]]; s1 += w[index[i + 1]];
+      s2 += w[index[i + 2]]; s3 += w[index[i + 3]];
+    }
+    for (; i < n; ++i) s0 += w[index[i]];
+  } else {
+    for (; i + 4 <= n; i += 4) {
+      s0 += w[index[i]] * value[i];
+      s1 += w[index[i + 1]] * value[i + 1];
+      s2 += w[index[i + 2]] * value[i + 2];
+      s3 += w[index[i + 3]] * value[i + 3];
+    }
+    for (; i < n; ++i) s0 += w[index[i]] * value[i];
+  }
+  return (s0 + s1) + (s2 + s3);
+}
+
+/*! \brief row dot product kernel, specialized where SIMD gathers apply */
+template<typename IndexType, typename DType, typename V>
+struct DotKernel {
+  inline static V Run(const IndexType *index, const DType *value, size_t n,
+                      const V *w, size_t size) {
+    return ScalarDot(index, value, n, w);
+  }
+};
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+/*! \brief gather based dot product for 32-bit indices and float values */
+template<>
+struct DotKernel<uint32_t, float, float> {
+  inline static float Run(const uint32_t *index, const float *value, size_t n,
+                          const float *w, size_t size) {
+    // the gathers take signed 32-bit offsets
+    if (size > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+      return ScalarDot(index, value, n, w);
+    }
+    float sum = 0.0f;
+    size_t i = 0;
+#if defined(__AVX512F__)
+    __m512 acc16 = _mm512_setzero_ps();
+    for (; i + 16 <= n; i += 16) {
+      __m512i vi = _mm512_loadu_si512(reinterpret_cast<const void*>(index + i));
+      __m512 wv = _mm512_i32gather_ps(vi, w, 4);
+      acc16 = value == NULL ? _mm512_add_ps(acc16, wv)
+          : _mm512_fmadd_ps(wv, _mm512_loadu_ps(value + i), acc16);
+    }
+    sum += _mm512_reduce_add_ps(acc16);
+#endif
+#if defined(__AVX2__)
+    __m256 acc8 = _mm256_setzero_ps();
+    for (; i + 8 <= n; i += 8) {
+      __m256i vi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(index + i));
+      __m256 wv = _mm256_i32gather_ps(w, vi, 4);
+      acc8 = value == NULL ? _mm256_add_ps(acc8, wv)
+          : _mm256_add_ps(acc8, _mm256_mul_ps(wv, _mm256_loadu_ps(value + i)));
+    }
+    __m128 s4 = _mm_add_ps(_mm256_castps256_ps128(acc8), _mm256_extractf128_ps(acc8, 1));
+    s4 = _mm_add_ps(s4, _mm_movehl_ps(s4, s4));
+    s4 = _mm_add_ss(s4, _mm_shuffle_ps(s4, s4, 1));
+    sum += _mm_cvtss_f32(s4);
+#endif
+    if (value == NULL) {
+      for (; i < n; ++i) sum += w[index[i]];
+    } else {
+      for (; i < n; ++i) sum += w[index[i]] * value[i];
+    }
+    return sum;
+  }
+};
+#endif
+
+/*!
+ * \brief check that the feature indices of a row are below size,
+ *  the row is read again right after so the second pass hits the cache
+ */
+template<typename IndexType>
+inline void CheckIndexBound(const IndexType *index, size_t n, size_t size) {
+  IndexType max_index = 0;
+  for (size_t i = 0; i < n; ++i) {
+    max_index = std::max(max_index, index[i]);
+  }
+  CHECK(n == 0 || static_cast<size_t>(max_index) < size)
+      << "feature index exceed bound";
+}
+
+/*! \return number of threads to use for nnz entries */
+inline int NumThread(int nthread, size_t nnz) {
+  if (nthread <= 0) nthread = omp_get_max_threads();
+  // avoid the threading overhead on small blocks
+  const size_t kMinNnzPerThread = 1UL << 14UL;
+  return static_cast<int>(std::max<size_t>(
+      1, std::min<size_t>(nthread, nnz / kMinNnzPerThread)));
+}
+}  // namespace sparse_kernel_detail
+
+/*!
+ * \brief sparse matrix dense vector product, out = X * w
+ * \param batch the sparse matrix X
+ * \param w the dense vector, of length size
+ * \param size the length of w, all feature indices must be below it
+ * \param out the output, of length batch.size
+ * \param nthread number of threads, 0 means the OpenMP default
+ * \tparam V the type of w and out
+ */
+template<typename IndexType, typename DType, typename V>
+inline void SpMV(const RowBlock<IndexType, DType> &batch,
+                 const V *w, size_t size, V *out, int nthread = 0) {
+  typedef sparse_kernel_detail::DotKernel<IndexType, DType, V> Kernel;
+  const int nt = sparse_kernel_detail::NumThread(
+      nthread, batch.offset[batch.size] - batch.offset[0]);
+  const omp_ulong nrow = static_cast<omp_ulong>(batch.size);
+  OMPException omp_exc;
+  #pragma omp parallel for schedule(static) num_threads(nt)
+  for (omp_ulong i = 0; i < nrow; ++i) {
+    omp_exc.Run([&] {
+      const size_t begin = batch.offset[i], n = batch.offset[i + 1] - begin;
+      sparse_kernel_detail::CheckIndexBound(batch.index + begin, n, size);
+      out[i] = Kernel::Run(batch.index + begin,
+                           batch.value == NULL ? NULL : batch.value + begin,
+                           n, w, size);
+    });
+  }
+  omp_exc.Rethrow();
+}
+
+/*!
+ * \brief transposed sparse matrix dense vector product, out += X^T * g,
+ *  this is the gradient scatter of linear models.
+ *  Each thread accumulates into its own buffer which are summed at the end.
+ * \param batch the sparse matrix X
+ * \param g the dense vector, of length batch.size
+ * \param size the length of out, all feature indices must be below it
+ * \param out the output to accumulate into, of length size
+ * \param nthread number of threads, 0 means the OpenMP default
+ * \tparam V the type of g and out
+ */
+template<typename IndexType, typename DType, typename V>
+inline void SpMVTrans(const RowBlock<IndexType, DType> &batch,
+                      const V *g, size_t size, V *out, int nthread = 0) {
+  const int nt = sparse_kernel_detail::NumThread(
+      nthread, batch.offset[batch.size] - batch.offset[0]);
+  std::vector<V> buffer(nt > 1 ? static_cast<size_t>(nt) * size : 0);
+  const omp_ulong nrow = static_cast<omp_ulong>(batch.size);
+  OMPException omp_exc;
+  #pragma omp parallel num_threads(nt)
+  {
+    const int tid = omp_get_thread_num();
+    V *acc = nt > 1 ? BeginPtr(buffer) + tid * size : out;
+    #pragma omp for schedule(static)
+    for (omp_ulong i = 0; i < nrow; ++i) {
+      omp_exc.Run([&] {
+        const V gi = g[i];
+        if (gi == 0) return;
+        const size_t begin = batch.offset[i], end = batch.offset[i + 1];
+        sparse_kernel_detail::CheckIndexBound(batch.index + begin, end - begin, size);
+        if (batch.value == NULL) {
+          for (size_t j = begin; j < end; ++j) acc[batch.index[j]] += gi;
+        } else {
+          for (size_t j = begin; j < end; ++j) {
+            acc[batch.index[j]] += gi * batch.value[j];
+          }
+        }
+      });
+    }
+    if (nt > 1) {
+      // reduce the per-thread buffers, each thread owns a range of columns
+      #pragma omp for schedule(static)
+      for (omp_ulong j = 0; j < static_cast<omp_ulong>(size); ++j) {
+        V sum = 0;
+        for (int t = 0; t < nt; ++t) sum += buffer[t * size + j];
+        out[j] += sum;
+      }
+    }
+  }
+  omp_exc.Rethrow();
+}
+
+/*!
+ * \brief sparse matrix times small dense matrix, out = X * W
+ * \param batch the sparse matrix X
+ * \param w the dense matrix W in row major order, of shape size x k
+ * \param size the number of rows of W, all feature indices must be below it
+ * \param k the number of columns of W
+ * \param out the output in row major order, of shape batch.size x k
+ * \param nthread number of threads, 0 means the OpenMP default
+ * \tparam V the type of w and out
+ */
+template<typename IndexType, typename DType, typename V>
+inline void SpMM(const RowBlock<IndexType, DType> &batch,
+                 const V *w, size_t size, size_t k, V *out, int nthread = 0) {
+  const int nt = sparse_kernel_detail::NumThread(
+      nthread, (batch.offset[batch.size] - batch.offset[0]) * k);
+  const omp_ulong nrow = static_cast<omp_ulong>(batch.size);
+  OMPException omp_exc;
+  #pragma omp parallel for schedule(static) num_threads(nt)
+  for (omp_ulong i = 0; i < nrow; ++i) {
+    omp_exc.Run([&] {
+      V *dst = out + i * k;
+      std::fill(dst, dst + k, static_cast<V>(0));
+      const size_t begin = batch.offset[i], end = batch.offset[i + 1];
+      sparse_kernel_detail::CheckIndexBound(batch.index + begin, end - begin, size);
+      for (size_t j = begin; j < end; ++j) {
+        const V *src = w + static_cast<size_t>(batch.index[j]) * k;
+        const V x = batch.value == NULL ? static_cast<V>(1) : static_cast<V>(batch.value[j]);
+        for (size_t c = 0; c < k; ++c) dst[c] += x * src[c];
+      }
+    });
+  }
+  omp_exc.Rethrow();
+}
+}  // namespace dmlc
+#endif  // DMLC_SPARSE_KERNEL_H_
@@ -9,12 +9,15 @@
 #include <dmlc/concurrentqueue.h>
 #include <dmlc/blockingconcurrentqueue.h>
 #include <dmlc/logging.h>
+#include <dmlc/timer_wheel.h>
+#include <memory>
 #include <string>
 #include <mutex>
 #include <set>
 #include <thread>
 #include <unordered_set>
 #include <unordered_map>
+#include <vector>
 #if defined(DMLC_USE_CXX14) || __cplusplus > 201103L  /* C++14 */
 #include <shared_mutex>
 #endif
@@ -239,11 +242,13 @@ class ThreadGroup {
 
     /*!
      * \brief Get this thread's id
-     * \return this thread's id
+     * \return this thread's id, or a default id if no stl thread is associated
+     *         with this object (i.e. a timer running on the TimerWheelThread)
      */
     std::thread::id get_id() const {
       ReadLock guard(thread_mutex_);
-      return thread_.load()->get_id();
+      std::thread *thrd = thread_.load();
+      return thrd ? thrd->get_id() : std::thread::id();
     }
 
    private:
@@ -440,8 +445,14 @@ class ThreadGroup {
    */
   inline void request_shutdown_all(const bool make_all_joinable = true) {
     std::unique_lock<std::mutex> lk(join_all_mtx_);
-    ReadLock guard(m_);
-    for (auto &thread : threads_) {
+    // request_shutdown() may remove the thread from this ThreadGroup (i.e. timers),
+    // so it is called without holding the lock
+    std::vector<std::shared_ptr<Thread>> threads;
+    {
+      ReadLock guard(m_);
+      threads.assign(threads_.begin(), threads_.end());
+    }
+    for (auto &thread : threads) {
       if (make_all_joinable) {
         thread->make_joinable();
       }
@@ -578,6 +589,17 @@ class BlockingQueueThread : public ThreadGroup::Thread {
     }
   }
 
+  /*!
+   * \brief Enqueue several items at once
+   * \param items Pointer to the first item to enqueue
+   * \param count Number of items to enqueue
+   */
+  void enqueue_bulk(const ObjectType *items, size_t count) {
+    if (!shutdown_in_progress_) {
+      queue_->enqueue_bulk(items, count);
+    }
+  }
+
   /*!
    * \brief Get the approximate size of the queue
    * \return The approximate size of the queue
@@ -604,6 +626,28 @@ class BlockingQueueThread : public ThreadGroup::Thread {
                                        pThis, secondary_function);
   }
 
+  /*!
+   * \brief Launch to the 'run_batch' function which will, in turn, hand all the items
+   *        queued at once to the given 'batch_function', up to 'max_batch' of them
+   * \tparam BatchFunction Type of the batch function, taking (ObjectType *items, size_t count)
+   *         and returning nonzero to request an exit
+   * \param pThis Pointer to the managed thread to launch
+   * \param batch_function Function to call with each batch of dequeued items
+   * \param max_batch Maximum number of items per batch
+   * \return true if thread is launched successfully and added to the ThreadGroup
+   */
+  template<typename BatchFunction>
+  static bool launch_run_batch(std::shared_ptr<BQT> pThis,
+                               BatchFunction batch_function,
+                               size_t max_batch = 256) {
+    return ThreadGroup::Thread::launch(pThis, true, [](std::shared_ptr<BQT> pThis,
+                                                       BatchFunction batch_function,
+                                                       size_t max_batch) {
+                                         return pThis->run_batch(batch_function, max_batch);
+                                       },
+                                       pThis, batch_function, max_batch);
+  }
+
   /*!
    * \brief Thread's main queue processing function
    * \tparam OnItemFunction Function type to call when an item is dequeued
@@ -627,6 +671,37 @@ class BlockingQueueThread : public ThreadGroup::Thread {
     return rc;
   }
 
+  /*!
+   * \brief Thread's batch queue processing function, waits for at least one item and
+   *        dequeues all the queued items, up to max_batch, in a single operation
+   * \tparam OnItemsFunction Function type to call with the dequeued items
+   * \param on_items_function Function to call with (ObjectType *items, size_t count)
+   * \param max_batch Maximum number of items per call
+   * \return 0 if completed through a `quit_item`, nonzero if on_items_function requested an exit
+   * \note Items dequeued after the `quit_item` in the same batch are dropped
+   */
+  template<typename OnItemsFunction>
+  inline int run_batch(OnItemsFunction on_items_function, size_t max_batch) {
+    CHECK_GT(max_batch, 0U);
+    std::unique_ptr<ObjectType[]> items(new ObjectType[max_batch]);
+    int rc = 0;
+    bool quit = false;
+    while (!quit && !rc) {
+      size_t count = queue_->wait_dequeue_bulk(items.get(), max_batch);
+      for (size_t i = 0; i < count; ++i) {
+        if (items[i] == quit_item) {
+          count = i;
+          quit = true;
+          break;
+        }
+      }
+      if (count != 0) {
+        rc = on_items_function(items.get(), count);
+      }
+    }
+    return rc;
+  }
+
  private:
   /*! \brief The blocking queue associated with this thread */
   std::shared_ptr<dmlc::moodycamel::BlockingConcurrentQueue<ObjectType>> queue_ =
@@ -636,8 +711,78 @@ class BlockingQueueThread : public ThreadGroup::Thread {
 };
 
 /*!
- * \brief Managed timer thread
+ * \brief Managed thread running a TimerWheel, shared by the timers of a ThreadGroup
+ */
+class TimerWheelThread : public ThreadGroup::Thread {
+ public:
+  /*!
+   * \brief Constructor
+   * \param name Name of the timer wheel thread
+   * \param owner ThreadGroup owner of the timer wheel thread
+   */
+  TimerWheelThread(const std::string& name, ThreadGroup *owner)
+    : Thread(name, owner) {
+  }
+
+  /*!
+   * \brief Destructor
+   */
+  ~TimerWheelThread() override {
+    request_shutdown();
+  }
+
+  /*!
+   * \brief Signal the thread to exit, the pending timers are dropped
+   */
+  void request_shutdown() override {
+    ThreadGroup::Thread::request_shutdown();
+    wheel_.Stop();
+  }
+
+  /*!
+   * \brief The timer wheel run by this thread
+   * \return Pointer to the timer wheel
+   */
+  TimerWheel *wheel() {
+    return &wheel_;
+  }
+
+  /*!
+   * \brief Get the timer wheel thread of a ThreadGroup, launched on first use
+   * \param owner The ThreadGroup
+   * \return The timer wheel thread of the ThreadGroup, named "dmlc::TimerWheelThread"
+   */
+  static std::shared_ptr<TimerWheelThread> get(ThreadGroup *owner) {
+    const std::string kName = "dmlc::TimerWheelThread";
+    while (true) {
+      std::shared_ptr<TimerWheelThread> thrd =
+        std::dynamic_pointer_cast<TimerWheelThread>(owner->thread_by_name(kName));
+      if (thrd) {
+        return thrd;
+      }
+      thrd = std::make_shared<TimerWheelThread>(kName, owner);
+      ThreadGroup::Thread::launch(thrd, false, [](std::shared_ptr<TimerWheelThread> pThis) {
+                                    pThis->wheel_.Run();
+                                    return 0;
+                                  },
+                                  thrd);
+      // Another thread may have launched its wheel first, in which case ours is shut down
+      if (owner->thread_by_name(kName) == thrd) {
+        return thrd;
+      }
+    }
+  }
+
+ private:
+  /*! \brief The timer wheel */
+  TimerWheel wheel_;
+};
+
+/*!
+ * \brief Managed timer
  * \tparam Duration Duration type (ie seconds, microseconds, etc)
+ * \note Timers started with start() share the TimerWheelThread of their ThreadGroup rather
+ *       than running a thread each
  */
 template<typename Duration>
 class TimerThread : public ThreadGroup::Thread {
@@ -650,7 +795,9 @@ class TimerThread : public ThreadGroup::Thread {
    * \param owner ThreadGroup owner if the timer thread
    */
   TimerThread(const std::string& name, ThreadGroup *owner)
-    : Thread(name, owner) {
+    : Thread(name, owner)
+      , group_(owner)
+      , timer_id_(0) {
   }
 
   /*!
@@ -660,6 +807,21 @@ class TimerThread : public ThreadGroup::Thread {
     request_shutdown();
   }
 
+  /*!
+   * \brief Signal that the timer should stop, cancelling it on the timer wheel
+   *        and removing it from its ThreadGroup
+   */
+  void request_shutdown() override {
+    ThreadGroup::Thread::request_shutdown();
+    if (wheel_thread_) {
+      wheel_thread_->wheel()->Cancel(timer_id_);
+    }
+    std::shared_ptr<TimerThread> self = self_.lock();
+    if (self) {
+      group_->remove_thread(self);
+    }
+  }
+
   /*!
    * \brief Launch to the 'run' function which will, in turn, call the class'
    *        'run' function, passing it the given 'secondary_function'
@@ -681,20 +843,36 @@ class TimerThread : public ThreadGroup::Thread {
   }
 
   /*!
-   * \brief Start a given timer thread
+   * \brief Start a given timer on the TimerWheelThread of its ThreadGroup
    * \tparam Function Type of the timer function
-   * \param timer_thread Thread object to perform the timer events
+   * \param timer_thread Timer object to perform the timer events
    * \param duration Duration between the end end of the timer function and the next timer event
    * \param function Function to call when the timer expires
-   * \note Calling shutdown_requested() will cause the thread to exit the next time that the timer
-   *       expires.
+   * \return true if the timer was added to the ThreadGroup and started
+   * \note The timer is added to the ThreadGroup by name without a thread of its own.
+   *       Calling request_shutdown() on the timer, or on the TimerWheelThread through the
+   *       ThreadGroup, cancels the timer.
    */
   template<typename Function>
-  static void start(std::shared_ptr<TimerThread> timer_thread,
+  static bool start(std::shared_ptr<TimerThread> timer_thread,
                     Duration duration,
                     Function function) {
+    if (!timer_thread->group_->add_thread(timer_thread)) {
+      timer_thread->request_shutdown();
+      LOG(ERROR) << "Duplicate thread name within the same thread group is not allowed";
+      return false;
+    }
+    timer_thread->self_ = timer_thread;
     timer_thread->duration_ = duration;
-    launch_run(timer_thread, function);
+    timer_thread->wheel_thread_ = TimerWheelThread::get(timer_thread->group_);
+    timer_thread->timer_id_ = timer_thread->wheel_thread_->wheel()->SchedulePeriodic(
+      std::chrono::duration_cast<TimerWheel::Clock::duration>(duration),
+      [timer_thread, function]() mutable {
+        if (!timer_thread->is_shutdown_requested()) {
+          function();
+        }
+      });
+    return true;
   }
 
   /*!
@@ -716,7 +894,16 @@ class TimerThread : public ThreadGroup::Thread {
   }
 
  private:
+  /*! \brief Duration between the timer events */
   Duration duration_;
+  /*! \brief ThreadGroup owner of the timer */
+  ThreadGroup *group_;
+  /*! \brief The timer wheel thread running the timer, once started */
+  std::shared_ptr<TimerWheelThread> wheel_thread_;
+  /*! \brief Identifier of the timer on the timer wheel */
+  TimerWheel::TimerId timer_id_;
+  /*! \brief This timer, to remove it from its ThreadGroup once started */
+  std::weak_ptr<TimerThread> self_;
 };
 
 /*
@@ -800,8 +987,7 @@ inline bool CreateTimer(const std::string& timer_name,
                         TimerFunction timer_function) {
   std::shared_ptr<dmlc::TimerThread<Duration>> timer_thread =
     std::make_shared<dmlc::TimerThread<Duration>>(timer_name, owner);
-  dmlc::TimerThread<Duration>::start(timer_thread, duration, timer_function);
-  return timer_thread != nullptr;
+  return dmlc::TimerThread<Duration>::start(timer_thread, duration, timer_function);
 }
 }  // namespace dmlc
 
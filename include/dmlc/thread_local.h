@@ -11,6 +11,19 @@
 #include <vector>
 #include "./base.h"
 
+#if DMLC_CXX11_THREAD_LOCAL
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "./logging.h"
+#endif  // DMLC_CXX11_THREAD_LOCAL
+
 namespace dmlc {
 
 // macro hanlding for threadlocal variables
@@ -78,6 +91,296 @@ class ThreadLocalStore {
   std::vector<T*> data_;
 };
 
+#if DMLC_CXX11_THREAD_LOCAL
+/*!
+ * \brief per thread instances of T that can be enumerated from any thread,
+ *  for state that is updated locally and merged on demand such as counters,
+ *  statistics or free lists.
+ *
+ *  Each thread gets its instance on the first Get and the instance is
+ *  destroyed when the thread exits, after an optional exit hook merged it.
+ *  ForEach walks the live instances without locking and without blocking
+ *  the threads that register; a thread that exits waits for the visits of
+ *  its instance in progress. The slots of exited threads are reused by new
+ *  threads, so the slots of a registry are bounded by its peak number of
+ *  threads. The identifiers of destroyed registries are reused too, so the
+ *  table each thread keeps is bounded by the peak number of live registries.
+ * \code
+ *   dmlc::ThreadLocalRegistry<std::atomic<int64_t> > bytes;
+ *   bytes.Get()->fetch_add(n, std::memory_order_relaxed);  // on any thread
+ *   int64_t total = 0;
+ *   bytes.ForEach([&total](std::atomic<int64_t> &v) { total += v.load(); });
+ * \endcode
+ * \tparam T the type of the instances, default constructible
+ */
+template<typename T>
+class ThreadLocalRegistry {
+ public:
+  /*! \brief called on an instance after construction, before it becomes visible */
+  typedef std::function<void(T*)> InitHook;
+  /*! \brief called on the instance of an exiting thread, after it stops being visible */
+  typedef std::function<void(T*)> ExitHook;
+  /*!
+   * \brief constructor
+   * \param init called on each new instance
+   * \param on_exit called on the instance of each exiting thread before its destruction
+   */
+  explicit ThreadLocalRegistry(InitHook init = InitHook(), ExitHook on_exit = ExitHook())
+      : id_(Ids()->Acquire()), state_(std::make_shared<State>()) {
+    state_->init = init;
+    state_->on_exit = on_exit;
+  }
+  /*!
+   * \brief destructor, destroys the instances of the threads still running,
+   *  they must not use the registry anymore. Waits for the exit hooks of the
+   *  threads exiting concurrently, so the hooks never outlive the registry.
+   */
+  ~ThreadLocalRegistry() {
+    for (Node *node = state_->head.load(); node != nullptr; node = node->next) {
+      state_->Destroy(node, false);
+    }
+    while (state_->exiting.load() != 0) std::this_thread::yield();
+    Ids()->Release(id_);
+  }
+  /*! \return the instance of the calling thread, created on first use */
+  inline T *Get() {
+    std::vector<Entry> &local = LocalEntries()->entries;
+    // the entry may be left by a destroyed registry that had the same identifier
+    if (id_ < local.size() && local[id_].node != nullptr && local[id_].state == state_) {
+      return local[id_].node->value();
+    }
+    Node *node = state_->Acquire();
+    if (local.size() <= id_) local.resize(id_ + 1);
+    local[id_].state = state_;
+    local[id_].node = node;
+    return node->value();
+  }
+  /*!
+   * \brief visit the instances of all the live threads
+   * \param visit called with a reference to each instance, possibly while its
+   *  thread updates it
+   */
+  template<typename Visitor>
+  inline void ForEach(Visitor visit) {
+    for (Node *node = state_->head.load(std::memory_order_acquire);
+         node != nullptr; node = node->next) {
+      node->readers.fetch_add(1);
+      if (node->status.load() == kLive) visit(*node->value());
+      node->readers.fetch_sub(1, std::memory_order_release);
+    }
+  }
+  /*! \return number of live instances */
+  inline size_t NumLive() {
+    size_t count = 0;
+    for (Node *node = state_->head.load(std::memory_order_acquire);
+         node != nullptr; node = node->next) {
+      if (node->status.load() == kLive) ++count;
+    }
+    return count;
+  }
+
+ private:
+  /*! \brief status of a slot */
+  enum Status { kFree, kBusy, kLive };
+  /*! \brief slot of an instance, never freed before the registry state */
+  struct Node {
+    /*! \brief storage of the instance */
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+    /*! \brief kLive while the instance is visible */
+    std::atomic<int> status;
+    /*! \brief number of visits in progress */
+    std::atomic<int> readers;
+    /*! \brief next slot, immutable once published */
+    Node *next;
+    Node() : status(kBusy), readers(0), next(nullptr) {}
+    T *value() {
+      return reinterpret_cast<T*>(&storage);
+    }
+  };
+  /*! \brief the slots, shared with the threads so that they may exit after the registry */
+  struct State {
+    /*! \brief the published slots */
+    std::atomic<Node*> head;
+    /*! \brief number of exiting threads that may be running the exit hook */
+    std::atomic<int> exiting;
+    /*! \brief the hooks */
+    InitHook init;
+    ExitHook on_exit;
+    State() : head(nullptr), exiting(0) {}
+    ~State() {
+      Node *node = head.load();
+      while (node != nullptr) {
+        Node *next = node->next;
+        delete node;
+        node = next;
+      }
+    }
+    /*! \return a slot holding a new instance, reusing the slot of an exited thread */
+    Node *Acquire() {
+      Node *node = head.load(std::memory_order_acquire);
+      for (; node != nullptr; node = node->next) {
+        int expected = kFree;
+        if (node->status.compare_exchange_strong(expected, kBusy)) break;
+      }
+      const bool reused = node != nullptr;
+      if (!reused) node = new Node();
+      new (node->value()) T();
+      if (init) init(node->value());
+      node->status.store(kLive);
+      if (!reused) {
+        Node *first = head.load(std::memory_order_relaxed);
+        do {
+          node->next = first;
+        } while (!head.compare_exchange_weak(first, node, std::memory_order_release,
+                                             std::memory_order_relaxed));
+      }
+      return node;
+    }
+    /*!
+     * \brief hide and destroy an instance once its visits complete
+     * \param node the slot of the instance
+     * \param exiting whether its thread exits, running the exit hook
+     */
+    void Destroy(Node *node, bool exiting) {
+      // counted before the race, so a registry that loses it waits for the hook
+      if (exiting) this->exiting.fetch_add(1);
+      int expected = kLive;
+      // the registry and the exiting thread may race, only one destroys
+      if (node->status.compare_exchange_strong(expected, kBusy)) {
+        while (node->readers.load() != 0) std::this_thread::yield();
+        if (exiting && on_exit) on_exit(node->value());
+        node->value()->~T();
+        if (exiting) node->status.store(kFree);
+      }
+      if (exiting) this->exiting.fetch_sub(1);
+    }
+  };
+  /*! \brief the slot of the calling thread in a registry */
+  struct Entry {
+    std::shared_ptr<State> state;
+    Node *node;
+    Entry() : node(nullptr) {}
+  };
+  /*! \brief the slots of the calling thread, released when it exits */
+  struct LocalSlots {
+    std::vector<Entry> entries;
+    ~LocalSlots() {
+      for (size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].node != nullptr) entries[i].state->Destroy(entries[i].node, true);
+      }
+    }
+  };
+  /*! \brief identifier of the registry, indexes the slots of each thread */
+  size_t id_;
+  /*! \brief the slots */
+  std::shared_ptr<State> state_;
+  /*! \return the slots of the calling thread, by registry identifier */
+  static LocalSlots *LocalEntries() {
+    static thread_local LocalSlots local;
+    return &local;
+  }
+  /*! \brief the registry identifiers, the smallest free one is handed out first */
+  struct IdPool {
+    std::mutex mutex;
+    size_t next;
+    std::vector<size_t> free;
+    IdPool() : next(0) {}
+    size_t Acquire() {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (free.empty()) return next++;
+      auto it = std::min_element(free.begin(), free.end());
+      const size_t id = *it;
+      *it = free.back();
+      free.pop_back();
+      return id;
+    }
+    void Release(size_t id) {
+      std::lock_guard<std::mutex> lock(mutex);
+      free.push_back(id);
+    }
+  };
+  /*! \return the identifiers, never destroyed as registries may be static */
+  static IdPool *Ids() {
+    static IdPool *ids = new IdPool();
+    return ids;
+  }
+};
+
+/*!
+ * \brief bump allocator of the calling thread for short lived allocations,
+ *  released all at once by Reset or when the thread exits
+ */
+class ThreadLocalArena {
+ public:
+  /*! \brief size of the blocks the allocations are carved from */
+  static const size_t kBlockSize = 64 << 10;
+  ThreadLocalArena() : block_(0), offset_(0), bytes_allocated_(0) {}
+  /*! \return the arena of the calling thread */
+  static ThreadLocalArena *Get() {
+    return ThreadLocalStore<ThreadLocalArena>::Get();
+  }
+  /*!
+   * \brief allocate uninitialized memory, valid until the next Reset
+   * \param size number of bytes
+   * \param align alignment, a power of two
+   * \return the memory
+   */
+  inline void *Allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+    CHECK(align != 0 && (align & (align - 1)) == 0) << "alignment must be a power of two";
+    bytes_allocated_ += size;
+    if (size + align > kBlockSize / 4) {
+      // large allocations get a block of their own, ahead of the current one
+      std::unique_ptr<char[]> large(new char[size + align]);
+      void *ptr = AlignUp(large.get(), align);
+      large_.push_back(std::move(large));
+      return ptr;
+    }
+    while (true) {
+      if (block_ < blocks_.size()) {
+        char *begin = blocks_[block_].get();
+        char *ptr = AlignUp(begin + offset_, align);
+        if (ptr + size <= begin + kBlockSize) {
+          offset_ = ptr + size - begin;
+          return ptr;
+        }
+        ++block_;
+      } else {
+        blocks_.emplace_back(new char[kBlockSize]);
+      }
+      offset_ = 0;
+    }
+  }
+  /*! \brief release all the allocations, the blocks are kept for the next ones */
+  inline void Reset() {
+    large_.clear();
+    block_ = 0;
+    offset_ = 0;
+    bytes_allocated_ = 0;
+  }
+  /*! \return number of bytes allocated since the last Reset */
+  inline size_t BytesAllocated() const {
+    return bytes_allocated_;
+  }
+
+ private:
+  /*! \brief the blocks */
+  std::vector<std::unique_ptr<char[]> > blocks_;
+  /*! \brief allocations larger than a fraction of a block */
+  std::vector<std::unique_ptr<char[]> > large_;
+  /*! \brief the block being carved */
+  size_t block_;
+  /*! \brief used bytes of the block being carved */
+  size_t offset_;
+  /*! \brief number of bytes allocated */
+  size_t bytes_allocated_;
+  /*! \return ptr rounded up to the alignment */
+  inline static char *AlignUp(char *ptr, size_t align) {
+    const uintptr_t value = reinterpret_cast<uintptr_t>(ptr);
+    return ptr + ((align - value % align) % align);
+  }
+};
+#endif  // DMLC_CXX11_THREAD_LOCAL
+
 }  // namespace dmlc
 
 #endif  // DMLC_THREAD_LOCAL_H_
@@ -19,6 +19,7 @@
 #include <thread>
 #include "./data.h"
 #include "./logging.h"
+#include "./trace.h"
 
 namespace dmlc {
 /*!
@@ -313,15 +314,18 @@ inline void ThreadedIter<DType>::Init(std::function<bool(DType **)> next,
           // lockscope
           std::unique_lock<std::mutex> lock(mutex_);
           ++this->nwait_producer_;
-          producer_cond_.wait(lock, [this]() {
-            if (producer_sig_ == kProduce) {
-              bool ret = !produce_end_ && (queue_.size() < max_capacity_ ||
-                                           free_cells_.size() != 0);
-              return ret;
-            } else {
-              return true;
-            }
-          });
+          {
+            DMLC_TRACE_SCOPE("ThreadedIter::ProducerWait", "queue");
+            producer_cond_.wait(lock, [this]() {
+              if (producer_sig_ == kProduce) {
+                bool ret = !produce_end_ && (queue_.size() < max_capacity_ ||
+                                             free_cells_.size() != 0);
+                return ret;
+              } else {
+                return true;
+              }
+            });
+          }
           --this->nwait_producer_;
           if (producer_sig_ == kProduce) {
             if (free_cells_.size() != 0) {
@@ -354,7 +358,10 @@ inline void ThreadedIter<DType>::Init(std::function<bool(DType **)> next,
           }
         }  // end of lock scope
         // now without lock
-        produce_end_ = !next(&cell);
+        {
+          DMLC_TRACE_SCOPE("ThreadedIter::Produce", "queue");
+          produce_end_ = !next(&cell);
+        }
         DCHECK(cell != NULL || produce_end_);
         bool notify;
         {
@@ -416,8 +423,11 @@ inline bool ThreadedIter<DType>::Next(DType **out_dptr) {
   CHECK(producer_sig_ == kProduce)
       << "Make sure you call BeforeFirst not inconcurrent with Next!";
   ++nwait_consumer_;
-  consumer_cond_.wait(lock,
-                      [this]() { return queue_.size() != 0 || produce_end_; });
+  {
+    DMLC_TRACE_SCOPE("ThreadedIter::ConsumerWait", "queue");
+    consumer_cond_.wait(lock,
+                        [this]() { return queue_.size() != 0 || produce_end_; });
+  }
   --nwait_consumer_;
   if (queue_.size() != 0) {
     *out_dptr = queue_.front();
@@ -11,6 +11,7 @@
 
 #if DMLC_USE_CXX11
 #include <chrono>
+#include <cstdint>
 #endif
 
 #include <time.h>
@@ -20,6 +21,18 @@
 #endif
 #include "./logging.h"
 
+#if DMLC_USE_CXX11
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define DMLC_TIMER_USE_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define DMLC_TIMER_USE_TSC 1
+#else
+#define DMLC_TIMER_USE_TSC 0
+#endif
+#endif  // DMLC_USE_CXX11
+
 namespace dmlc {
 /*!
  * \brief return time in seconds
@@ -45,5 +58,117 @@ inline double GetTime(void) {
   #endif
   #endif
 }
+
+#if DMLC_USE_CXX11
+/*!
+ * \brief return time in seconds from a monotonic clock, unaffected by
+ *  adjustments of the wall clock, only differences of two calls are meaningful
+ */
+inline double GetMonotonicTime(void) {
+  return std::chrono::duration<double>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*!
+ * \brief return a cheap monotonic tick count, the time stamp counter of the
+ *  CPU on x86 and nanoseconds of the steady clock elsewhere.
+ *  Use it to time short sections, converted to seconds by TicksToSeconds.
+ *  The time stamp counter is assumed to be invariant, as on all recent x86
+ *  CPUs, so that ticks read on different cores are comparable.
+ */
+inline uint64_t GetTicks(void) {
+#if DMLC_TIMER_USE_TSC
+  return static_cast<uint64_t>(__rdtsc());
+#else
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif  // DMLC_TIMER_USE_TSC
+}
+
+/*!
+ * \return number of ticks of GetTicks per second, the time stamp counter is
+ *  calibrated against the steady clock for a few milliseconds on first use
+ */
+inline double TicksPerSecond(void) {
+#if DMLC_TIMER_USE_TSC
+  static const double ticks_per_second = []() {
+    typedef std::chrono::steady_clock clock;
+    const clock::time_point start = clock::now();
+    const uint64_t start_ticks = GetTicks();
+    clock::time_point now;
+    do {
+      now = clock::now();
+    } while (now - start < std::chrono::milliseconds(5));
+    const uint64_t ticks = GetTicks() - start_ticks;
+    return static_cast<double>(ticks) / std::chrono::duration<double>(now - start).count();
+  }();
+  return ticks_per_second;
+#else
+  return 1e9;
+#endif  // DMLC_TIMER_USE_TSC
+}
+
+/*!
+ * \brief convert a difference of GetTicks to seconds
+ * \param ticks the number of ticks
+ * \return the duration in seconds
+ */
+inline double TicksToSeconds(uint64_t ticks) {
+  return static_cast<double>(ticks) / TicksPerSecond();
+}
+
+/*!
+ * \brief measures the time elapsed since its construction or last Reset
+ *  with GetTicks
+ */
+class Stopwatch {
+ public:
+  Stopwatch() : start_(GetTicks()) {}
+  /*! \brief restart the measure */
+  inline void Reset() {
+    start_ = GetTicks();
+  }
+  /*! \return ticks elapsed since the start */
+  inline uint64_t ElapsedTicks() const {
+    return GetTicks() - start_;
+  }
+  /*! \return seconds elapsed since the start */
+  inline double Elapsed() const {
+    return TicksToSeconds(this->ElapsedTicks());
+  }
+
+ private:
+  /*! \brief ticks at the start */
+  uint64_t start_;
+};
+
+/*!
+ * \brief adds the time spent in a scope to a total
+ * \code
+ *   double read_time = 0;
+ *   {
+ *     ScopedTimer timer(&read_time);
+ *     stream->Read(buf, size);
+ *   }
+ * \endcode
+ */
+class ScopedTimer {
+ public:
+  /*!
+   * \brief start timing the scope
+   * \param total the total in seconds the duration of the scope is added to
+   */
+  explicit ScopedTimer(double *total) : total_(total) {}
+  ~ScopedTimer() {
+    *total_ += watch_.Elapsed();
+  }
+
+ private:
+  /*! \brief the total to add to */
+  double *total_;
+  /*! \brief measures the scope */
+  Stopwatch watch_;
+};
+#endif  // DMLC_USE_CXX11
 }  // namespace dmlc
 #endif  // DMLC_TIMER_H_
@@ -0,0 +1,296 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file timer_wheel.h
+ * \brief hierarchical timer wheel running many one-shot and periodic
+ *  callbacks on a single thread
+ */
+#ifndef DMLC_TIMER_WHEEL_H_
+#define DMLC_TIMER_WHEEL_H_
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./base.h"
+#include "./logging.h"
+
+namespace dmlc {
+/*!
+ * \brief schedules callbacks on the thread calling Run.
+ *  Time is cut in ticks of a fixed resolution. Timers due within 256 ticks
+ *  sit in the slot of their tick in the first wheel, later ones in coarser
+ *  wheels of 256 slots each, and move down a wheel each time the finer wheel
+ *  completes a turn. Scheduling and cancelling are constant time. The
+ *  running thread sleeps while no timer is scheduled; otherwise it wakes up
+ *  for the next tick with a timer due in the first wheel, and at least at
+ *  the end of each turn of it (every 256 ticks) to move the coarser timers
+ *  down.
+ * \code
+ *   dmlc::TimerWheel wheel;
+ *   std::thread runner([&wheel]() { wheel.Run(); });
+ *   dmlc::TimerWheel::TimerId heartbeat =
+ *       wheel.SchedulePeriodic(std::chrono::seconds(1), SendHeartbeat);
+ *   ...
+ *   wheel.Cancel(heartbeat);
+ *   wheel.Stop();
+ *   runner.join();
+ * \endcode
+ */
+class TimerWheel {
+ public:
+  /*! \brief identifies a scheduled timer */
+  typedef uint64_t TimerId;
+  /*! \brief function called when a timer expires */
+  typedef std::function<void()> Callback;
+  /*! \brief the clock of the deadlines */
+  typedef std::chrono::steady_clock Clock;
+  /*! \brief bits of the slot index in each wheel */
+  static const int kSlotBits = 8;
+  /*! \brief number of slots of each wheel */
+  static const uint64_t kNumSlots = 1ULL << kSlotBits;
+  /*! \brief number of wheels, later deadlines wait in the last one */
+  static const int kNumWheels = 4;
+  /*!
+   * \brief constructor
+   * \param resolution duration of a tick, deadlines are rounded up to ticks
+   */
+  explicit TimerWheel(Clock::duration resolution = std::chrono::milliseconds(1))
+      : resolution_(resolution), start_(Clock::now()), current_(0),
+        next_id_(1), stopped_(false), slots_(kNumWheels * kNumSlots) {
+    CHECK(resolution_.count() > 0) << "TimerWheel: resolution must be positive";
+  }
+  /*!
+   * \brief call a function once after a delay
+   * \param delay the delay
+   * \param callback the function, called on the thread running the wheel
+   * \return identifier of the timer
+   */
+  inline TimerId Schedule(Clock::duration delay, Callback callback) {
+    return this->Add(delay, Clock::duration::zero(), std::move(callback));
+  }
+  /*!
+   * \brief call a function periodically, the next call is scheduled a
+   *  period after the previous one returns
+   * \param period the period, also the delay of the first call
+   * \param callback the function, called on the thread running the wheel
+   * \return identifier of the timer
+   */
+  inline TimerId SchedulePeriodic(Clock::duration period, Callback callback) {
+    CHECK(period > Clock::duration::zero()) << "TimerWheel: period must be positive";
+    return this->Add(period, period, std::move(callback));
+  }
+  /*!
+   * \brief cancel a timer, a call already in progress completes
+   * \param id identifier of the timer
+   * \return whether the timer was pending
+   */
+  inline bool Cancel(TimerId id) {
+    // released without the lock, the callback may own objects cancelling timers
+    std::shared_ptr<Callback> callback;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      auto it = timers_.find(id);
+      if (it == timers_.end()) return false;
+      if (it->second.slot != kRunning) {
+        slots_[it->second.slot].erase(it->second.pos);
+      }
+      callback = it->second.callback;
+      timers_.erase(it);
+    }
+    return true;
+  }
+  /*! \return number of pending timers */
+  inline size_t Size() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return timers_.size();
+  }
+  /*!
+   * \brief run the expired timers on the calling thread until Stop,
+   *  the pending timers are dropped when it returns
+   */
+  inline void Run();
+  /*! \brief make Run return, it finishes the callbacks in progress first */
+  inline void Stop() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    cond_.notify_all();
+  }
+
+ private:
+  /*! \brief slot of the timers whose callback is running */
+  static const size_t kRunning = static_cast<size_t>(-1);
+  /*! \brief a scheduled timer */
+  struct Timer {
+    /*! \brief tick at which the timer expires */
+    uint64_t deadline;
+    /*! \brief period in ticks, 0 for one-shot timers */
+    uint64_t period;
+    /*! \brief the function to call, shared with the running thread */
+    std::shared_ptr<Callback> callback;
+    /*! \brief index of the slot holding the timer, kRunning while it runs */
+    size_t slot;
+    /*! \brief position in the slot */
+    std::list<TimerId>::iterator pos;
+  };
+  /*! \brief duration of a tick */
+  Clock::duration resolution_;
+  /*! \brief time of tick 0 */
+  Clock::time_point start_;
+  /*! \brief the last processed tick */
+  uint64_t current_;
+  /*! \brief identifier of the next timer */
+  TimerId next_id_;
+  /*! \brief whether Stop was called */
+  bool stopped_;
+  /*! \brief timers of each slot of each wheel, wheel after wheel */
+  std::vector<std::list<TimerId> > slots_;
+  /*! \brief the pending timers */
+  std::unordered_map<TimerId, Timer> timers_;
+  /*! \brief protects all the fields */
+  std::mutex mutex_;
+  /*! \brief wakes up Run */
+  std::condition_variable cond_;
+  /*! \return number of ticks, rounded up, of a duration */
+  inline uint64_t ToTicks(Clock::duration duration) const {
+    if (duration <= Clock::duration::zero()) return 0;
+    return static_cast<uint64_t>((duration.count() + resolution_.count() - 1) /
+                                 resolution_.count());
+  }
+  /*! \return the tick of a time point, rounded down */
+  inline uint64_t TickOf(Clock::time_point time) const {
+    return static_cast<uint64_t>((time - start_).count() / resolution_.count());
+  }
+  /*! \brief schedule a new timer, see Schedule */
+  inline TimerId Add(Clock::duration delay, Clock::duration period, Callback callback) {
+    TimerId id;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      id = next_id_++;
+      Timer &timer = timers_[id];
+      // the deadline is counted from the current time rather than current_
+      // which lags behind while Run sleeps
+      timer.deadline = std::max(this->TickOf(Clock::now()), current_) + this->ToTicks(delay);
+      timer.period = this->ToTicks(period);
+      timer.callback = std::make_shared<Callback>(std::move(callback));
+      this->Insert(id, &timer);
+    }
+    cond_.notify_all();
+    return id;
+  }
+  /*! \brief put a timer in the slot of its deadline */
+  inline void Insert(TimerId id, Timer *timer) {
+    const uint64_t kRange = 1ULL << (kSlotBits * kNumWheels);
+    if (timer->deadline <= current_) timer->deadline = current_ + 1;
+    uint64_t target = timer->deadline;
+    // deadlines beyond the last wheel wait in its farthest slot
+    if (target - current_ >= kRange) target = current_ + kRange - 1;
+    int wheel = 0;
+    while (wheel + 1 < kNumWheels &&
+           target - current_ >= (1ULL << (kSlotBits * (wheel + 1)))) {
+      ++wheel;
+    }
+    const uint64_t mask = kNumSlots - 1;
+    timer->slot = wheel * kNumSlots + ((target >> (kSlotBits * wheel)) & mask);
+    std::list<TimerId> &slot = slots_[timer->slot];
+    timer->pos = slot.insert(slot.end(), id);
+  }
+  /*!
+   * \brief advance to the next tick, moving the timers of the coarser wheels
+   *  that become due within their finer wheel down
+   * \param due receives the timers expiring at the new tick
+   */
+  inline void Tick(std::vector<std::pair<TimerId, std::shared_ptr<Callback> > > *due) {
+    ++current_;
+    const uint64_t mask = kNumSlots - 1;
+    for (int wheel = kNumWheels - 1; wheel > 0; --wheel) {
+      if ((current_ & ((1ULL << (kSlotBits * wheel)) - 1)) != 0) continue;
+      std::list<TimerId> &slot =
+          slots_[wheel * kNumSlots + ((current_ >> (kSlotBits * wheel)) & mask)];
+      std::list<TimerId> moved;
+      moved.swap(slot);
+      for (TimerId id : moved) {
+        Timer &timer = timers_[id];
+        if (timer.deadline <= current_) {
+          timer.slot = kRunning;
+          due->push_back(std::make_pair(id, timer.callback));
+        } else {
+          this->Insert(id, &timer);
+        }
+      }
+    }
+    std::list<TimerId> &slot = slots_[current_ & mask];
+    for (TimerId id : slot) {
+      Timer &timer = timers_[id];
+      timer.slot = kRunning;
+      due->push_back(std::make_pair(id, timer.callback));
+    }
+    slot.clear();
+  }
+  /*! \return the next tick having timers due or moving timers down a wheel */
+  inline uint64_t NextEventTick() const {
+    const uint64_t mask = kNumSlots - 1;
+    const uint64_t turn = (current_ | mask) + 1;
+    for (uint64_t tick = current_ + 1; tick < turn; ++tick) {
+      if (!slots_[tick & mask].empty()) return tick;
+    }
+    return turn;
+  }
+};
+
+inline void TimerWheel::Run() {
+  std::vector<std::pair<TimerId, std::shared_ptr<Callback> > > due;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stopped_) {
+    const uint64_t now = this->TickOf(Clock::now());
+    if (timers_.empty()) {
+      current_ = std::max(current_, now);
+    } else {
+      while (current_ < now && due.empty()) this->Tick(&due);
+    }
+    if (due.empty()) {
+      if (timers_.empty()) {
+        cond_.wait(lock);
+      } else {
+        const Clock::duration::rep next = this->NextEventTick();
+        cond_.wait_until(lock, start_ + resolution_ * next);
+      }
+      continue;
+    }
+    lock.unlock();
+    for (size_t i = 0; i < due.size(); ++i) {
+      (*due[i].second)();
+    }
+    lock.lock();
+    for (size_t i = 0; i < due.size(); ++i) {
+      auto it = timers_.find(due[i].first);
+      // cancelled while running
+      if (it == timers_.end()) continue;
+      if (it->second.period != 0) {
+        it->second.deadline = std::max(this->TickOf(Clock::now()), current_) +
+            it->second.period;
+        this->Insert(it->first, &it->second);
+      } else {
+        timers_.erase(it);
+      }
+    }
+    // the callbacks are released without the lock
+    lock.unlock();
+    due.clear();
+    lock.lock();
+  }
+  std::unordered_map<TimerId, Timer> dropped;
+  dropped.swap(timers_);
+  for (size_t i = 0; i < slots_.size(); ++i) slots_[i].clear();
+  lock.unlock();
+}
+}  // namespace dmlc
+#endif  // DMLC_TIMER_WHEEL_H_
@@ -0,0 +1,166 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file trace.h
+ * \brief scoped tracing of the hot paths, exported in the Chrome trace event
+ *  format that chrome://tracing and Perfetto open.
+ *
+ *  The DMLC_TRACE_SCOPE macros compile to nothing unless DMLC_ENABLE_TRACE
+ *  is 1. When compiled in, a scope costs one atomic load while the tracer is
+ *  stopped, and two clock reads plus a lock-free append to a buffer of the
+ *  calling thread while it runs.
+ * \code
+ *   dmlc::Tracer::Get()->Start();
+ *   // ... run the pipeline ...
+ *   dmlc::Tracer::Get()->Stop();
+ *   std::ofstream os("trace.json");
+ *   dmlc::Tracer::Get()->Dump(&os);
+ * \endcode
+ */
+#ifndef DMLC_TRACE_H_
+#define DMLC_TRACE_H_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include "./base.h"
+#include "./timer.h"
+
+namespace dmlc {
+/*!
+ * \brief collects the timed scopes of all the threads.
+ *  Each thread appends its events to a buffer of its own and publishes the
+ *  new size, the buffers are only merged by Dump, so recording threads never
+ *  wait for each other or for Dump.
+ */
+class Tracer {
+ public:
+  /*! \brief maximum number of events kept per thread, later events are dropped */
+  static const size_t kMaxEventsPerThread = 1 << 20;
+  /*! \brief a completed scope */
+  struct Event {
+    /*! \brief name of the scope, must be a string of static storage duration */
+    const char *name;
+    /*! \brief category of the scope, must be a string of static storage duration */
+    const char *category;
+    /*! \brief start time in seconds, see GetMonotonicTime */
+    double begin;
+    /*! \brief end time in seconds, see GetMonotonicTime */
+    double end;
+  };
+  /*! \brief constructor, the tracer starts stopped */
+  Tracer() : recording_(false), dropped_(0), epoch_(0), origin_(0.0), next_tid_(0) {}
+  /*! \return the global tracer */
+  static Tracer *Get();
+  /*! \brief discard the recorded events and start recording */
+  void Start();
+  /*! \brief stop recording, the recorded events are kept until the next Start */
+  void Stop();
+  /*! \return whether the tracer is recording */
+  inline bool IsRecording() const {
+    return recording_.load(std::memory_order_relaxed);
+  }
+  /*!
+   * \brief record a completed scope of the calling thread
+   * \param name name of the scope, must outlive the tracer
+   * \param category category of the scope, must outlive the tracer
+   * \param begin start time in seconds
+   * \param end end time in seconds
+   */
+  void Record(const char *name, const char *category, double begin, double end);
+  /*! \return number of events recorded since the last Start */
+  size_t NumEvents();
+  /*! \return number of events dropped because a thread buffer was full */
+  size_t NumDropped() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+  /*!
+   * \brief write the recorded events as a Chrome trace event JSON object,
+   *  with one complete ("X") event per scope and one track per thread
+   * \param os the output stream
+   */
+  void Dump(std::ostream *os);
+
+ private:
+  /*! \brief number of events in each chunk of a thread buffer */
+  static const size_t kEventsPerChunk = 1 << 12;
+  /*!
+   * \brief events of one thread, written only by the owning thread.
+   *  The chunks never move, so other threads read the first size events
+   *  while the owner appends after them.
+   */
+  struct Buffer {
+    /*! \brief identifier of the thread in the trace */
+    int tid;
+    /*! \brief the events, allocated a chunk at a time */
+    std::unique_ptr<Event[]> chunks[kMaxEventsPerThread / kEventsPerChunk];
+    /*! \brief number of events, stored with release after the event is written */
+    std::atomic<size_t> size;
+    /*! \brief the run the events belong to, stale events are ignored */
+    std::atomic<uint64_t> epoch;
+    /*! \brief whether the owning thread exited */
+    std::atomic<bool> exited;
+    Buffer() : tid(0), size(0), epoch(0), exited(false) {}
+  };
+  /*! \brief whether scopes are recorded */
+  std::atomic<bool> recording_;
+  /*! \brief number of dropped events */
+  std::atomic<size_t> dropped_;
+  /*! \brief the current run, incremented by Start */
+  std::atomic<uint64_t> epoch_;
+  /*! \brief time of the last Start, the origin of the trace */
+  double origin_;
+  /*! \brief identifier of the next thread that records */
+  int next_tid_;
+  /*! \brief buffers of the threads that recorded */
+  std::vector<std::shared_ptr<Buffer> > buffers_;
+  /*! \brief protects buffers_, origin_, next_tid_ and the increments of epoch_ */
+  std::mutex mutex_;
+  /*! \return the buffer of the calling thread, registered on first use */
+  Buffer *LocalBuffer();
+  /*!
+   * \return number of events of the current run in the buffer,
+   *  the caller holds mutex_
+   */
+  size_t NumLiveEvents(const Buffer &buffer) const;
+  /*! \brief forget the buffers of the exited threads that hold no event of the current run */
+  void RetireExited();
+};
+
+/*!
+ * \brief records the lifetime of a scope into the global tracer,
+ *  use it through DMLC_TRACE_SCOPE
+ */
+class TraceScope {
+ public:
+  /*!
+   * \brief start the scope
+   * \param name name of the scope, a string literal
+   * \param category category of the scope, a string literal
+   */
+  TraceScope(const char *name, const char *category)
+      : name_(name), category_(category),
+        begin_(Tracer::Get()->IsRecording() ? GetMonotonicTime() : -1.0) {}
+  ~TraceScope() {
+    if (begin_ >= 0.0) Tracer::Get()->Record(name_, category_, begin_, GetMonotonicTime());
+  }
+
+ private:
+  const char *name_;
+  const char *category_;
+  double begin_;
+};
+}  // namespace dmlc
+
+#if DMLC_ENABLE_TRACE
+/*!
+ * \brief trace the enclosing scope under a name and a category,
+ *  both string literals
+ */
+#define DMLC_TRACE_SCOPE(name, category)                                \
+  ::dmlc::TraceScope DMLC_STR_CONCAT(__dmlc_trace_scope_, __LINE__)(name, category)
+#else
+#define DMLC_TRACE_SCOPE(name, category)
+#endif  // DMLC_ENABLE_TRACE
+#endif  // DMLC_TRACE_H_
@@ -4,15 +4,28 @@
 #include <dmlc/logging.h>
 #include <dmlc/data.h>
 #include <dmlc/registry.h>
+#include <dmlc/row_block_text_writer.h>
 #include <cstring>
+#include <map>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 #include "io/uri_spec.h"
 #include "data/parser.h"
 #include "data/basic_row_iter.h"
 #include "data/disk_row_iter.h"
+#include "data/compact_row_iter.h"
+#include "data/shared_row_iter.h"
+#include "data/batch_row_iter.h"
+#include "data/row_block_iter_param.h"
 #include "data/libsvm_parser.h"
 #include "data/libfm_parser.h"
+#include "data/hashed_libsvm_parser.h"
 #include "data/csv_parser.h"
+#include "data/arrow_parser.h"
+#include "data/row_block_recordio_parser.h"
+#include "data/lazy_text_iter.h"
 
 namespace dmlc {
 /*! \brief namespace for useful input data structure */
@@ -48,6 +61,50 @@ CreateLibFMParser(const std::string& path,
   return parser;
 }
 
+template<typename IndexType, typename DType = real_t>
+Parser<IndexType> *
+CreateHashedLibSVMParser(const std::string& path,
+                         const std::map<std::string, std::string>& args,
+                         unsigned part_index,
+                         unsigned num_parts) {
+  InputSplit* source = InputSplit::Create(
+      path.c_str(), part_index, num_parts, "text");
+  ParserImpl<IndexType> *parser = new HashedLibSVMParser<IndexType>(source, args, 2);
+#if DMLC_ENABLE_STD_THREAD
+  parser = new ThreadedParser<IndexType>(parser);
+#endif
+  return parser;
+}
+
+template<typename IndexType, typename DType = real_t>
+Parser<IndexType> *
+CreateArrowParser(const std::string& path,
+                  const std::map<std::string, std::string>& args,
+                  unsigned part_index,
+                  unsigned num_parts) {
+  ParserImpl<IndexType> *parser =
+      new ArrowParser<IndexType>(path, args, part_index, num_parts, 2);
+#if DMLC_ENABLE_STD_THREAD
+  parser = new ThreadedParser<IndexType>(parser);
+#endif
+  return parser;
+}
+
+template<typename IndexType, typename DType = real_t>
+Parser<IndexType> *
+CreateRowBlockRecordIOParser(const std::string& path,
+                             const std::map<std::string, std::string>& args,
+                             unsigned part_index,
+                             unsigned num_parts) {
+  InputSplit* source = InputSplit::Create(
+      path.c_str(), part_index, num_parts, "recordio");
+  ParserImpl<IndexType> *parser = new RowBlockRecordIOParser<IndexType>(source, 4);
+#if DMLC_ENABLE_STD_THREAD
+  parser = new ThreadedParser<IndexType>(parser);
+#endif
+  return parser;
+}
+
 template<typename IndexType, typename DType = real_t>
 Parser<IndexType, DType> *
 CreateCSVParser(const std::string& path,
@@ -61,15 +118,15 @@ CreateCSVParser(const std::string& path,
 
 template<typename IndexType, typename DType = real_t>
 inline Parser<IndexType, DType> *
-CreateParser_(const char *uri_,
+CreateParser_(const std::string &path,
+              const std::map<std::string, std::string> &args,
               unsigned part_index,
               unsigned num_parts,
               const char *type) {
   std::string ptype = type;
-  io::URISpec spec(uri_, part_index, num_parts);
   if (ptype == "auto") {
-    if (spec.args.count("format") != 0) {
-      ptype = spec.args.at("format");
+    if (args.count("format") != 0) {
+      ptype = args.at("format");
     } else {
       ptype = "libsvm";
     }
@@ -81,7 +138,18 @@ CreateParser_(const char *uri_,
     LOG(FATAL) << "Unknown data type " << ptype;
   }
   // create parser
-  return (*e->body)(spec.uri, spec.args, part_index, num_parts);
+  return (*e->body)(path, args, part_index, num_parts);
+}
+
+template<typename IndexType, typename DType = real_t>
+inline Parser<IndexType, DType> *
+CreateParser_(const char *uri_,
+              unsigned part_index,
+              unsigned num_parts,
+              const char *type) {
+  io::URISpec spec(uri_, part_index, num_parts);
+  return CreateParser_<IndexType, DType>(spec.uri, spec.args,
+                                         part_index, num_parts, type);
 }
 
 template<typename IndexType, typename DType = real_t>
@@ -92,25 +160,135 @@ CreateIter_(const char *uri_,
             const char *type) {
   using namespace std;
   io::URISpec spec(uri_, part_index, num_parts);
-  Parser<IndexType, DType> *parser = CreateParser_<IndexType, DType>
-      (spec.uri.c_str(), part_index, num_parts, type);
+  // peel off the iterator arguments, the rest goes to the parser
+  RowBlockIterParam param;
+  std::vector<std::pair<std::string, std::string> > rest =
+      param.InitAllowUnknown(spec.args);
+  std::map<std::string, std::string> parser_args(rest.begin(), rest.end());
+  RowBlockIter<IndexType, DType> *iter;
   if (spec.cache_file.length() != 0) {
 #if DMLC_ENABLE_STD_THREAD
-    return new DiskRowIter<IndexType, DType>(parser, spec.cache_file.c_str(), true);
+    // the cache is rebuilt when the parser or its arguments change
+    std::ostringstream source;
+    source << type << '?';
+    for (const auto &kv : parser_args) source << kv.first << '=' << kv.second << '&';
+    source << '#' << part_index << '/' << num_parts;
+    std::string parser_type = type;
+    DiskRowIter<IndexType, DType> *disk_iter = new DiskRowIter<IndexType, DType>(
+        spec.uri, source.str(), part_index, num_parts,
+        [parser_args, parser_type](const std::string &uri, unsigned part, unsigned nparts) {
+          return CreateParser_<IndexType, DType>(
+              uri, parser_args, part, nparts, parser_type.c_str());
+        },
+        spec.cache_file.c_str(), param.value_format, param.cache_page_bytes);
+    if (param.shuffle_pages || param.shuffle_rows) {
+      disk_iter->SetShuffle(param.shuffle_rows, param.shuffle_seed);
+    }
+    iter = disk_iter;
 #else
     LOG(FATAL) << "compile with c++0x or c++11 to enable cache file";
     return NULL;
 #endif
+  } else if (param.shuffle_pages || param.shuffle_rows) {
+    LOG(FATAL) << "shuffle_pages and shuffle_rows need a cache file, "
+               << "add #<cache_file> to the uri";
+    return NULL;
+  } else if (param.shared_file.length() != 0) {
+    CHECK(param.value_format == kValueNative && !param.compact_index)
+        << "shared_file keeps the data in native format";
+    // processes attach only to a file built from the same input and parser
+    std::ostringstream source;
+    source << spec.uri << '?';
+    for (const auto &kv : parser_args) source << kv.first << '=' << kv.second << '&';
+    source << '#' << type << ':' << part_index << '/' << num_parts;
+    std::string uri = spec.uri, parser_type = type;
+    iter = new SharedRowIter<IndexType, DType>(
+        [uri, parser_args, part_index, num_parts, parser_type]() {
+          return CreateParser_<IndexType, DType>(
+              uri, parser_args, part_index, num_parts, parser_type.c_str());
+        },
+        param.shared_file, spec.uri, source.str());
+  } else {
+    Parser<IndexType, DType> *parser = CreateParser_<IndexType, DType>
+        (spec.uri, parser_args, part_index, num_parts, type);
+    if (param.value_format != kValueNative || param.compact_index) {
+      iter = new CompactRowIter<IndexType, DType>(parser, param.value_format);
+    } else {
+      iter = new BasicRowIter<IndexType, DType>(parser);
+    }
+  }
+  if (param.HasBatchBudget()) {
+    iter = new BatchRowIter<IndexType, DType>(
+        iter, param.batch_rows, param.batch_nnz, param.batch_bytes);
+  }
+  return iter;
+}
+
+template<typename IndexType>
+inline LazyRowBlockIter<IndexType, real_t> *
+CreateLazyIter_(const char *uri_,
+                unsigned part_index,
+                unsigned num_parts,
+                const char *type) {
+  io::URISpec spec(uri_, part_index, num_parts);
+  const std::map<std::string, std::string> &args = spec.args;
+  // lines are parsed one by one, the row sampling and the detection of
+  // the indexing mode would see a single line at a time
+  CHECK(args.count("sample_rate") == 0 && args.count("label_sample_rate") == 0)
+      << "LazyRowBlockIter does not sample rows, filter them with Label instead";
+  CHECK(args.count("indexing_mode") == 0 || atoi(args.at("indexing_mode").c_str()) >= 0)
+      << "LazyRowBlockIter needs an explicit indexing_mode";
+  std::string ptype = type;
+  TextParserBase<IndexType, real_t> *parser;
+  typename LazyTextIter<IndexType, real_t>::LabelParser label_parser;
+  // the libsvm and libfm parsers drop the lines without a label
+  const bool need_number = ptype == "libsvm" || ptype == "libfm";
+  if (ptype == "libsvm" || ptype == "libfm") {
+    if (ptype == "libsvm") {
+      parser = new LibSVMParser<IndexType>(NULL, args, 1);
+    } else {
+      parser = new LibFMParser<IndexType>(NULL, args, 1);
+    }
+    label_parser = [](const char *begin, const char *end) {
+      const char *q;
+      real_t label = 0.0f, weight;
+      ParsePair<real_t, real_t>(begin, end, &q, label, weight);
+      return label;
+    };
+  } else if (ptype == "csv") {
+    parser = new CSVParser<IndexType, real_t>(NULL, args, 1);
+    CSVParserParam param;
+    param.InitAllowUnknown(args);
+    const int label_column = param.label_column;
+    const char delimiter = param.delimiter[0];
+    label_parser = [label_column, delimiter](const char *begin, const char *end) {
+      if (label_column < 0) return 0.0f;
+      const char *p = begin;
+      for (int i = 0; i < label_column && p != end; ++i) {
+        while (p != end && *p != delimiter) ++p;
+        if (p != end) ++p;
+      }
+      return p == end ? 0.0f : strtof(p, NULL);
+    };
   } else {
-    return new BasicRowIter<IndexType, DType>(parser);
+    LOG(FATAL) << "LazyRowBlockIter: unsupported format " << ptype;
+    return NULL;
   }
+  InputSplit *source = InputSplit::Create(spec.uri.c_str(), part_index, num_parts, "text");
+  return new LazyTextIter<IndexType, real_t>(source, parser, label_parser, need_number);
 }
 
 DMLC_REGISTER_PARAMETER(LibSVMParserParam);
 DMLC_REGISTER_PARAMETER(LibFMParserParam);
 DMLC_REGISTER_PARAMETER(CSVParserParam);
+DMLC_REGISTER_PARAMETER(HashedLibSVMParserParam);
+DMLC_REGISTER_PARAMETER(ArrowParserParam);
+DMLC_REGISTER_PARAMETER(RowBlockIterParam);
+DMLC_REGISTER_PARAMETER(RowSamplerParam);
 }  // namespace data
 
+DMLC_REGISTER_PARAMETER(RowBlockTextWriterParam);
+
 // template specialization
 template<>
 RowBlockIter<uint32_t, real_t> *
@@ -220,6 +398,24 @@ Parser<uint64_t, int64_t>::Create(const char *uri_,
   return data::CreateParser_<uint64_t, int64_t>(uri_, part_index, num_parts, type);
 }
 
+template<>
+LazyRowBlockIter<uint32_t, real_t> *
+LazyRowBlockIter<uint32_t, real_t>::Create(const char *uri,
+                                           unsigned part_index,
+                                           unsigned num_parts,
+                                           const char *type) {
+  return data::CreateLazyIter_<uint32_t>(uri, part_index, num_parts, type);
+}
+
+template<>
+LazyRowBlockIter<uint64_t, real_t> *
+LazyRowBlockIter<uint64_t, real_t>::Create(const char *uri,
+                                           unsigned part_index,
+                                           unsigned num_parts,
+                                           const char *type) {
+  return data::CreateLazyIter_<uint64_t>(uri, part_index, num_parts, type);
+}
+
 // registry
 typedef ParserFactoryReg<uint32_t, real_t> Reg32flt;
 typedef ParserFactoryReg<uint32_t, int32_t> Reg32int32;
@@ -242,6 +438,22 @@ DMLC_REGISTER_DATA_PARSER(
   uint32_t, real_t, libfm, data::CreateLibFMParser<uint32_t __DMLC_COMMA real_t>);
 DMLC_REGISTER_DATA_PARSER(
   uint64_t, real_t, libfm, data::CreateLibFMParser<uint64_t __DMLC_COMMA real_t>);
+DMLC_REGISTER_DATA_PARSER(
+  uint32_t, real_t, hashed_libsvm,
+  data::CreateHashedLibSVMParser<uint32_t __DMLC_COMMA real_t>);
+DMLC_REGISTER_DATA_PARSER(
+  uint64_t, real_t, hashed_libsvm,
+  data::CreateHashedLibSVMParser<uint64_t __DMLC_COMMA real_t>);
+DMLC_REGISTER_DATA_PARSER(
+  uint32_t, real_t, arrow, data::CreateArrowParser<uint32_t __DMLC_COMMA real_t>);
+DMLC_REGISTER_DATA_PARSER(
+  uint64_t, real_t, arrow, data::CreateArrowParser<uint64_t __DMLC_COMMA real_t>);
+DMLC_REGISTER_DATA_PARSER(
+  uint32_t, real_t, rowblock,
+  data::CreateRowBlockRecordIOParser<uint32_t __DMLC_COMMA real_t>);
+DMLC_REGISTER_DATA_PARSER(
+  uint64_t, real_t, rowblock,
+  data::CreateRowBlockRecordIOParser<uint64_t __DMLC_COMMA real_t>);
 DMLC_REGISTER_DATA_PARSER(
   uint32_t, real_t, csv, data::CreateCSVParser<uint32_t __DMLC_COMMA real_t>);
 DMLC_REGISTER_DATA_PARSER(
@@ -0,0 +1,578 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file arrow_parser.h
+ * \brief parser of Arrow IPC files (also known as Feather v2),
+ *  numeric columns are mapped to the features of RowBlocks
+ */
+#ifndef DMLC_DATA_ARROW_PARSER_H_
+#define DMLC_DATA_ARROW_PARSER_H_
+
+#include <dmlc/data.h>
+#include <dmlc/common.h>
+#include <dmlc/omp.h>
+#include <dmlc/parameter.h>
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+#include "./row_block.h"
+#include "./parser.h"
+#include "./compact_row_block.h"
+#include "../io/filesys.h"
+
+namespace dmlc {
+namespace data {
+
+struct ArrowParserParam : public Parameter<ArrowParserParam> {
+  std::string format;
+  int label_column;
+  int weight_column;
+  bool sparse;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(ArrowParserParam) {
+    DMLC_DECLARE_FIELD(format).set_default("arrow")
+        .describe("File format.");
+    DMLC_DECLARE_FIELD(label_column).set_default(-1)
+        .describe("Column index (0-based) in the schema that will put into label.");
+    DMLC_DECLARE_FIELD(weight_column).set_default(-1)
+        .describe("Column index (0-based) in the schema that will put into "
+                  "instance weights.");
+    DMLC_DECLARE_FIELD(sparse).set_default(false)
+        .describe("If true, zero values are dropped along with nulls, "
+                  "producing sparse rows.");
+  }
+};
+
+/*!
+ * \brief read-only view of a table inside a flatbuffer,
+ *  every access is checked against the buffer bounds
+ */
+class FlatBufferTable {
+ public:
+  FlatBufferTable(void) : buf_(NULL), size_(0), pos_(0) {}
+  FlatBufferTable(const uint8_t *buf, size_t size, size_t pos)
+      : buf_(buf), size_(size), pos_(pos) {}
+  /*! \return the root table of a flatbuffer */
+  static FlatBufferTable Root(const uint8_t *buf, size_t size) {
+    FlatBufferTable t(buf, size, 0);
+    return FlatBufferTable(buf, size, t.ReadAt<uint32_t>(0));
+  }
+  /*! \return whether field id is present */
+  inline bool Has(int id) const {
+    return this->FieldOffset(id) != 0;
+  }
+  /*! \return the scalar field id, or def if absent */
+  template<typename T>
+  inline T Get(int id, T def) const {
+    uint16_t off = this->FieldOffset(id);
+    return off == 0 ? def : this->ReadAt<T>(pos_ + off);
+  }
+  /*! \brief get the sub table field id, return false if absent */
+  inline bool GetTable(int id, FlatBufferTable *out) const {
+    size_t pos;
+    if (!this->Deref(id, &pos)) return false;
+    *out = FlatBufferTable(buf_, size_, pos);
+    return true;
+  }
+  /*!
+   * \brief get the vector field id
+   * \param out_pos position of the first element
+   * \return number of elements, 0 if absent
+   */
+  inline size_t GetVector(int id, size_t *out_pos) const {
+    size_t pos;
+    if (!this->Deref(id, &pos)) return 0;
+    *out_pos = pos + 4;
+    return this->ReadAt<uint32_t>(pos);
+  }
+  /*! \return the i-th table of a vector of tables starting at vpos */
+  inline FlatBufferTable VectorTable(size_t vpos, size_t i) const {
+    size_t pos = vpos + i * 4;
+    return FlatBufferTable(buf_, size_, pos + this->ReadAt<uint32_t>(pos));
+  }
+  /*! \return the string field id, empty if absent */
+  inline std::string GetString(int id) const {
+    size_t pos;
+    size_t len = this->GetVector(id, &pos);
+    CHECK_LE(pos + len, size_) << "corrupted flatbuffer";
+    return len == 0 ? std::string() :
+        std::string(reinterpret_cast<const char*>(buf_ + pos), len);
+  }
+  /*! \brief read a scalar at absolute position pos */
+  template<typename T>
+  inline T ReadAt(size_t pos) const {
+    CHECK(pos + sizeof(T) <= size_) << "corrupted flatbuffer";
+    T v;
+    std::memcpy(&v, buf_ + pos, sizeof(T));
+    return v;
+  }
+
+ private:
+  const uint8_t *buf_;
+  size_t size_;
+  size_t pos_;
+  // offset of field id inside the table, 0 if absent
+  inline uint16_t FieldOffset(int id) const {
+    const int64_t vtable = static_cast<int64_t>(pos_) - this->ReadAt<int32_t>(pos_);
+    CHECK(vtable >= 0) << "corrupted flatbuffer";
+    const size_t entry = 4 + 2 * static_cast<size_t>(id);
+    if (entry + 2 > this->ReadAt<uint16_t>(vtable)) return 0;
+    return this->ReadAt<uint16_t>(vtable + entry);
+  }
+  // follow the offset stored in field id
+  inline bool Deref(int id, size_t *out_pos) const {
+    uint16_t off = this->FieldOffset(id);
+    if (off == 0) return false;
+    *out_pos = pos_ + off + this->ReadAt<uint32_t>(pos_ + off);
+    return true;
+  }
+};
+
+/*!
+ * \brief Parser of Arrow IPC files.
+ *
+ *  Columns of integer, floating point and boolean type become features,
+ *  indexed by their order among such columns, other columns are skipped.
+ *  Null entries are missing values. The record batches of all input files
+ *  are divided between the parts, each part decodes its batches in parallel.
+ */
+template <typename IndexType, typename DType = real_t>
+class ArrowParser : public ParserImpl<IndexType, DType> {
+ public:
+  ArrowParser(const std::string &path,
+              const std::map<std::string, std::string> &args,
+              unsigned part_index,
+              unsigned num_parts,
+              int nthread)
+      : bytes_read_(0), fi_(NULL), fi_index_(0) {
+    param_.Init(args);
+    CHECK_EQ(param_.format, "arrow");
+    CHECK(param_.label_column != param_.weight_column
+          || param_.label_column < 0)
+        << "Must have distinct columns for labels and instance weights";
+    int maxthread = std::max(omp_get_num_procs() / 2 - 4, 1);
+    nthread_ = std::min(maxthread, nthread);
+    this->InitFiles(path);
+    CHECK_NE(files_.size(), 0U) << "no arrow file found in " << path;
+    for (size_t i = 0; i < files_.size(); ++i) {
+      this->ReadFooter(i);
+    }
+    const size_t nbatch = batches_.size();
+    batch_begin_ = nbatch * part_index / num_parts;
+    batch_end_ = nbatch * (part_index + 1) / num_parts;
+    this->BeforeFirst();
+  }
+  virtual ~ArrowParser(void) {
+    delete fi_;
+  }
+  virtual void BeforeFirst(void) {
+    next_batch_ = batch_begin_;
+  }
+  virtual size_t BytesRead(void) const {
+    return bytes_read_;
+  }
+  virtual bool ParseNext(std::vector<RowBlockContainer<IndexType, DType> > *data);
+
+ private:
+  /*! \brief kind of a column */
+  enum ColumnKind {
+    kSkip = 0, kInt = 1, kFloat = 2, kBool = 3
+  };
+  /*! \brief layout of a top level column in the record batches */
+  struct Column {
+    int kind;
+    int bit_width;
+    bool is_signed;
+    size_t num_nodes;
+    size_t num_buffers;
+    // unions take one more buffer, the validity bitmap, before metadata version V5
+    size_t num_unions;
+  };
+  /*! \brief location of a record batch */
+  struct Batch {
+    size_t file;
+    int64_t offset;
+    int32_t meta_length;
+    int64_t body_length;
+  };
+  /*! \brief a record batch read into memory */
+  struct BatchData {
+    std::vector<uint8_t> meta;
+    std::vector<uint8_t> body;
+  };
+  ArrowParserParam param_;
+  int nthread_;
+  size_t bytes_read_;
+  std::vector<io::FileInfo> files_;
+  std::vector<Column> columns_;
+  std::vector<Batch> batches_;
+  size_t batch_begin_, batch_end_, next_batch_;
+  // stream of the file fi_index_
+  SeekStream *fi_;
+  size_t fi_index_;
+  std::vector<BatchData> buffer_;
+  // list the input files
+  inline void InitFiles(const std::string &path);
+  // open file i
+  inline SeekStream *OpenFile(size_t i) {
+    if (fi_ == NULL || fi_index_ != i) {
+      delete fi_;
+      fi_ = io::FileSystem::GetInstance(files_[i].path)->OpenForRead(files_[i].path);
+      fi_index_ = i;
+    }
+    return fi_;
+  }
+  // read the footer of file i, record its schema and batches
+  inline void ReadFooter(size_t i);
+  // parse the schema into the column layout
+  inline void ParseSchema(const FlatBufferTable &schema,
+                          std::vector<Column> *out) const;
+  // count nodes and buffers used by a field and its children
+  inline void CountLayout(const FlatBufferTable &field, Column *col) const;
+  // decode a record batch
+  inline void DecodeBatch(const BatchData &batch,
+                          RowBlockContainer<IndexType, DType> *out) const;
+  // decode a numeric column into values and validity
+  inline void DecodeColumn(const Column &col, size_t length,
+                           const FlatBufferTable &msg, size_t node, size_t buf,
+                           const std::vector<uint8_t> &body,
+                           std::vector<DType> *values,
+                           std::vector<uint8_t> *valid) const;
+};
+
+template <typename IndexType, typename DType>
+inline void ArrowParser<IndexType, DType>::InitFiles(const std::string &path) {
+  std::vector<std::string> paths = Split(path, ';');
+  for (size_t i = 0; i < paths.size(); ++i) {
+    io::URI uri(paths[i].c_str());
+    io::FileSystem *fs = io::FileSystem::GetInstance(uri);
+    io::FileInfo info = fs->GetPathInfo(uri);
+    if (info.type == io::kDirectory) {
+      std::vector<io::FileInfo> list;
+      fs->ListDirectory(info.path, &list);
+      for (size_t j = 0; j < list.size(); ++j) {
+        if (list[j].type == io::kFile && list[j].size != 0) files_.push_back(list[j]);
+      }
+    } else {
+      files_.push_back(info);
+    }
+  }
+}
+
+template <typename IndexType, typename DType>
+inline void ArrowParser<IndexType, DType>::ReadFooter(size_t i) {
+  const size_t kMagicSize = 6;
+  const size_t size = files_[i].size;
+  CHECK_GE(size, 2 * kMagicSize + 6) << files_[i].path.str() << " is not an arrow file";
+  SeekStream *fi = this->OpenFile(i);
+  char magic[kMagicSize];
+  CHECK_EQ(fi->Read(magic, kMagicSize), kMagicSize);
+  CHECK(std::memcmp(magic, "ARROW1", kMagicSize) == 0)
+      << files_[i].path.str() << " is not an arrow file";
+  int32_t footer_length;
+  fi->Seek(size - kMagicSize - 4);
+  CHECK_EQ(fi->Read(&footer_length, 4), 4U);
+  CHECK(footer_length > 0 && static_cast<size_t>(footer_length) + kMagicSize * 2 + 4 <= size)
+      << "corrupted arrow file " << files_[i].path.str();
+  std::vector<uint8_t> footer(footer_length);
+  fi->Seek(size - kMagicSize - 4 - footer_length);
+  CHECK_EQ(fi->Read(BeginPtr(footer), footer.size()), footer.size());
+  FlatBufferTable root = FlatBufferTable::Root(BeginPtr(footer), footer.size());
+  FlatBufferTable schema;
+  CHECK(root.GetTable(1, &schema)) << "arrow file without schema";
+  CHECK_EQ(schema.Get<int16_t>(0, 0), 0) << "only little endian arrow files are supported";
+  std::vector<Column> columns;
+  this->ParseSchema(schema, &columns);
+  if (i == 0) {
+    columns_ = columns;
+  } else {
+    CHECK_EQ(columns.size(), columns_.size())
+        << "arrow files with different schema";
+    for (size_t c = 0; c < columns.size(); ++c) {
+      CHECK(columns[c].kind == columns_[c].kind &&
+            columns[c].bit_width == columns_[c].bit_width)
+          << "arrow files with different schema";
+    }
+  }
+  // record batches, vector of Block structs of 24 bytes
+  size_t vpos = 0;
+  size_t nblock = root.GetVector(3, &vpos);
+  for (size_t b = 0; b < nblock; ++b) {
+    const size_t pos = vpos + b * 24;
+    Batch batch;
+    batch.file = i;
+    batch.offset = root.ReadAt<int64_t>(pos);
+    batch.meta_length = root.ReadAt<int32_t>(pos + 8);
+    batch.body_length = root.ReadAt<int64_t>(pos + 16);
+    CHECK(batch.offset >= 0 && batch.meta_length >= 8 && batch.body_length >= 0 &&
+          static_cast<size_t>(batch.offset + batch.meta_length + batch.body_length) <= size)
+        << "corrupted arrow file " << files_[i].path.str();
+    batches_.push_back(batch);
+  }
+}
+
+template <typename IndexType, typename DType>
+inline void ArrowParser<IndexType, DType>::
+ParseSchema(const FlatBufferTable &schema, std::vector<Column> *out) const {
+  size_t vpos = 0;
+  size_t nfield = schema.GetVector(1, &vpos);
+  out->resize(nfield);
+  for (size_t i = 0; i < nfield; ++i) {
+    FlatBufferTable field = schema.VectorTable(vpos, i);
+    Column &col = (*out)[i];
+    col.kind = kSkip;
+    col.bit_width = 0;
+    col.is_signed = false;
+    col.num_nodes = 0;
+    col.num_buffers = 0;
+    col.num_unions = 0;
+    this->CountLayout(field, &col);
+    FlatBufferTable type;
+    if (field.Has(4) || !field.GetTable(3, &type)) continue;
+    switch (field.Get<uint8_t>(2, 0)) {
+      case 2: {
+        // Int
+        col.kind = kInt;
+        col.bit_width = type.Get<int32_t>(0, 0);
+        col.is_signed = type.Get<uint8_t>(1, 0) != 0;
+        CHECK(col.bit_width == 8 || col.bit_width == 16 ||
+              col.bit_width == 32 || col.bit_width == 64)
+            << "invalid integer width " << col.bit_width;
+        break;
+      }
+      case 3: {
+        // FloatingPoint, precision HALF, SINGLE or DOUBLE
+        col.kind = kFloat;
+        col.bit_width = 16 << type.Get<int16_t>(0, 0);
+        CHECK(col.bit_width == 16 || col.bit_width == 32 || col.bit_width == 64)
+            << "invalid floating point precision";
+        break;
+      }
+      case 6: {
+        // Bool
+        col.kind = kBool;
+        col.bit_width = 1;
+        break;
+      }
+      default: break;
+    }
+    if (static_cast<int>(i) == param_.label_column ||
+        static_cast<int>(i) == param_.weight_column) {
+      CHECK_NE(col.kind, kSkip) << "label and weight columns must be numeric";
+    }
+  }
+}
+
+template <typename IndexType, typename DType>
+inline void ArrowParser<IndexType, DType>::
+CountLayout(const FlatBufferTable &field, Column *col) const {
+  col->num_nodes += 1;
+  if (field.Has(4)) {
+    // dictionary encoded, the batch only holds the validity and the indices,
+    // the values are in the dictionary batches
+    col->num_buffers += 2;
+    return;
+  }
+  const int type_id = field.Get<uint8_t>(2, 0);
+  switch (type_id) {
+    case 1:  // Null
+      break;
+    case 13:  // Struct
+    case 16:  // FixedSizeList
+      col->num_buffers += 1; break;
+    case 4:  // Binary
+    case 5:  // Utf8
+    case 19:  // LargeBinary
+    case 20:  // LargeUtf8
+      col->num_buffers += 3; break;
+    case 2: case 3: case 6: case 7: case 8: case 9: case 10: case 11:
+    case 12:  // List
+    case 15: case 17: case 18:
+    case 21:  // LargeList
+      col->num_buffers += 2; break;
+    case 14: {
+      // Union, type ids then offsets if dense
+      FlatBufferTable type;
+      const bool dense = field.GetTable(3, &type) && type.Get<int16_t>(0, 0) == 1;
+      col->num_buffers += dense ? 2 : 1;
+      col->num_unions += 1;
+      break;
+    }
+    default:
+      LOG(FATAL) << "unsupported arrow type " << type_id;
+  }
+  size_t vpos = 0;
+  size_t nchild = field.GetVector(5, &vpos);
+  for (size_t i = 0; i < nchild; ++i) {
+    this->CountLayout(field.VectorTable(vpos, i), col);
+  }
+}
+
+template <typename IndexType, typename DType>
+inline bool ArrowParser<IndexType, DType>::
+ParseNext(std::vector<RowBlockContainer<IndexType, DType> > *data) {
+  if (next_batch_ == batch_end_) return false;
+  const size_t n = std::min(static_cast<size_t>(nthread_), batch_end_ - next_batch_);
+  buffer_.resize(n);
+  for (size_t k = 0; k < n; ++k) {
+    const Batch &batch = batches_[next_batch_ + k];
+    SeekStream *fi = this->OpenFile(batch.file);
+    fi->Seek(batch.offset);
+    buffer_[k].meta.resize(batch.meta_length);
+    buffer_[k].body.resize(batch.body_length);
+    CHECK_EQ(fi->Read(BeginPtr(buffer_[k].meta), batch.meta_length),
+             static_cast<size_t>(batch.meta_length)) << "unexpected end of arrow file";
+    CHECK_EQ(fi->Read(BeginPtr(buffer_[k].body), batch.body_length),
+             static_cast<size_t>(batch.body_length)) << "unexpected end of arrow file";
+    bytes_read_ += batch.meta_length + batch.body_length;
+  }
+  next_batch_ += n;
+  data->resize(n);
+  OMPException omp_exc;
+  #pragma omp parallel for num_threads(nthread_) schedule(static, 1)
+  for (omp_ulong k = 0; k < static_cast<omp_ulong>(n); ++k) {
+    omp_exc.Run([&] {
+      this->DecodeBatch(buffer_[k], &(*data)[k]);
+    });
+  }
+  omp_exc.Rethrow();
+  return true;
+}
+
+template <typename IndexType, typename DType>
+inline void ArrowParser<IndexType, DType>::
+DecodeBatch(const BatchData &batch, RowBlockContainer<IndexType, DType> *out) const {
+  out->Clear();
+  // the encapsulated message starts with an optional continuation marker
+  CHECK_GE(batch.meta.size(), 8U) << "corrupted arrow record batch";
+  uint32_t marker;
+  std::memcpy(&marker, BeginPtr(batch.meta), 4);
+  const size_t start = marker == 0xFFFFFFFFU ? 8 : 4;
+  FlatBufferTable msg = FlatBufferTable::Root(BeginPtr(batch.meta) + start,
+                                              batch.meta.size() - start);
+  CHECK_EQ(msg.Get<uint8_t>(1, 0), 3U) << "expect a record batch message";
+  // metadata version V5 is 4
+  const bool union_validity = msg.Get<int16_t>(0, 0) < 4;
+  FlatBufferTable rb;
+  CHECK(msg.GetTable(2, &rb)) << "corrupted arrow record batch";
+  CHECK(!rb.Has(3)) << "compressed arrow record batches are not supported";
+  const int64_t length = rb.Get<int64_t>(0, 0);
+  CHECK_GE(length, 0) << "corrupted arrow record batch";
+  const size_t nrow = static_cast<size_t>(length);
+  // decode the columns
+  std::vector<std::vector<DType> > values(columns_.size());
+  std::vector<std::vector<uint8_t> > valid(columns_.size());
+  size_t node = 0, buf = 0;
+  for (size_t c = 0; c < columns_.size(); ++c) {
+    if (columns_[c].kind != kSkip) {
+      this->DecodeColumn(columns_[c], nrow, rb, node, buf, batch.body,
+                         &values[c], &valid[c]);
+    }
+    node += columns_[c].num_nodes;
+    buf += columns_[c].num_buffers + (union_validity ? columns_[c].num_unions : 0);
+  }
+  // assemble the rows
+  const bool has_weight = param_.weight_column >= 0 &&
+      param_.weight_column < static_cast<int>(columns_.size());
+  for (size_t i = 0; i < nrow; ++i) {
+    DType label = DType(0);
+    IndexType idx = 0;
+    for (size_t c = 0; c < columns_.size(); ++c) {
+      if (columns_[c].kind == kSkip) continue;
+      const int ci = static_cast<int>(c);
+      const bool is_valid = valid[c].size() == 0 || valid[c][i] != 0;
+      if (ci == param_.label_column) {
+        if (is_valid) label = values[c][i];
+      } else if (ci == param_.weight_column) {
+        out->weight.push_back(is_valid ? static_cast<real_t>(values[c][i]) : 1.0f);
+      } else {
+        if (is_valid && !(param_.sparse && values[c][i] == DType(0))) {
+          out->index.push_back(idx);
+          out->value.push_back(values[c][i]);
+          out->max_index = std::max(out->max_index, idx);
+        }
+        ++idx;
+      }
+    }
+    out->label.push_back(label);
+    out->offset.push_back(out->index.size());
+  }
+  CHECK(!has_weight || out->weight.size() == out->label.size());
+}
+
+template <typename IndexType, typename DType>
+inline void ArrowParser<IndexType, DType>::
+DecodeColumn(const Column &col, size_t length,
+             const FlatBufferTable &rb, size_t node, size_t buf,
+             const std::vector<uint8_t> &body,
+             std::vector<DType> *values,
+             std::vector<uint8_t> *valid) const {
+  size_t npos = 0, bpos = 0;
+  const size_t nnode = rb.GetVector(1, &npos);
+  const size_t nbuf = rb.GetVector(2, &bpos);
+  CHECK(node < nnode && buf + 1 < nbuf) << "corrupted arrow record batch";
+  // FieldNode is {length, null_count}, Buffer is {offset, length}
+  const int64_t null_count = rb.ReadAt<int64_t>(npos + node * 16 + 8);
+  const int64_t valid_offset = rb.ReadAt<int64_t>(bpos + buf * 16);
+  const int64_t valid_length = rb.ReadAt<int64_t>(bpos + buf * 16 + 8);
+  const int64_t data_offset = rb.ReadAt<int64_t>(bpos + (buf + 1) * 16);
+  const int64_t data_length = rb.ReadAt<int64_t>(bpos + (buf + 1) * 16 + 8);
+  CHECK(data_offset >= 0 && data_offset + data_length <= static_cast<int64_t>(body.size()) &&
+        static_cast<size_t>(data_length) * 8 >= length * col.bit_width)
+      << "corrupted arrow record batch";
+  const uint8_t *data = BeginPtr(body) + data_offset;
+  valid->clear();
+  if (null_count != 0 && valid_length != 0) {
+    CHECK(valid_offset >= 0 && valid_offset + valid_length <= static_cast<int64_t>(body.size()) &&
+          static_cast<size_t>(valid_length) * 8 >= length)
+        << "corrupted arrow record batch";
+    const uint8_t *bitmap = BeginPtr(body) + valid_offset;
+    valid->resize(length);
+    for (size_t i = 0; i < length; ++i) {
+      (*valid)[i] = (bitmap[i >> 3] >> (i & 7)) & 1;
+    }
+  }
+  values->resize(length);
+  DType *dst = BeginPtr(*values);
+  switch (col.kind * 100 + col.bit_width + (col.is_signed ? 1000 : 0)) {
+#define DMLC_ARROW_CONVERT(KEY, T)                                  \
+    case KEY: {                                                     \
+      for (size_t i = 0; i < length; ++i) {                         \
+        T v;                                                        \
+        std::memcpy(&v, data + i * sizeof(T), sizeof(T));           \
+        dst[i] = static_cast<DType>(v);                             \
+      }                                                             \
+      break;                                                        \
+    }
+    DMLC_ARROW_CONVERT(kInt * 100 + 8, uint8_t)
+    DMLC_ARROW_CONVERT(kInt * 100 + 16, uint16_t)
+    DMLC_ARROW_CONVERT(kInt * 100 + 32, uint32_t)
+    DMLC_ARROW_CONVERT(kInt * 100 + 64, uint64_t)
+    DMLC_ARROW_CONVERT(1000 + kInt * 100 + 8, int8_t)
+    DMLC_ARROW_CONVERT(1000 + kInt * 100 + 16, int16_t)
+    DMLC_ARROW_CONVERT(1000 + kInt * 100 + 32, int32_t)
+    DMLC_ARROW_CONVERT(1000 + kInt * 100 + 64, int64_t)
+    DMLC_ARROW_CONVERT(kFloat * 100 + 32, float)
+    DMLC_ARROW_CONVERT(kFloat * 100 + 64, double)
+#undef DMLC_ARROW_CONVERT
+    case kFloat * 100 + 16: {
+      for (size_t i = 0; i < length; ++i) {
+        uint16_t h;
+        std::memcpy(&h, data + i * 2, 2);
+        dst[i] = static_cast<DType>(HalfToFloat(h));
+      }
+      break;
+    }
+    case kBool * 100 + 1: {
+      for (size_t i = 0; i < length; ++i) {
+        dst[i] = static_cast<DType>((data[i >> 3] >> (i & 7)) & 1);
+      }
+      break;
+    }
+    default: LOG(FATAL) << "unsupported arrow column type";
+  }
+}
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_ARROW_PARSER_H_
@@ -46,6 +46,9 @@ class BasicRowIter: public RowBlockIter<IndexType, DType> {
   virtual size_t NumCol(void) const {
     return static_cast<size_t>(data_.max_index) + 1;
   }
+  virtual const DatasetStats *Stats(void) const {
+    return &stats_;
+  }
 
  private:
   // at head
@@ -54,6 +57,8 @@ class BasicRowIter: public RowBlockIter<IndexType, DType> {
   RowBlock<IndexType, DType> row_;
   // back end data
   RowBlockContainer<IndexType, DType> data_;
+  // statistics of the data
+  DatasetStats stats_;
   // initialize
   inline void Init(Parser<IndexType, DType> *parser);
 };
@@ -65,6 +70,7 @@ inline void BasicRowIter<IndexType, DType>::Init(Parser<IndexType, DType> *parse
   size_t bytes_expect = 10UL << 20UL;
   while (parser->Next()) {
     data_.Push(parser->Value());
+    stats_.Add(parser->Value());
     double tdiff = GetTime() - tstart;
     size_t bytes_read  = parser->BytesRead();
     if (bytes_read >= bytes_expect) {
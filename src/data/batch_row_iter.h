@@ -0,0 +1,166 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file batch_row_iter.h
+ * \brief row iterator that re-batches the blocks of another
+ *  iterator so that each batch fits in a row, nnz and byte budget
+ */
+#ifndef DMLC_DATA_BATCH_ROW_ITER_H_
+#define DMLC_DATA_BATCH_ROW_ITER_H_
+
+#include <dmlc/data.h>
+#include <dmlc/logging.h>
+#include <algorithm>
+#include <limits>
+#include "./row_block.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief iterator that yields batches bounded by number of rows,
+ *  number of non-zeros and memory cost.
+ *
+ *  A batch that lies inside a single block of the base iterator is
+ *  returned as a slice of that block without copying, only batches that
+ *  span block boundaries are assembled in a staging container.
+ *  A single row that exceeds the budget on its own forms its own batch.
+ *
+ * \tparam IndexType the type of index we are using
+ */
+template<typename IndexType, typename DType = real_t>
+class BatchRowIter : public RowBlockIter<IndexType, DType> {
+ public:
+  /*!
+   * \brief constructor
+   * \param base the base iterator, can be a Parser or RowBlockIter,
+   *  ownership is taken
+   * \param max_rows maximum number of rows per batch, 0 means unlimited
+   * \param max_nnz maximum number of non-zeros per batch, 0 means unlimited
+   * \param max_bytes maximum memory cost per batch, 0 means unlimited
+   */
+  BatchRowIter(DataIter<RowBlock<IndexType, DType> > *base,
+               size_t max_rows, size_t max_nnz, size_t max_bytes)
+      : base_(base), base_iter_(dynamic_cast<RowBlockIter<IndexType, DType>*>(base)),
+        max_rows_(max_rows), max_nnz_(max_nnz), max_bytes_(max_bytes),
+        num_col_(0) {
+    this->BeforeFirst();
+  }
+  virtual ~BatchRowIter(void) {
+    delete base_;
+  }
+  virtual void BeforeFirst(void) {
+    base_->BeforeFirst();
+    src_.size = 0;
+    src_pos_ = 0;
+  }
+  virtual bool Next(void);
+  virtual const RowBlock<IndexType, DType> &Value(void) const {
+    return out_;
+  }
+  virtual size_t NumCol(void) const {
+    if (base_iter_ != NULL) return base_iter_->NumCol();
+    return num_col_;
+  }
+  virtual const DatasetStats *Stats(void) const {
+    return base_iter_ != NULL ? base_iter_->Stats() : NULL;
+  }
+  virtual RowBlockPageReader<IndexType, DType> *
+  CreatePageReader(size_t memory_budget) const {
+    return base_iter_ != NULL ? base_iter_->CreatePageReader(memory_budget) : NULL;
+  }
+
+ private:
+  /*! \brief the base iterator */
+  DataIter<RowBlock<IndexType, DType> > *base_;
+  /*! \brief base_ as RowBlockIter, NULL if it is not one */
+  RowBlockIter<IndexType, DType> *base_iter_;
+  /*! \brief budgets */
+  size_t max_rows_, max_nnz_, max_bytes_;
+  /*! \brief number of columns seen, used when base is not a RowBlockIter */
+  size_t num_col_;
+  /*! \brief current block of the base iterator */
+  RowBlock<IndexType, DType> src_;
+  /*! \brief number of rows of src_ already consumed */
+  size_t src_pos_;
+  /*! \brief staging area for batches that span several blocks */
+  RowBlockContainer<IndexType, DType> stage_;
+  /*! \brief the output batch */
+  RowBlock<IndexType, DType> out_;
+  /*!
+   * \brief count how many rows starting at src_pos_ can be added
+   *  to a batch that already holds rows, nnz and bytes
+   */
+  inline size_t CountRows(size_t rows, size_t nnz, size_t bytes) const;
+  /*! \brief update num_col_ from the rows of a batch */
+  inline void UpdateNumCol(const RowBlock<IndexType, DType> &batch) {
+    if (base_iter_ != NULL) return;
+    for (size_t i = batch.offset[0]; i < batch.offset[batch.size]; ++i) {
+      num_col_ = std::max(num_col_, static_cast<size_t>(batch.index[i]) + 1);
+    }
+  }
+};
+
+template<typename IndexType, typename DType>
+inline size_t BatchRowIter<IndexType, DType>::
+CountRows(size_t rows, size_t nnz, size_t bytes) const {
+  const size_t kUnlimited = std::numeric_limits<size_t>::max();
+  const size_t max_rows = max_rows_ == 0 ? kUnlimited : max_rows_;
+  const size_t max_nnz = max_nnz_ == 0 ? kUnlimited : max_nnz_;
+  const size_t max_bytes = max_bytes_ == 0 ? kUnlimited : max_bytes_;
+  // per row and per entry memory cost, following RowBlock::MemCostBytes
+  size_t row_bytes = sizeof(size_t) + sizeof(DType);
+  if (src_.weight != NULL) row_bytes += sizeof(real_t);
+  if (src_.qid != NULL) row_bytes += sizeof(uint64_t);
+  size_t entry_bytes = sizeof(IndexType);
+  if (src_.field != NULL) entry_bytes += sizeof(IndexType);
+  if (src_.value != NULL) entry_bytes += sizeof(DType);
+  size_t i = src_pos_;
+  for (; i < src_.size && rows < max_rows; ++i) {
+    const size_t len = src_.offset[i + 1] - src_.offset[i];
+    const size_t cost = row_bytes + len * entry_bytes;
+    if (nnz + len > max_nnz || bytes + cost > max_bytes) break;
+    rows += 1; nnz += len; bytes += cost;
+  }
+  return i - src_pos_;
+}
+
+template<typename IndexType, typename DType>
+inline bool BatchRowIter<IndexType, DType>::Next(void) {
+  stage_.Clear();
+  size_t nnz = 0, bytes = 0;
+  while (true) {
+    if (src_pos_ == src_.size) {
+      if (!base_->Next()) break;
+      src_ = base_->Value();
+      src_pos_ = 0;
+      continue;
+    }
+    size_t n = this->CountRows(stage_.Size(), nnz, bytes);
+    if (n == 0) {
+      // batch is full, or a single row exceeds the budget
+      if (stage_.Size() != 0) break;
+      n = 1;
+    }
+    const size_t rest = src_.size - src_pos_;
+    if (stage_.Size() == 0 && n < rest) {
+      // the whole batch lies inside the current block
+      out_ = src_.Slice(src_pos_, src_pos_ + n);
+      src_pos_ += n;
+      this->UpdateNumCol(out_);
+      return true;
+    }
+    // copy the rows out, since the block is invalidated by the base iterator
+    RowBlock<IndexType, DType> part = src_.Slice(src_pos_, src_pos_ + n);
+    stage_.Push(part);
+    nnz += part.offset[n] - part.offset[0];
+    bytes = stage_.MemCostBytes();
+    src_pos_ += n;
+    if (n < rest) break;
+  }
+  if (stage_.Size() == 0) return false;
+  out_ = stage_.GetBlock();
+  this->UpdateNumCol(out_);
+  return true;
+}
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_BATCH_ROW_ITER_H_
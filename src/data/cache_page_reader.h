@@ -0,0 +1,196 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file cache_page_reader.h
+ * \brief random access reader over the pages of a disk row iterator cache
+ */
+#ifndef DMLC_DATA_CACHE_PAGE_READER_H_
+#define DMLC_DATA_CACHE_PAGE_READER_H_
+
+#include <dmlc/base.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/data.h>
+
+#if DMLC_ENABLE_STD_THREAD
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./row_block.h"
+#include "./compact_row_block.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief random access reader over the pages of a cache file.
+ *  Pages are read with a seek to their recorded offset on a stream of its own,
+ *  decoded, and kept in a least recently used cache of bounded memory cost.
+ *  Prefetch hints are served by a background thread started on first use.
+ * \tparam IndexType the type of index we are using
+ */
+template<typename IndexType, typename DType = real_t>
+class CachePageReader : public RowBlockPageReader<IndexType, DType> {
+ public:
+  typedef typename RowBlockPageReader<IndexType, DType>::PagePtr PagePtr;
+  /*!
+   * \brief constructor
+   * \param cache_file the cache file
+   * \param page_begin offset of each page in the cache file
+   * \param memory_budget number of bytes of decoded pages to keep in memory
+   */
+  CachePageReader(const std::string &cache_file,
+                  const std::vector<uint64_t> &page_begin,
+                  size_t memory_budget)
+      : cache_file_(cache_file), page_begin_(page_begin),
+        memory_budget_(memory_budget), memory_bytes_(0),
+        fi_(SeekStream::CreateForRead(cache_file.c_str())),
+        num_hits_(0), num_misses_(0), stop_(false) {}
+  virtual ~CachePageReader(void) {
+    if (prefetcher_.joinable()) {
+      {
+        std::lock_guard<std::mutex> lock(prefetch_mutex_);
+        stop_ = true;
+      }
+      prefetch_cond_.notify_one();
+      prefetcher_.join();
+    }
+  }
+  virtual size_t NumPages(void) const {
+    return page_begin_.size();
+  }
+  virtual PagePtr GetPage(size_t index) {
+    CHECK_LT(index, page_begin_.size()) << "page index out of range";
+    PagePtr page = this->Lookup(index);
+    if (page != nullptr) {
+      ++num_hits_;
+      return page;
+    }
+    ++num_misses_;
+    return this->Load(index);
+  }
+  virtual void Prefetch(const std::vector<size_t> &pages) {
+    {
+      std::lock_guard<std::mutex> lock(prefetch_mutex_);
+      for (size_t index : pages) {
+        CHECK_LT(index, page_begin_.size()) << "page index out of range";
+        prefetch_queue_.push_back(index);
+      }
+      if (!prefetcher_.joinable()) {
+        prefetcher_ = std::thread([this]() { this->RunPrefetcher(); });
+      }
+    }
+    prefetch_cond_.notify_one();
+  }
+  virtual size_t NumHits(void) const {
+    return num_hits_;
+  }
+  virtual size_t NumMisses(void) const {
+    return num_misses_;
+  }
+
+ private:
+  /*! \brief a decoded page */
+  struct Page {
+    RowBlockContainer<IndexType, DType> data;
+    RowBlock<IndexType, DType> block;
+  };
+  /*! \brief a cached page and its position in the recency list */
+  typedef std::pair<std::shared_ptr<Page>, typename std::list<size_t>::iterator> Entry;
+  /*! \brief the cache file */
+  std::string cache_file_;
+  /*! \brief offset of each page in the cache file */
+  std::vector<uint64_t> page_begin_;
+  /*! \brief maximum memory cost of the cached pages */
+  size_t memory_budget_;
+  /*! \brief memory cost of the cached pages */
+  size_t memory_bytes_;
+  /*! \brief the cached pages */
+  std::unordered_map<size_t, Entry> pages_;
+  /*! \brief cached page indices, most recently used first */
+  std::list<size_t> recency_;
+  /*! \brief protects pages_, recency_ and memory_bytes_ */
+  std::mutex cache_mutex_;
+  /*! \brief stream over the cache file */
+  std::unique_ptr<SeekStream> fi_;
+  /*! \brief encoded page buffer */
+  CompactRowBlock<IndexType, DType> encoded_;
+  /*! \brief protects fi_ and encoded_, held while a page is read and cached */
+  std::mutex io_mutex_;
+  /*! \brief statistics of GetPage */
+  std::atomic<size_t> num_hits_, num_misses_;
+  /*! \brief pages to prefetch */
+  std::deque<size_t> prefetch_queue_;
+  /*! \brief whether the prefetcher should exit */
+  bool stop_;
+  /*! \brief protects prefetch_queue_ and stop_ */
+  std::mutex prefetch_mutex_;
+  /*! \brief signals the prefetcher */
+  std::condition_variable prefetch_cond_;
+  /*! \brief the prefetcher thread */
+  std::thread prefetcher_;
+  /*! \return the cached page, marked as most recently used, nullptr if it is not cached */
+  inline PagePtr Lookup(size_t index) {
+    std::lock_guard<std::mutex> lock(cache_mutex_);
+    auto it = pages_.find(index);
+    if (it == pages_.end()) return PagePtr();
+    recency_.splice(recency_.begin(), recency_, it->second.second);
+    return PagePtr(it->second.first, &it->second.first->block);
+  }
+  /*! \brief read, decode and cache a page */
+  inline PagePtr Load(size_t index);
+  /*! \brief body of the prefetcher thread */
+  inline void RunPrefetcher(void);
+};
+
+template<typename IndexType, typename DType>
+inline typename CachePageReader<IndexType, DType>::PagePtr
+CachePageReader<IndexType, DType>::Load(size_t index) {
+  // pages are read one at a time, so a page is never cached twice
+  std::lock_guard<std::mutex> io_lock(io_mutex_);
+  // another thread may have read the page while this one waited
+  PagePtr cached = this->Lookup(index);
+  if (cached != nullptr) return cached;
+  std::shared_ptr<Page> page = std::make_shared<Page>();
+  fi_->Seek(page_begin_[index]);
+  CHECK(encoded_.Load(fi_.get())) << "invalid cache file " << cache_file_;
+  encoded_.Decode(&page->data);
+  page->block = page->data.GetBlock();
+  std::lock_guard<std::mutex> lock(cache_mutex_);
+  recency_.push_front(index);
+  pages_[index] = Entry(page, recency_.begin());
+  memory_bytes_ += page->data.MemCostBytes();
+  // evict the least recently used pages, keeping at least the new one
+  while (memory_bytes_ > memory_budget_ && recency_.size() > 1) {
+    auto it = pages_.find(recency_.back());
+    memory_bytes_ -= it->second.first->data.MemCostBytes();
+    pages_.erase(it);
+    recency_.pop_back();
+  }
+  return PagePtr(page, &page->block);
+}
+
+template<typename IndexType, typename DType>
+inline void CachePageReader<IndexType, DType>::RunPrefetcher(void) {
+  while (true) {
+    size_t index;
+    {
+      std::unique_lock<std::mutex> lock(prefetch_mutex_);
+      prefetch_cond_.wait(lock, [this]() { return stop_ || !prefetch_queue_.empty(); });
+      if (stop_) return;
+      index = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+    }
+    if (this->Lookup(index) == nullptr) this->Load(index);
+  }
+}
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_ENABLE_STD_THREAD
+#endif  // DMLC_DATA_CACHE_PAGE_READER_H_
@@ -0,0 +1,488 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file compact_row_block.h
+ * \brief compact storage of row blocks with reduced precision values
+ *  and narrow indices, used by the in-memory and disk cached row iterators
+ */
+#ifndef DMLC_DATA_COMPACT_ROW_BLOCK_H_
+#define DMLC_DATA_COMPACT_ROW_BLOCK_H_
+
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/data.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "./row_block.h"
+
+#if defined(__F16C__) && defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace dmlc {
+namespace data {
+/*! \brief storage format of the feature values in a compact page */
+enum ValueFormat {
+  /*! \brief values are stored as DType */
+  kValueNative = 0,
+  /*! \brief IEEE half precision */
+  kValueFloat16 = 1,
+  /*! \brief upper 16 bits of IEEE single precision */
+  kValueBFloat16 = 2,
+  /*! \brief 8-bit linear quantization with per page offset and scale */
+  kValueUInt8 = 3
+};
+
+/*! \return number of bytes used by each value in format */
+inline size_t ValueFormatBytes(int format, size_t native_bytes) {
+  switch (format) {
+    case kValueFloat16: return 2;
+    case kValueBFloat16: return 2;
+    case kValueUInt8: return 1;
+    default: return native_bytes;
+  }
+}
+
+/*! \brief convert float to half precision, rounding to nearest even */
+inline uint16_t FloatToHalf(float f) {
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  const uint32_t sign = (x >> 16) & 0x8000U;
+  const uint32_t absx = x & 0x7fffffffU;
+  if (absx >= 0x7f800000U) {
+    // inf or nan, keep nan quiet
+    return static_cast<uint16_t>(sign | 0x7c00U | (absx > 0x7f800000U ? 0x200U : 0U));
+  }
+  if (absx >= 0x477ff000U) {
+    // overflow after rounding
+    return static_cast<uint16_t>(sign | 0x7c00U);
+  }
+  if (absx < 0x38800000U) {
+    // subnormal or zero in half precision
+    if (absx < 0x33000000U) return static_cast<uint16_t>(sign);
+    const uint32_t shift = 126U - (absx >> 23);
+    const uint32_t mant = (absx & 0x7fffffU) | 0x800000U;
+    uint32_t h = mant >> shift;
+    const uint32_t rem = mant & ((1U << shift) - 1U);
+    const uint32_t half = 1U << (shift - 1U);
+    if (rem > half || (rem == half && (h & 1U))) ++h;
+    return static_cast<uint16_t>(sign | h);
+  }
+  uint32_t h = ((absx >> 13) - (112U << 10));
+  const uint32_t rem = absx & 0x1fffU;
+  if (rem > 0x1000U || (rem == 0x1000U && (h & 1U))) ++h;
+  return static_cast<uint16_t>(sign | h);
+}
+
+/*! \brief convert half precision to float */
+inline float HalfToFloat(uint16_t h) {
+  const uint32_t sign = static_cast<uint32_t>(h & 0x8000U) << 16;
+  uint32_t exp = (h >> 10) & 0x1fU;
+  uint32_t mant = h & 0x3ffU;
+  uint32_t x;
+  if (exp == 0x1fU) {
+    x = sign | 0x7f800000U | (mant << 13);
+  } else if (exp != 0) {
+    x = sign | ((exp + 112U) << 23) | (mant << 13);
+  } else if (mant == 0) {
+    x = sign;
+  } else {
+    // normalize subnormal
+    exp = 113U;
+    while ((mant & 0x400U) == 0) {
+      mant <<= 1; --exp;
+    }
+    x = sign | (exp << 23) | ((mant & 0x3ffU) << 13);
+  }
+  float f;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+/*! \brief convert float to bfloat16, rounding to nearest even */
+inline uint16_t FloatToBFloat16(float f) {
+  uint32_t x;
+  std::memcpy(&x, &f, sizeof(x));
+  if ((x & 0x7fffffffU) > 0x7f800000U) {
+    return static_cast<uint16_t>((x >> 16) | 0x40U);
+  }
+  x += 0x7fffU + ((x >> 16) & 1U);
+  return static_cast<uint16_t>(x >> 16);
+}
+
+/*! \brief convert bfloat16 to float */
+inline float BFloat16ToFloat(uint16_t h) {
+  uint32_t x = static_cast<uint32_t>(h) << 16;
+  float f;
+  std::memcpy(&f, &x, sizeof(f));
+  return f;
+}
+
+/*! \brief decode n half precision values */
+template<typename DType>
+inline void DecodeFloat16(const uint16_t *src, size_t n, DType *dst) {
+  size_t i = 0;
+#if defined(__F16C__) && defined(__AVX__)
+  if (std::is_same<DType, float>::value) {
+    for (; i + 8 <= n; i += 8) {
+      __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      _mm256_storeu_ps(reinterpret_cast<float*>(dst + i), _mm256_cvtph_ps(h));
+    }
+  }
+#endif
+  for (; i < n; ++i) {
+    dst[i] = static_cast<DType>(HalfToFloat(src[i]));
+  }
+}
+
+/*!
+ * \brief array of unsigned integers stored as offsets from a base
+ *  value with the narrowest width (1, 2, 4 or 8 bytes) that fits
+ */
+struct NarrowIntArray {
+  /*! \brief the value subtracted from every element */
+  uint64_t base;
+  /*! \brief number of bytes of each element */
+  uint32_t width;
+  /*! \brief the encoded elements */
+  std::vector<uint8_t> data;
+  NarrowIntArray(void) : base(0), width(1) {}
+  /*! \return number of elements */
+  inline size_t Size(void) const {
+    return data.size() / width;
+  }
+  /*!
+   * \brief encode n elements
+   * \param src the elements
+   * \param n number of elements
+   * \param use_base whether to subtract the minimum element
+   */
+  template<typename T>
+  inline void Encode(const T *src, size_t n, bool use_base) {
+    base = 0;
+    uint64_t vmax = 0;
+    if (n != 0) {
+      uint64_t vmin = static_cast<uint64_t>(src[0]);
+      for (size_t i = 0; i < n; ++i) {
+        vmin = std::min(vmin, static_cast<uint64_t>(src[i]));
+        vmax = std::max(vmax, static_cast<uint64_t>(src[i]));
+      }
+      if (use_base) base = vmin;
+    }
+    const uint64_t range = vmax - base;
+    if (range <= 0xffU) {
+      this->EncodeAs<uint8_t>(src, n);
+    } else if (range <= 0xffffU) {
+      this->EncodeAs<uint16_t>(src, n);
+    } else if (range <= 0xffffffffU) {
+      this->EncodeAs<uint32_t>(src, n);
+    } else {
+      this->EncodeAs<uint64_t>(src, n);
+    }
+  }
+  /*!
+   * \brief decode all elements
+   * \param dst the output, must have Size() elements
+   */
+  template<typename T>
+  inline void Decode(T *dst) const {
+    switch (width) {
+      case 1: this->DecodeAs<uint8_t>(dst); break;
+      case 2: this->DecodeAs<uint16_t>(dst); break;
+      case 4: this->DecodeAs<uint32_t>(dst); break;
+      case 8: this->DecodeAs<uint64_t>(dst); break;
+      default: LOG(FATAL) << "invalid integer width " << width;
+    }
+  }
+  /*! \brief write to a binary stream */
+  inline void Save(Stream *fo) const {
+    fo->Write(base);
+    fo->Write(width);
+    fo->Write(data);
+  }
+  /*! \brief load from a binary stream */
+  inline bool Load(Stream *fi) {
+    if (!fi->Read(&base)) return false;
+    if (!fi->Read(&width)) return false;
+    return fi->Read(&data);
+  }
+
+ private:
+  template<typename W, typename T>
+  inline void EncodeAs(const T *src, size_t n) {
+    width = sizeof(W);
+    data.resize(n * sizeof(W));
+    W *dst = reinterpret_cast<W*>(BeginPtr(data));
+    for (size_t i = 0; i < n; ++i) {
+      dst[i] = static_cast<W>(static_cast<uint64_t>(src[i]) - base);
+    }
+  }
+  template<typename W, typename T>
+  inline void DecodeAs(T *dst) const {
+    const W *src = reinterpret_cast<const W*>(BeginPtr(data));
+    const size_t n = data.size() / sizeof(W);
+    const T b = static_cast<T>(base);
+    for (size_t i = 0; i < n; ++i) {
+      dst[i] = b + static_cast<T>(src[i]);
+    }
+  }
+};
+
+/*!
+ * \brief row block page whose feature values are stored
+ *  in a reduced precision format, and whose offsets, field and
+ *  feature indices use the narrowest integer width that fits the page
+ * \tparam IndexType the type of index we are using
+ */
+template<typename IndexType, typename DType = real_t>
+struct CompactRowBlock {
+  /*! \brief array[size+1], row pointer to beginning of each rows */
+  NarrowIntArray offset;
+  /*! \brief array[size] label of each instance */
+  std::vector<DType> label;
+  /*! \brief array[size] weight of each instance */
+  std::vector<real_t> weight;
+  /*! \brief array[size] session-id of each instance */
+  std::vector<uint64_t> qid;
+  /*! \brief field index */
+  NarrowIntArray field;
+  /*! \brief feature index */
+  NarrowIntArray index;
+  /*! \brief encoded feature values, empty if the page has no values */
+  std::vector<uint8_t> value;
+  /*! \brief storage format of value, see ValueFormat */
+  int value_format;
+  /*! \brief offset of quantized values */
+  float value_min;
+  /*! \brief scale of quantized values */
+  float value_scale;
+  /*! \brief maximum value of field */
+  IndexType max_field;
+  /*! \brief maximum value of index */
+  IndexType max_index;
+  // constructor
+  CompactRowBlock(void)
+      : value_format(kValueNative), value_min(0.0f), value_scale(1.0f),
+        max_field(0), max_index(0) {}
+  /*! \brief number of rows in the page */
+  inline size_t Size(void) const {
+    return label.size();
+  }
+  /*! \return estimation of memory cost of this page */
+  inline size_t MemCostBytes(void) const {
+    return offset.data.size() +
+        label.size() * sizeof(DType) +
+        weight.size() * sizeof(real_t) +
+        qid.size() * sizeof(uint64_t) +
+        field.data.size() +
+        index.data.size() +
+        value.size();
+  }
+  /*!
+   * \brief encode a row block into the page
+   * \param batch the rows to encode, can be a slice
+   * \param format the value format to use
+   */
+  inline void Encode(const RowBlock<IndexType, DType> &batch, int format);
+  /*!
+   * \brief encode a container into the page
+   * \param data the rows to encode
+   * \param format the value format to use
+   */
+  inline void Encode(const RowBlockContainer<IndexType, DType> &data, int format) {
+    this->Encode(data.GetBlock(), format);
+    max_field = data.max_field;
+    max_index = data.max_index;
+  }
+  /*!
+   * \brief decode the page into a container, reusing its memory
+   * \param out the output container
+   */
+  inline void Decode(RowBlockContainer<IndexType, DType> *out) const;
+  /*!
+   * \brief write the page to a binary stream
+   * \param fo output stream
+   */
+  inline void Save(Stream *fo) const;
+  /*!
+   * \brief load the page from a binary stream
+   * \param fi input stream
+   * \return false if at end of file
+   */
+  inline bool Load(Stream *fi);
+};
+
+template<typename IndexType, typename DType>
+inline void CompactRowBlock<IndexType, DType>::
+Encode(const RowBlock<IndexType, DType> &batch, int format) {
+  CHECK(format == kValueNative || std::is_floating_point<DType>::value ||
+        format == kValueUInt8)
+      << "half precision value formats require floating point values";
+  value_format = format;
+  const size_t base = batch.offset[0];
+  const size_t nnz = batch.offset[batch.size] - base;
+  std::vector<size_t> rptr(batch.offset, batch.offset + batch.size + 1);
+  for (size_t i = 0; i <= batch.size; ++i) {
+    rptr[i] -= base;
+  }
+  offset.Encode(BeginPtr(rptr), rptr.size(), false);
+  label.assign(batch.label, batch.label + batch.size);
+  weight.clear(); qid.clear();
+  if (batch.weight != NULL) {
+    weight.assign(batch.weight, batch.weight + batch.size);
+  }
+  if (batch.qid != NULL) {
+    qid.assign(batch.qid, batch.qid + batch.size);
+  }
+  max_field = 0; max_index = 0;
+  field.Encode(batch.field, 0, true);
+  if (batch.field != NULL) {
+    field.Encode(batch.field + base, nnz, true);
+    for (size_t i = 0; i < nnz; ++i) {
+      max_field = std::max(max_field, batch.field[base + i]);
+    }
+  }
+  index.Encode(batch.index + base, nnz, true);
+  for (size_t i = 0; i < nnz; ++i) {
+    max_index = std::max(max_index, batch.index[base + i]);
+  }
+  value.clear();
+  value_min = 0.0f; value_scale = 1.0f;
+  if (batch.value == NULL) return;
+  const DType *src = batch.value + base;
+  value.resize(nnz * ValueFormatBytes(format, sizeof(DType)));
+  switch (format) {
+    case kValueNative: {
+      if (nnz != 0) std::memcpy(BeginPtr(value), src, nnz * sizeof(DType));
+      break;
+    }
+    case kValueFloat16: {
+      uint16_t *dst = reinterpret_cast<uint16_t*>(BeginPtr(value));
+      for (size_t i = 0; i < nnz; ++i) {
+        dst[i] = FloatToHalf(static_cast<float>(src[i]));
+      }
+      break;
+    }
+    case kValueBFloat16: {
+      uint16_t *dst = reinterpret_cast<uint16_t*>(BeginPtr(value));
+      for (size_t i = 0; i < nnz; ++i) {
+        dst[i] = FloatToBFloat16(static_cast<float>(src[i]));
+      }
+      break;
+    }
+    case kValueUInt8: {
+      if (nnz == 0) break;
+      float vmin = static_cast<float>(src[0]), vmax = vmin;
+      bool integral = true;
+      for (size_t i = 0; i < nnz; ++i) {
+        const float v = static_cast<float>(src[i]);
+        vmin = std::min(vmin, v);
+        vmax = std::max(vmax, v);
+        integral = integral && std::floor(v) == v;
+      }
+      // integer values spanning at most 256 levels are stored exactly
+      value_min = vmin;
+      if (integral && vmax - vmin <= 255.0f) {
+        value_scale = 1.0f;
+      } else {
+        value_scale = vmax > vmin ? (vmax - vmin) / 255.0f : 1.0f;
+      }
+      const float inv_scale = 1.0f / value_scale;
+      uint8_t *dst = BeginPtr(value);
+      for (size_t i = 0; i < nnz; ++i) {
+        const float q = (static_cast<float>(src[i]) - vmin) * inv_scale + 0.5f;
+        dst[i] = static_cast<uint8_t>(std::min(255.0f, std::max(0.0f, q)));
+      }
+      break;
+    }
+    default: LOG(FATAL) << "unknown value format " << format;
+  }
+}
+
+template<typename IndexType, typename DType>
+inline void CompactRowBlock<IndexType, DType>::
+Decode(RowBlockContainer<IndexType, DType> *out) const {
+  out->offset.resize(offset.Size());
+  offset.Decode(BeginPtr(out->offset));
+  out->label = label;
+  out->weight = weight;
+  out->qid = qid;
+  out->field.resize(field.Size());
+  field.Decode(BeginPtr(out->field));
+  out->index.resize(index.Size());
+  index.Decode(BeginPtr(out->index));
+  out->max_field = max_field;
+  out->max_index = max_index;
+  const size_t nnz = out->index.size();
+  if (value.size() == 0) {
+    out->value.clear();
+    return;
+  }
+  out->value.resize(nnz);
+  DType *dst = BeginPtr(out->value);
+  switch (value_format) {
+    case kValueNative: {
+      std::memcpy(dst, BeginPtr(value), nnz * sizeof(DType));
+      break;
+    }
+    case kValueFloat16: {
+      DecodeFloat16(reinterpret_cast<const uint16_t*>(BeginPtr(value)), nnz, dst);
+      break;
+    }
+    case kValueBFloat16: {
+      const uint16_t *src = reinterpret_cast<const uint16_t*>(BeginPtr(value));
+      for (size_t i = 0; i < nnz; ++i) {
+        dst[i] = static_cast<DType>(BFloat16ToFloat(src[i]));
+      }
+      break;
+    }
+    case kValueUInt8: {
+      const uint8_t *src = BeginPtr(value);
+      const float vmin = value_min, scale = value_scale;
+      for (size_t i = 0; i < nnz; ++i) {
+        dst[i] = static_cast<DType>(vmin + static_cast<float>(src[i]) * scale);
+      }
+      break;
+    }
+    default: LOG(FATAL) << "unknown value format " << value_format;
+  }
+}
+
+template<typename IndexType, typename DType>
+inline void CompactRowBlock<IndexType, DType>::Save(Stream *fo) const {
+  offset.Save(fo);
+  fo->Write(label);
+  fo->Write(weight);
+  fo->Write(qid);
+  field.Save(fo);
+  index.Save(fo);
+  fo->Write(value_format);
+  fo->Write(value_min);
+  fo->Write(value_scale);
+  fo->Write(value);
+  fo->Write(&max_field, sizeof(IndexType));
+  fo->Write(&max_index, sizeof(IndexType));
+}
+
+template<typename IndexType, typename DType>
+inline bool CompactRowBlock<IndexType, DType>::Load(Stream *fi) {
+  if (!offset.Load(fi)) return false;
+  CHECK(fi->Read(&label)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&weight)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&qid)) << "Bad CompactRowBlock format";
+  CHECK(field.Load(fi)) << "Bad CompactRowBlock format";
+  CHECK(index.Load(fi)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&value_format)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&value_min)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&value_scale)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&value)) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&max_field, sizeof(IndexType))) << "Bad CompactRowBlock format";
+  CHECK(fi->Read(&max_index, sizeof(IndexType))) << "Bad CompactRowBlock format";
+  return true;
+}
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_COMPACT_ROW_BLOCK_H_
@@ -0,0 +1,114 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file compact_row_iter.h
+ * \brief in-memory row iterator that keeps the data
+ *   in compact pages and decodes one page at a time
+ */
+#ifndef DMLC_DATA_COMPACT_ROW_ITER_H_
+#define DMLC_DATA_COMPACT_ROW_ITER_H_
+
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/data.h>
+#include <dmlc/timer.h>
+#include <algorithm>
+#include <vector>
+#include "./row_block.h"
+#include "./compact_row_block.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief in-memory row iterator storing values in a reduced precision
+ *  format and indices in the narrowest width that fits each page,
+ *  the pages are decoded into a reusable buffer on Next
+ * \tparam IndexType the type of index we are using
+ */
+template<typename IndexType, typename DType = real_t>
+class CompactRowIter: public RowBlockIter<IndexType, DType> {
+ public:
+  // decoded page size 8MB
+  static const size_t kPageSize = 8UL << 20UL;
+  /*!
+   * \brief constructor
+   * \param parser parser used to generate the data, ownership is taken
+   * \param value_format storage format of the values, see ValueFormat
+   */
+  CompactRowIter(Parser<IndexType, DType> *parser, int value_format)
+      : value_format_(value_format), num_col_(0), page_pos_(0) {
+    this->Init(parser);
+    delete parser;
+  }
+  virtual ~CompactRowIter() {}
+  virtual void BeforeFirst(void) {
+    page_pos_ = 0;
+  }
+  virtual bool Next(void) {
+    if (page_pos_ == pages_.size()) return false;
+    pages_[page_pos_++].Decode(&data_);
+    row_ = data_.GetBlock();
+    return true;
+  }
+  virtual const RowBlock<IndexType, DType> &Value(void) const {
+    return row_;
+  }
+  virtual size_t NumCol(void) const {
+    return num_col_;
+  }
+  virtual const DatasetStats *Stats(void) const {
+    return &stats_;
+  }
+  /*! \return memory cost of the compact pages */
+  inline size_t MemCostBytes(void) const {
+    size_t cost = 0;
+    for (size_t i = 0; i < pages_.size(); ++i) {
+      cost += pages_[i].MemCostBytes();
+    }
+    return cost;
+  }
+
+ private:
+  // storage format of values
+  int value_format_;
+  // maximum feature dimension
+  size_t num_col_;
+  // statistics of the data
+  DatasetStats stats_;
+  // the compact pages
+  std::vector<CompactRowBlock<IndexType, DType> > pages_;
+  // next page to decode
+  size_t page_pos_;
+  // decoded page
+  RowBlockContainer<IndexType, DType> data_;
+  // row block to return
+  RowBlock<IndexType, DType> row_;
+  // add the data accumulated in data_ as a page
+  inline void AddPage(void) {
+    num_col_ = std::max(num_col_, static_cast<size_t>(data_.max_index) + 1);
+    pages_.resize(pages_.size() + 1);
+    pages_.back().Encode(data_, value_format_);
+    data_.Clear();
+  }
+  // initialize
+  inline void Init(Parser<IndexType, DType> *parser);
+};
+
+template<typename IndexType, typename DType>
+inline void CompactRowIter<IndexType, DType>::Init(Parser<IndexType, DType> *parser) {
+  data_.Clear();
+  double tstart = GetTime();
+  while (parser->Next()) {
+    data_.Push(parser->Value());
+    stats_.Add(parser->Value());
+    if (data_.MemCostBytes() >= kPageSize) this->AddPage();
+  }
+  if (data_.Size() != 0) this->AddPage();
+  double tdiff = GetTime() - tstart;
+  LOG(INFO) << "finish reading at "
+            << (parser->BytesRead() >> 20UL) / tdiff
+            << " MB/sec, " << (this->MemCostBytes() >> 20UL)
+            << "MB in compact pages";
+}
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_COMPACT_ROW_ITER_H_
@@ -16,6 +16,7 @@
 #include <string>
 #include <limits>
 #include "./row_block.h"
+#include "./row_sampler.h"
 #include "./text_parser.h"
 
 namespace dmlc {
@@ -55,7 +56,7 @@ class CSVParser : public TextParserBase<IndexType, DType> {
                      const std::map<std::string, std::string>& args,
                      int nthread)
       : TextParserBase<IndexType, DType>(source, nthread) {
-    param_.Init(args);
+    param_.Init(sampler_.Init(args));
     CHECK_EQ(param_.format, "csv");
     CHECK(param_.label_column != param_.weight_column
           || param_.label_column < 0)
@@ -69,6 +70,17 @@ class CSVParser : public TextParserBase<IndexType, DType> {
 
  private:
   CSVParserParam param_;
+  RowSampler sampler_;
+  /*! \brief parse only the label column of a line, 0 if there is none */
+  inline real_t ParseLabelOnly(const char *lbegin, const char *lend) const {
+    if (param_.label_column < 0) return 0.0f;
+    const char *p = lbegin;
+    for (int i = 0; i < param_.label_column && p != lend; ++i) {
+      while (p != lend && *p != param_.delimiter[0]) ++p;
+      if (p != lend) ++p;
+    }
+    return p == lend ? 0.0f : static_cast<real_t>(strtod(p, NULL));
+  }
 };
 
 template <typename IndexType, typename DType>
@@ -86,6 +98,13 @@ ParseBlock(const char *begin,
     this->IgnoreUTF8BOM(&lbegin, &end);
     lend = lbegin + 1;
     while (lend != end && *lend != '\n' && *lend != '\r') ++lend;
+    if (sampler_.enabled() && !sampler_.Accept(this->ParseLabelOnly(lbegin, lend),
+                                               this->LinePosition(lbegin, lend))) {
+      // rejected lines are not parsed further
+      while (lend != end && (*lend == '\n' || *lend == '\r')) ++lend;
+      lbegin = lend;
+      continue;
+    }
 
     const char* p = lbegin;
     int column_index = 0;
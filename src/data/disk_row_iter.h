@@ -13,45 +13,125 @@
 #include <dmlc/data.h>
 #include <dmlc/timer.h>
 #include <dmlc/threadediter.h>
+#include <dmlc/memory_io.h>
 #include <algorithm>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <random>
 #include <string>
+#include <vector>
 #include "./row_block.h"
+#include "./compact_row_block.h"
 #include "./libsvm_parser.h"
+#include "./cache_page_reader.h"
+#include "../io/cache_manifest.h"
+#include "../io/filesys.h"
+#include "../io/input_split_base.h"
 
 #if DMLC_ENABLE_STD_THREAD
 namespace dmlc {
 namespace data {
 /*!
  * \brief basic set of row iterators that provides
+ *  caching of the parsed data on disk.
+ *  The cache comes with a manifest in <cache>.meta recording what built it,
+ *  the input files with their size, modification time and etag, the pages
+ *  holding the rows of each file and the dataset statistics.
+ *  A stale cache is detected and, when it is local and not partitioned,
+ *  updated by parsing only the new or changed files.
+ *  The manifest file also keeps the offset of each page, so that the pages
+ *  can be visited in a different random order in each pass.
  * \tparam IndexType the type of index we are using
  */
 template<typename IndexType, typename DType = real_t>
 class DiskRowIter: public RowBlockIter<IndexType, DType> {
  public:
+  /*! \brief factory creating a parser over uri for a partition */
+  typedef std::function<Parser<IndexType, DType> *(
+      const std::string &uri, unsigned part_index, unsigned num_parts)> ParserFactory;
   // page size 64MB
   static const size_t kPageSize = 64UL << 20UL;
+  // magic number at the head of the cache file
+  static const uint32_t kCacheMagic = 0xced7a3c1;
+  // version of the cache file format
+  static const uint32_t kCacheVersion = 5;
   /*!
    * \brief disk row iterator constructor
    * \param parser parser used to generate this
-
+   * \param cache_file the cache file
+   * \param reuse_cache whether to reuse an existing cache file
+   * \param value_format storage format of values in the cache, see ValueFormat
+   * \param page_bytes memory cost of the decoded pages when building the cache
    */
   explicit DiskRowIter(Parser<IndexType, DType> *parser,
                        const char *cache_file,
-                       bool reuse_cache)
-      : cache_file_(cache_file), fi_(NULL) {
-    if (reuse_cache) {
-      if (!TryLoadCache()) {
-        this->BuildCache(parser);
-        CHECK(TryLoadCache())
-            << "failed to build cache file " << cache_file;
-      }
-    } else {
-      this->BuildCache(parser);
-      CHECK(TryLoadCache())
-          << "failed to build cache file " << cache_file;
+                       bool reuse_cache,
+                       int value_format = kValueNative,
+                       size_t page_bytes = kPageSize)
+      : cache_file_(cache_file), fi_(NULL), value_format_(value_format),
+        page_bytes_(page_bytes) {
+    if (!reuse_cache || !this->LoadManifest() || !manifest_.source.empty()) {
+      this->BuildCache(parser, cache_file_);
     }
+    CHECK(this->OpenCache()) << "failed to build cache file " << cache_file;
     delete parser;
   }
+  /*!
+   * \brief disk row iterator constructor that keeps the cache in sync
+   *  with the input files, only new or changed files are parsed
+   *  when the input is not partitioned and the cache file is local
+   * \param uri the input files
+   * \param source description of the parser and its arguments,
+   *  the cache is rebuilt when it changes
+   * \param part_index the part id of current input
+   * \param num_parts total number of splits
+   * \param factory creates the parsers, over single files when updating the cache
+   * \param cache_file the cache file
+   * \param value_format storage format of values in the cache, see ValueFormat
+   * \param page_bytes memory cost of the decoded pages when building the cache
+   */
+  DiskRowIter(const std::string &uri,
+              const std::string &source,
+              unsigned part_index,
+              unsigned num_parts,
+              const ParserFactory &factory,
+              const char *cache_file,
+              int value_format = kValueNative,
+              size_t page_bytes = kPageSize)
+      : cache_file_(cache_file), fi_(NULL), value_format_(value_format),
+        page_bytes_(page_bytes) {
+    std::vector<io::FileInfo> files;
+    io::InputSplitBase::ListInputFiles(
+        io::FileSystem::GetInstance(io::URI(uri.c_str())), uri, false, &files);
+    CHECK_NE(files.size(), 0U)
+        << "Cannot find any files that matches the URI pattern " << uri;
+    const bool loaded = this->LoadManifest() && manifest_.source == source;
+    if (!loaded || !manifest_.SameFiles(files)) {
+      if (loaded) {
+        LOG(INFO) << "input of cache file " << cache_file_ << " changed, updating";
+      }
+      // the cache is appended to and renamed in place, which only local files support
+      const io::URI cache_uri(cache_file_.c_str());
+      const bool local = cache_uri.protocol.length() == 0 || cache_uri.protocol == "file://";
+      if (num_parts != 1 || !local) {
+        // partition boundaries move with the files, so the whole part is parsed again
+        std::unique_ptr<Parser<IndexType, DType> > parser(factory(uri, part_index, num_parts));
+        this->BuildCache(parser.get(), cache_file_);
+        for (size_t i = 0; i < files.size(); ++i) {
+          manifest_.files.push_back(io::CacheManifestEntry(files[i]));
+        }
+        manifest_.source = source;
+        this->SaveManifest();
+      } else if (loaded && manifest_.NumUnchanged(files) == manifest_.files.size()) {
+        this->AppendFiles(files, factory);
+      } else {
+        this->RebuildFiles(files, factory, loaded, source);
+      }
+    }
+    CHECK(this->OpenCache()) << "failed to build cache file " << cache_file;
+  }
   virtual ~DiskRowIter(void) {
     iter_.Destroy();
     delete fi_;
@@ -73,71 +153,390 @@ class DiskRowIter: public RowBlockIter<IndexType, DType> {
   virtual size_t NumCol(void) const {
     return num_col_;
   }
+  virtual const DatasetStats *Stats(void) const {
+    return &stats_;
+  }
+  virtual RowBlockPageReader<IndexType, DType> *
+  CreatePageReader(size_t memory_budget) const {
+    return new CachePageReader<IndexType, DType>(cache_file_, page_begin_, memory_budget);
+  }
+  /*! \return number of pages in the cache */
+  inline size_t NumPages(void) const {
+    return page_begin_.size();
+  }
+  /*!
+   * \brief visit the pages in a random order that changes in each pass,
+   *  the loader thread keeps prefetching the next pages in that order.
+   *  Iteration restarts from the beginning.
+   * \param shuffle_rows whether to also permute the rows within each page
+   * \param seed random seed, pass i uses an order derived from seed and i
+   */
+  inline void SetShuffle(bool shuffle_rows, uint64_t seed) {
+    shuffle_.pages = true;
+    shuffle_.rows = shuffle_rows;
+    shuffle_.seed = seed;
+    iter_.BeforeFirst();
+  }
 
  private:
+  /*! \brief how the loader thread orders the pages and rows */
+  struct ShuffleConfig {
+    bool pages;
+    bool rows;
+    uint64_t seed;
+    ShuffleConfig() : pages(false), rows(false), seed(0) {}
+  };
+  /*! \brief a cache file being written */
+  struct CacheOutput {
+    std::unique_ptr<Stream> fo;
+    uint64_t num_page;
+    uint64_t num_byte;
+    std::vector<uint64_t> page_begin;
+  };
   // file place
   std::string cache_file_;
   // input stream
   SeekStream *fi_;
+  // storage format of values in the cache
+  int value_format_;
+  // memory cost of the decoded pages when building the cache
+  size_t page_bytes_;
+  // offset of each page in the cache file
+  std::vector<uint64_t> page_begin_;
+  // shuffling requested by SetShuffle, picked up by the loader on BeforeFirst
+  ShuffleConfig shuffle_;
+  // shuffling used by the loader thread in the current pass
+  ShuffleConfig loader_shuffle_;
+  // number of passes started by the loader thread
+  uint64_t loader_pass_;
+  // order in which the loader visits the pages in the current pass
+  std::vector<size_t> page_order_;
+  // next position in page_order_
+  size_t page_pos_;
+  // random engine of the loader for the rows
+  std::mt19937_64 loader_rng_;
+  // decoded page before its rows are permuted
+  RowBlockContainer<IndexType, DType> shuffle_buf_;
   // maximum feature dimension
   size_t num_col_;
+  // manifest of the cache
+  io::CacheManifest manifest_;
+  // statistics of the data, kept in the manifest file next to the cache
+  DatasetStats stats_;
   // row block to store
   RowBlock<IndexType, DType> row_;
+  // page buffer of the loader thread
+  CompactRowBlock<IndexType, DType> page_;
   // iterator
   ThreadedIter<RowBlockContainer<IndexType, DType> > iter_;
-  // load disk cache file
-  inline bool TryLoadCache(void);
-  // build disk cache
-  inline void BuildCache(Parser<IndexType, DType> *parser);
+  // open the cache file for reading, the manifest must be loaded
+  inline bool OpenCache(void);
+  // load the manifest of the cache, return false if it is missing or stale
+  inline bool LoadManifest(void);
+  // save the manifest of the cache
+  inline void SaveManifest(void);
+  // write the cache file header
+  inline void WriteHeader(Stream *fo) const;
+  // check the cache file header, return false if the cache cannot be used
+  inline bool CheckHeader(Stream *fi) const;
+  // start writing a cache file
+  inline void CreateCache(const std::string &path, CacheOutput *out);
+  // encode and write a page
+  inline void WritePage(const RowBlockContainer<IndexType, DType> &data, CacheOutput *out);
+  // write an encoded page
+  inline void WritePage(const CompactRowBlock<IndexType, DType> &page, CacheOutput *out);
+  // load the next page in the loader thread
+  inline bool LoadPage(SeekStream *fi, RowBlockContainer<IndexType, DType> *out);
+  // start a pass in the loader thread
+  inline void StartPass(SeekStream *fi, size_t data_begin);
+  // parse all the rows of parser into pages
+  inline void ParsePages(Parser<IndexType, DType> *parser, CacheOutput *out);
+  // build disk cache from a parser, the manifest has no file
+  inline void BuildCache(Parser<IndexType, DType> *parser, const std::string &path);
+  // parse the files that are not in the manifest and append them to the cache
+  inline void AppendFiles(const std::vector<io::FileInfo> &files,
+                          const ParserFactory &factory);
+  // rebuild the cache, copying the pages of the unchanged files if loaded
+  inline void RebuildFiles(const std::vector<io::FileInfo> &files,
+                           const ParserFactory &factory,
+                           bool loaded, const std::string &source);
+  // size of the cache file
+  inline size_t CacheFileSize(void) const {
+    io::URI path(cache_file_.c_str());
+    return io::FileSystem::GetInstance(path)->GetPathInfo(path).size;
+  }
+  // path of the manifest file
+  inline std::string ManifestFile(void) const {
+    return cache_file_ + ".meta";
+  }
 };
 
-// build disk cache
 template<typename IndexType, typename DType>
-inline bool DiskRowIter<IndexType, DType>::TryLoadCache(void) {
+inline bool DiskRowIter<IndexType, DType>::OpenCache(void) {
   SeekStream *fi = SeekStream::CreateForRead(cache_file_.c_str(), true);
   if (fi == NULL) return false;
+  if (!this->CheckHeader(fi)) {
+    delete fi;
+    return false;
+  }
+  num_col_ = static_cast<size_t>(stats_.num_col);
+  const size_t data_begin = fi->Tell();
   this->fi_ = fi;
-  iter_.Init([fi](RowBlockContainer<IndexType, DType> **dptr) {
+  loader_pass_ = 0;
+  iter_.Init([this, fi](RowBlockContainer<IndexType, DType> **dptr) {
       if (*dptr ==NULL) {
         *dptr = new RowBlockContainer<IndexType, DType>();
       }
-      return (*dptr)->Load(fi);
+      return this->LoadPage(fi, *dptr);
     },
-    [fi]() { fi->Seek(0); });
+    [this, fi, data_begin]() { this->StartPass(fi, data_begin); });
   return true;
 }
 
+template<typename IndexType, typename DType>
+inline bool DiskRowIter<IndexType, DType>::
+LoadPage(SeekStream *fi, RowBlockContainer<IndexType, DType> *out) {
+  if (loader_shuffle_.pages) {
+    if (page_pos_ == page_order_.size()) return false;
+    fi->Seek(page_begin_[page_order_[page_pos_++]]);
+  }
+  if (!page_.Load(fi)) return false;
+  if (!loader_shuffle_.rows) {
+    page_.Decode(out);
+    return true;
+  }
+  page_.Decode(&shuffle_buf_);
+  RowBlock<IndexType, DType> block = shuffle_buf_.GetBlock();
+  std::vector<size_t> perm(block.size);
+  std::iota(perm.begin(), perm.end(), 0);
+  std::shuffle(perm.begin(), perm.end(), loader_rng_);
+  out->Clear();
+  for (size_t i = 0; i < perm.size(); ++i) {
+    out->Push(block[perm[i]]);
+  }
+  return true;
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::StartPass(SeekStream *fi, size_t data_begin) {
+  fi->Seek(data_begin);
+  loader_shuffle_ = shuffle_;
+  if (!loader_shuffle_.pages) return;
+  // each pass uses its own order, reproducible from the seed
+  const uint64_t seed = loader_shuffle_.seed;
+  std::seed_seq seq{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32UL),
+                    static_cast<uint32_t>(loader_pass_++)};
+  loader_rng_.seed(seq);
+  page_order_.resize(page_begin_.size());
+  std::iota(page_order_.begin(), page_order_.end(), 0);
+  std::shuffle(page_order_.begin(), page_order_.end(), loader_rng_);
+  page_pos_ = 0;
+}
+
+template<typename IndexType, typename DType>
+inline bool DiskRowIter<IndexType, DType>::LoadManifest(void) {
+  std::unique_ptr<Stream> fcache(Stream::Create(cache_file_.c_str(), "r", true));
+  if (fcache == nullptr || !this->CheckHeader(fcache.get())) return false;
+  std::unique_ptr<Stream> fi(Stream::Create(this->ManifestFile().c_str(), "r", true));
+  if (fi == nullptr || !this->CheckHeader(fi.get()) || !manifest_.Load(fi.get())) {
+    LOG(INFO) << "cache file " << cache_file_
+              << " is of an old format or built with other settings, rebuilding";
+    return false;
+  }
+  // the manifest belongs to the cache it was written with
+  if (manifest_.cache_size != this->CacheFileSize()) {
+    LOG(INFO) << "cache file " << cache_file_ << " is incomplete, rebuilding";
+    return false;
+  }
+  return stats_.Load(fi.get()) && fi->Read(&page_begin_);
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::SaveManifest(void) {
+  std::unique_ptr<Stream> fo(Stream::Create(this->ManifestFile().c_str(), "w"));
+  this->WriteHeader(fo.get());
+  manifest_.cache_size = this->CacheFileSize();
+  manifest_.Save(fo.get());
+  stats_.Save(fo.get());
+  fo->Write(page_begin_);
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::WriteHeader(Stream *fo) const {
+  uint32_t header[5] = {
+    kCacheMagic, kCacheVersion, static_cast<uint32_t>(value_format_),
+    static_cast<uint32_t>(sizeof(IndexType)), static_cast<uint32_t>(sizeof(DType))};
+  fo->Write(header, sizeof(header));
+}
+
+template<typename IndexType, typename DType>
+inline bool DiskRowIter<IndexType, DType>::CheckHeader(Stream *fi) const {
+  uint32_t header[5];
+  if (fi->Read(header, sizeof(header)) != sizeof(header)) return false;
+  return header[0] == kCacheMagic && header[1] == kCacheVersion &&
+      header[2] == static_cast<uint32_t>(value_format_) &&
+      header[3] == sizeof(IndexType) && header[4] == sizeof(DType);
+}
+
 template<typename IndexType, typename DType>
 inline void DiskRowIter<IndexType, DType>::
-BuildCache(Parser<IndexType, DType> *parser) {
-  Stream *fo = Stream::Create(cache_file_.c_str(), "w");
+CreateCache(const std::string &path, CacheOutput *out) {
+  out->fo.reset(Stream::Create(path.c_str(), "w"));
+  this->WriteHeader(out->fo.get());
+  out->num_page = 0;
+  out->num_byte = sizeof(uint32_t) * 5;
+  out->page_begin.clear();
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::
+WritePage(const RowBlockContainer<IndexType, DType> &data, CacheOutput *out) {
+  CompactRowBlock<IndexType, DType> page;
+  page.Encode(data, value_format_);
+  this->WritePage(page, out);
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::
+WritePage(const CompactRowBlock<IndexType, DType> &page, CacheOutput *out) {
+  std::string blob;
+  MemoryStringStream ms(&blob);
+  page.Save(&ms);
+  out->fo->Write(blob.data(), blob.length());
+  out->page_begin.push_back(out->num_byte);
+  out->num_page += 1;
+  out->num_byte += blob.length();
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::
+ParsePages(Parser<IndexType, DType> *parser, CacheOutput *out) {
   // back end data
   RowBlockContainer<IndexType, DType> data;
-  num_col_ = 0;
   double tstart = GetTime();
   while (parser->Next()) {
-    data.Push(parser->Value());
-    double tdiff = GetTime() - tstart;
-    if (data.MemCostBytes() >= kPageSize) {
-      size_t bytes_read = parser->BytesRead();
-      bytes_read = bytes_read >> 20UL;
-      LOG(INFO) << bytes_read << "MB read,"
-                << bytes_read / tdiff << " MB/sec";
-      num_col_ = std::max(num_col_,
-                          static_cast<size_t>(data.max_index) + 1);
-      data.Save(fo);
-      data.Clear();
+    const RowBlock<IndexType, DType> &batch = parser->Value();
+    stats_.Add(batch);
+    // split the batch so that the pages stay close to page_bytes_
+    size_t begin = 0;
+    while (begin != batch.size) {
+      size_t end = batch.size;
+      const size_t used = data.MemCostBytes();
+      const size_t room = used < page_bytes_ ? page_bytes_ - used : 0;
+      const size_t cost = batch.Slice(begin, end).MemCostBytes();
+      if (cost > room) {
+        end = begin + std::max(static_cast<size_t>(1), (end - begin) * room / cost);
+      }
+      data.Push(batch.Slice(begin, end));
+      begin = end;
+      if (data.MemCostBytes() >= page_bytes_) {
+        double tdiff = GetTime() - tstart;
+        size_t bytes_read = parser->BytesRead();
+        bytes_read = bytes_read >> 20UL;
+        LOG(INFO) << bytes_read << "MB read,"
+                  << bytes_read / tdiff << " MB/sec";
+        this->WritePage(data, out);
+        data.Clear();
+      }
     }
   }
   if (data.Size() != 0) {
-    num_col_ = std::max(num_col_,
-                        static_cast<size_t>(data.max_index) + 1);
-    data.Save(fo);
+    this->WritePage(data, out);
   }
-  delete fo;
   double tdiff = GetTime() - tstart;
-  LOG(INFO) << "finish reading at %g MB/sec"
-            << (parser->BytesRead() >> 20UL) / tdiff;
+  LOG(INFO) << "finish reading at "
+            << (parser->BytesRead() >> 20UL) / tdiff << " MB/sec";
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::
+BuildCache(Parser<IndexType, DType> *parser, const std::string &path) {
+  // drop the old manifest first, it is written again once the cache is complete
+  delete Stream::Create(this->ManifestFile().c_str(), "w");
+  CacheOutput out;
+  this->CreateCache(path, &out);
+  stats_.Clear();
+  this->ParsePages(parser, &out);
+  out.fo.reset();
+  page_begin_.swap(out.page_begin);
+  manifest_ = io::CacheManifest();
+  this->SaveManifest();
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::
+AppendFiles(const std::vector<io::FileInfo> &files, const ParserFactory &factory) {
+  delete Stream::Create(this->ManifestFile().c_str(), "w");
+  CacheOutput out;
+  out.fo.reset(Stream::Create(cache_file_.c_str(), "a"));
+  out.num_page = manifest_.files.empty() ? 0 : manifest_.files.back().page_end;
+  out.num_byte = manifest_.cache_size;
+  out.page_begin.swap(page_begin_);
+  for (size_t i = manifest_.files.size(); i < files.size(); ++i) {
+    LOG(INFO) << "appending " << files[i].path.str() << " to cache file " << cache_file_;
+    io::CacheManifestEntry entry(files[i]);
+    entry.page_begin = out.num_page;
+    entry.byte_begin = out.num_byte;
+    std::unique_ptr<Parser<IndexType, DType> > parser(factory(entry.path, 0, 1));
+    this->ParsePages(parser.get(), &out);
+    entry.page_end = out.num_page;
+    entry.byte_end = out.num_byte;
+    manifest_.files.push_back(entry);
+  }
+  out.fo.reset();
+  page_begin_.swap(out.page_begin);
+  this->SaveManifest();
+}
+
+template<typename IndexType, typename DType>
+inline void DiskRowIter<IndexType, DType>::
+RebuildFiles(const std::vector<io::FileInfo> &files, const ParserFactory &factory,
+             bool loaded, const std::string &source) {
+  delete Stream::Create(this->ManifestFile().c_str(), "w");
+  io::CacheManifest old;
+  std::unique_ptr<SeekStream> fold;
+  if (loaded) {
+    old = manifest_;
+    fold.reset(SeekStream::CreateForRead(cache_file_.c_str()));
+  }
+  // write next to the old cache, whose pages may be copied
+  const std::string tmp_file = cache_file_ + ".tmp";
+  CacheOutput out;
+  this->CreateCache(tmp_file, &out);
+  stats_.Clear();
+  manifest_ = io::CacheManifest();
+  manifest_.source = source;
+  CompactRowBlock<IndexType, DType> page;
+  RowBlockContainer<IndexType, DType> data;
+  for (size_t i = 0; i < files.size(); ++i) {
+    io::CacheManifestEntry entry(files[i]);
+    entry.page_begin = out.num_page;
+    entry.byte_begin = out.num_byte;
+    const size_t k = old.FindUnchanged(files[i]);
+    if (k != old.files.size()) {
+      // copy the pages of an unchanged file, decoding them for the statistics
+      fold->Seek(old.files[k].byte_begin);
+      for (uint64_t j = old.files[k].page_begin; j < old.files[k].page_end; ++j) {
+        CHECK(page.Load(fold.get())) << "invalid cache file " << cache_file_;
+        page.Decode(&data);
+        stats_.Add(data.GetBlock());
+        this->WritePage(page, &out);
+      }
+    } else {
+      std::unique_ptr<Parser<IndexType, DType> > parser(factory(entry.path, 0, 1));
+      this->ParsePages(parser.get(), &out);
+    }
+    entry.page_end = out.num_page;
+    entry.byte_end = out.num_byte;
+    manifest_.files.push_back(entry);
+  }
+  out.fo.reset();
+  fold.reset();
+  page_begin_.swap(out.page_begin);
+  CHECK_EQ(std::rename(io::URI(tmp_file.c_str()).name.c_str(),
+                       io::URI(cache_file_.c_str()).name.c_str()), 0)
+      << "failed to replace cache file " << cache_file_;
+  this->SaveManifest();
 }
 }  // namespace data
 }  // namespace dmlc
@@ -0,0 +1,219 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file hashed_libsvm_parser.h
+ * \brief iterator parser to parse libsvm-like format
+ *  whose feature names are strings hashed into feature index
+ */
+#ifndef DMLC_DATA_HASHED_LIBSVM_PARSER_H_
+#define DMLC_DATA_HASHED_LIBSVM_PARSER_H_
+
+#include <dmlc/data.h>
+#include <dmlc/strtonum.h>
+#include <dmlc/parameter.h>
+#include <map>
+#include <string>
+#include <cstring>
+#include "./row_block.h"
+#include "./text_parser.h"
+
+namespace dmlc {
+namespace data {
+
+struct HashedLibSVMParserParam : public Parameter<HashedLibSVMParserParam> {
+  std::string format;
+  int hash_bits;
+  int hash_seed;
+  bool signed_hash;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(HashedLibSVMParserParam) {
+    DMLC_DECLARE_FIELD(format).set_default("hashed_libsvm")
+        .describe("File format");
+    DMLC_DECLARE_FIELD(hash_bits).set_default(24).set_range(1, 31)
+        .describe("Number of bits of the hashed feature space, "
+                  "feature indices will lie in [0, 2^hash_bits).");
+    DMLC_DECLARE_FIELD(hash_seed).set_default(0)
+        .describe("Seed of the hash function.");
+    DMLC_DECLARE_FIELD(signed_hash).set_default(false)
+        .describe("If true, use one extra bit of the hash to flip the sign of "
+                  "the feature value, so that collisions cancel out in expectation.");
+  }
+};
+
+/*!
+ * \brief 32-bit MurmurHash3 (x86 variant) of a byte sequence
+ * \param key pointer to the bytes
+ * \param len number of bytes
+ * \param seed the hash seed
+ * \return the hash value
+ */
+inline uint32_t MurmurHash3(const char *key, size_t len, uint32_t seed) {
+  const uint32_t c1 = 0xcc9e2d51U;
+  const uint32_t c2 = 0x1b873593U;
+  const size_t nblocks = len / 4;
+  uint32_t h = seed;
+  for (size_t i = 0; i < nblocks; ++i) {
+    uint32_t k;
+    std::memcpy(&k, key + i * 4, sizeof(k));
+    k *= c1; k = (k << 15) | (k >> 17); k *= c2;
+    h ^= k; h = (h << 13) | (h >> 19); h = h * 5 + 0xe6546b64U;
+  }
+  const unsigned char *tail =
+      reinterpret_cast<const unsigned char*>(key + nblocks * 4);
+  uint32_t k = 0;
+  switch (len & 3) {
+    case 3: k ^= static_cast<uint32_t>(tail[2]) << 16;  // fall through
+    case 2: k ^= static_cast<uint32_t>(tail[1]) << 8;   // fall through
+    case 1: k ^= tail[0];
+      k *= c1; k = (k << 15) | (k >> 17); k *= c2; h ^= k;
+  }
+  h ^= static_cast<uint32_t>(len);
+  h ^= h >> 16; h *= 0x85ebca6bU;
+  h ^= h >> 13; h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+  return h;
+}
+
+/*!
+ * \brief Text parser that parses libsvm-like lines whose features are
+ *  string names, hashing them into feature indices while parsing.
+ *
+ *  Each line has the form
+ *
+ *    label[:weight] [qid:id] [|namespace] name[:value] name[:value] ...
+ *
+ *  A token starting with '|' switches the namespace of the following
+ *  features, the namespace salts the hash so that equal names in different
+ *  namespaces map to different indices. A bare '|' returns to the default
+ *  namespace. Features without value get value 1.
+ */
+template <typename IndexType, typename DType = real_t>
+class HashedLibSVMParser : public TextParserBase<IndexType, DType> {
+ public:
+  explicit HashedLibSVMParser(InputSplit *source, int nthread)
+      : HashedLibSVMParser(source, std::map<std::string, std::string>(), nthread) {}
+  explicit HashedLibSVMParser(InputSplit *source,
+                              const std::map<std::string, std::string>& args,
+                              int nthread)
+      : TextParserBase<IndexType, DType>(source, nthread) {
+    param_.Init(args);
+    CHECK_EQ(param_.format, "hashed_libsvm");
+  }
+  /*!
+   * \brief compute the feature index and sign of a feature name
+   * \param name beginning of the feature name
+   * \param len length of the feature name
+   * \param ns_seed hash seed of the namespace the feature belongs to
+   * \param out_sign the sign to be applied to the feature value
+   * \return the hashed feature index
+   */
+  inline IndexType HashFeature(const char *name, size_t len,
+                               uint32_t ns_seed, real_t *out_sign) const {
+    uint32_t h = MurmurHash3(name, len, ns_seed);
+    *out_sign = (param_.signed_hash && (h >> 31U) != 0) ? -1.0f : 1.0f;
+    return static_cast<IndexType>(h & ((1U << param_.hash_bits) - 1U));
+  }
+  /*!
+   * \brief compute the hash seed of a namespace
+   * \param name beginning of the namespace, NULL for the default one
+   * \param len length of the namespace name
+   * \return seed to be used for features inside the namespace
+   */
+  inline uint32_t NamespaceSeed(const char *name, size_t len) const {
+    uint32_t seed = static_cast<uint32_t>(param_.hash_seed);
+    if (len == 0) return seed;
+    return MurmurHash3(name, len, seed);
+  }
+
+ protected:
+  virtual void ParseBlock(const char *begin,
+                          const char *end,
+                          RowBlockContainer<IndexType, DType> *out);
+
+ private:
+  HashedLibSVMParserParam param_;
+};
+
+template <typename IndexType, typename DType>
+void HashedLibSVMParser<IndexType, DType>::
+ParseBlock(const char *begin,
+           const char *end,
+           RowBlockContainer<IndexType, DType> *out) {
+  out->Clear();
+  const uint32_t default_seed = this->NamespaceSeed(NULL, 0);
+  const char * lbegin = begin;
+  const char * lend = lbegin;
+  while (lbegin != end) {
+    // get line end
+    lend = lbegin + 1;
+    while (lend != end && *lend != '\n' && *lend != '\r') ++lend;
+    // parse label[:weight]
+    const char * p = lbegin;
+    const char * q = NULL;
+    real_t label;
+    real_t weight;
+    int r = ParsePair<real_t, real_t>(p, lend, &q, label, weight);
+    if (r < 1) {
+      // empty line
+      lbegin = lend;
+      continue;
+    }
+    if (r == 2) {
+      // has weight
+      out->weight.push_back(weight);
+    }
+    out->label.push_back(label);
+    // parse qid:id
+    p = q;
+    while (p != lend && isblank(*p)) ++p;
+    if (lend - p > 4 && strncmp(p, "qid:", 4) == 0) {
+      p += 4;
+      out->qid.push_back(static_cast<uint64_t>(atoll(p)));
+      while (p != lend && isdigitchars(*p)) ++p;
+    }
+    // parse [|namespace] name[:value] tokens
+    uint32_t ns_seed = default_seed;
+    while (p != lend) {
+      while (p != lend && isblank(*p)) ++p;
+      if (p == lend) break;
+      const char *tbegin = p;
+      while (p != lend && !isblank(*p)) ++p;
+      const char *tend = p;
+      if (*tbegin == '|') {
+        ns_seed = this->NamespaceSeed(tbegin + 1, tend - tbegin - 1);
+        continue;
+      }
+      // the value, if any, follows the last colon of the token
+      const char *colon = tend;
+      for (const char *c = tend; c != tbegin; --c) {
+        if (*(c - 1) == ':') {
+          colon = c - 1; break;
+        }
+      }
+      real_t value = 1.0f;
+      if (colon != tend && colon + 1 != tend) {
+        char *vend;
+        real_t v = ParseFloat<real_t>(colon + 1, &vend);
+        if (vend == tend && colon != tbegin) {
+          value = v;
+        } else {
+          colon = tend;
+        }
+      } else {
+        colon = tend;
+      }
+      real_t sign;
+      IndexType findex = this->HashFeature(tbegin, colon - tbegin, ns_seed, &sign);
+      out->index.push_back(findex);
+      out->value.push_back(sign * value);
+      out->max_index = std::max(out->max_index, findex);
+    }
+    out->offset.push_back(out->index.size());
+    // next line
+    lbegin = lend;
+  }
+  CHECK(out->label.size() + 1 == out->offset.size());
+}
+
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_HASHED_LIBSVM_PARSER_H_
@@ -0,0 +1,255 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file lazy_text_iter.h
+ * \brief iterator over text chunks that parses the lines on demand
+ */
+#ifndef DMLC_DATA_LAZY_TEXT_ITER_H_
+#define DMLC_DATA_LAZY_TEXT_ITER_H_
+
+#include <dmlc/common.h>
+#include <dmlc/data.h>
+#include <dmlc/io.h>
+#include <dmlc/omp.h>
+#include <dmlc/strtonum.h>
+#include <dmlc/trace.h>
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "./row_block.h"
+#include "./text_parser.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif  // defined(__SSE2__)
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief find the lines of a text buffer, skipping empty lines
+ *  and the end of line characters
+ * \param begin beginning of the buffer
+ * \param end end of the buffer
+ * \param lbegin receives the beginning of each line
+ * \param lend receives the end of each line
+ * \param need_number whether to also skip the lines without any character
+ *  of a number, which the libsvm and libfm parsers drop as well
+ */
+inline void IndexLines(const char *begin, const char *end,
+                       std::vector<const char*> *lbegin,
+                       std::vector<const char*> *lend,
+                       bool need_number = false) {
+  const char *p = begin;
+  while (p != end) {
+    const char *line = p;
+#if defined(__SSE2__)
+    // look for '\n' and '\r' 16 bytes at a time
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    while (end - p >= 16) {
+      const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      const int mask = _mm_movemask_epi8(
+          _mm_or_si128(_mm_cmpeq_epi8(bytes, newline), _mm_cmpeq_epi8(bytes, cr)));
+      if (mask != 0) {
+        p += __builtin_ctz(static_cast<unsigned>(mask));
+        break;
+      }
+      p += 16;
+    }
+#endif  // defined(__SSE2__)
+    while (p != end && *p != '\n' && *p != '\r') ++p;
+    if (p != line && (!need_number || std::find_if(line, p, isdigitchars) != p)) {
+      lbegin->push_back(line);
+      lend->push_back(p);
+    }
+    while (p != end && (*p == '\n' || *p == '\r')) ++p;
+  }
+}
+
+/*!
+ * \brief LazyRowBlockIter over a text InputSplit, the lines are parsed
+ *  by the ParseBlock of a text parser
+ * \tparam IndexType type of index in RowBlock
+ * \tparam DType type of label and value in RowBlock
+ */
+template<typename IndexType, typename DType = real_t>
+class LazyTextIter : public LazyRowBlockIter<IndexType, DType> {
+ public:
+  /*! \brief parses the label of a line */
+  typedef std::function<real_t(const char *begin, const char *end)> LabelParser;
+  /*!
+   * \brief constructor
+   * \param source the text split, owned
+   * \param parser parser of the format, owned, only its ParseBlock is used
+   * \param label_parser parses the label of a line as the parser would
+   * \param need_number whether the parser drops the lines without a number
+   */
+  LazyTextIter(InputSplit *source, TextParserBase<IndexType, DType> *parser,
+               LabelParser label_parser, bool need_number)
+      : source_(source), parser_(parser), label_parser_(label_parser),
+        need_number_(need_number), bytes_read_(0), block_(this) {}
+  virtual void BeforeFirst(void) {
+    source_->BeforeFirst();
+  }
+  virtual bool Next(void) {
+    InputSplit::Blob chunk;
+    do {
+      if (!source_->NextChunk(&chunk)) return false;
+      bytes_read_ += chunk.size;
+      const char *begin = static_cast<const char*>(chunk.dptr);
+      const char *end = begin + chunk.size;
+      TextParserBase<IndexType, DType>::IgnoreUTF8BOM(&begin, &end);
+      block_.Reset(begin, end);
+    } while (block_.Size() == 0);
+    return true;
+  }
+  virtual const LazyRowBlock<IndexType, DType> &Value(void) const {
+    return block_;
+  }
+  virtual size_t BytesRead(void) const {
+    return bytes_read_;
+  }
+
+ private:
+  /*! \brief the lines of the current chunk */
+  class Block : public LazyRowBlock<IndexType, DType> {
+   public:
+    explicit Block(LazyTextIter *iter) : iter_(iter), all_parsed_(false), num_parsed_(0) {}
+    /*! \brief index the lines of a new chunk and drop the cache */
+    inline void Reset(const char *begin, const char *end) {
+      lbegin_.clear();
+      lend_.clear();
+      IndexLines(begin, end, &lbegin_, &lend_, iter_->need_number_);
+      label_.assign(lbegin_.size(), 0.0f);
+      has_label_.assign(lbegin_.size(), 0);
+      rows_.clear();
+      rows_.resize(lbegin_.size());
+      all_.Clear();
+      all_parsed_ = false;
+      num_parsed_ = 0;
+    }
+    virtual size_t Size(void) const {
+      return lbegin_.size();
+    }
+    virtual void Line(size_t rowid, const char **begin, const char **end) const {
+      CHECK_LT(rowid, lbegin_.size());
+      *begin = lbegin_[rowid];
+      *end = lend_[rowid];
+    }
+    virtual real_t Label(size_t rowid) const {
+      CHECK_LT(rowid, lbegin_.size());
+      if (all_parsed_) return all_.label[rowid];
+      if (rows_[rowid] != nullptr) return rows_[rowid]->label[0];
+      if (!has_label_[rowid]) {
+        label_[rowid] = iter_->label_parser_(lbegin_[rowid], lend_[rowid]);
+        has_label_[rowid] = 1;
+      }
+      return label_[rowid];
+    }
+    virtual Row<IndexType, DType> GetRow(size_t rowid) const {
+      CHECK_LT(rowid, lbegin_.size());
+      if (all_parsed_) return all_block_[rowid];
+      return this->ParseRow(rowid)->GetBlock()[0];
+    }
+    virtual RowBlock<IndexType, DType> Select(const std::vector<size_t> &rowids) const {
+      selected_.Clear();
+      for (size_t rowid : rowids) {
+        CHECK_LT(rowid, lbegin_.size());
+        if (all_parsed_) {
+          selected_.Push(all_block_.Slice(rowid, rowid + 1));
+        } else {
+          selected_.Push(this->ParseRow(rowid)->GetBlock());
+        }
+      }
+      return selected_.GetBlock();
+    }
+    virtual RowBlock<IndexType, DType> All(void) const {
+      if (!all_parsed_) this->ParseAll();
+      return all_block_;
+    }
+    virtual size_t NumParsed(void) const {
+      return all_parsed_ ? lbegin_.size() : num_parsed_;
+    }
+
+   private:
+    /*! \brief the iterator, holding the parsers */
+    LazyTextIter *iter_;
+    /*! \brief beginning of each line */
+    std::vector<const char*> lbegin_;
+    /*! \brief end of each line */
+    std::vector<const char*> lend_;
+    /*! \brief labels parsed alone */
+    mutable std::vector<real_t> label_;
+    /*! \brief whether the label of a line is in label_ */
+    mutable std::vector<uint8_t> has_label_;
+    /*! \brief rows parsed one by one, NULL for the lines not parsed yet */
+    mutable std::vector<std::unique_ptr<RowBlockContainer<IndexType, DType> > > rows_;
+    /*! \brief all the rows, once parsed together */
+    mutable RowBlockContainer<IndexType, DType> all_;
+    /*! \brief view of all_ */
+    mutable RowBlock<IndexType, DType> all_block_;
+    /*! \brief whether all_ holds the rows */
+    mutable bool all_parsed_;
+    /*! \brief number of rows parsed one by one */
+    mutable size_t num_parsed_;
+    /*! \brief the rows of the last Select */
+    mutable RowBlockContainer<IndexType, DType> selected_;
+    /*! \brief catches the errors of the parsing threads */
+    mutable OMPException omp_exc_;
+    /*! \return the parsed row of a line, parsing it on the first call */
+    inline const RowBlockContainer<IndexType, DType> *ParseRow(size_t rowid) const {
+      if (rows_[rowid] == nullptr) {
+        std::unique_ptr<RowBlockContainer<IndexType, DType> > row(
+            new RowBlockContainer<IndexType, DType>());
+        iter_->parser_->ParseBlock(lbegin_[rowid], lend_[rowid], row.get());
+        CHECK_EQ(row->Size(), 1U) << "LazyRowBlockIter: line "
+            << std::string(lbegin_[rowid], lend_[rowid]) << " does not hold a row";
+        rows_[rowid] = std::move(row);
+        ++num_parsed_;
+      }
+      return rows_[rowid].get();
+    }
+    /*! \brief parse all the lines, cutting them into one range per thread */
+    inline void ParseAll() const {
+      DMLC_TRACE_SCOPE("LazyTextIter::ParseAll", "parse");
+      const size_t nline = lbegin_.size();
+      const int nthread = static_cast<int>(
+          std::min<size_t>(std::max(omp_get_max_threads(), 1), nline));
+      std::vector<RowBlockContainer<IndexType, DType> > parts(nthread);
+      const size_t nstep = (nline + nthread - 1) / nthread;
+#pragma omp parallel num_threads(nthread)
+      {
+        omp_exc_.Run([&] {
+          const size_t tid = omp_get_thread_num();
+          const size_t begin = std::min(tid * nstep, nline);
+          const size_t end = std::min(begin + nstep, nline);
+          if (begin != end) {
+            iter_->parser_->ParseBlock(lbegin_[begin], lend_[end - 1], &parts[tid]);
+          }
+        });
+      }
+      omp_exc_.Rethrow();
+      all_.Clear();
+      for (int i = 0; i < nthread; ++i) all_.Push(parts[i].GetBlock());
+      CHECK_EQ(all_.Size(), nline) << "LazyRowBlockIter: some lines do not hold a row";
+      all_block_ = all_.GetBlock();
+      all_parsed_ = true;
+    }
+  };
+  /*! \brief the text split */
+  std::unique_ptr<InputSplit> source_;
+  /*! \brief parser of the lines */
+  std::unique_ptr<TextParserBase<IndexType, DType> > parser_;
+  /*! \brief parser of the labels */
+  LabelParser label_parser_;
+  /*! \brief whether the lines without a number are skipped */
+  bool need_number_;
+  /*! \brief bytes read so far */
+  size_t bytes_read_;
+  /*! \brief the current block */
+  Block block_;
+};
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_LAZY_TEXT_ITER_H_
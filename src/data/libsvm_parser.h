@@ -16,6 +16,7 @@
 #include <algorithm>
 #include <cstring>
 #include "./row_block.h"
+#include "./row_sampler.h"
 #include "./text_parser.h"
 
 namespace dmlc {
@@ -51,7 +52,7 @@ class LibSVMParser : public TextParserBase<IndexType> {
                         const std::map<std::string, std::string>& args,
                         int nthread)
       : TextParserBase<IndexType>(source, nthread) {
-    param_.Init(args);
+    param_.Init(sampler_.Init(args));
     CHECK_EQ(param_.format, "libsvm");
   }
 
@@ -62,6 +63,7 @@ class LibSVMParser : public TextParserBase<IndexType> {
 
  private:
   LibSVMParserParam param_;
+  RowSampler sampler_;
 };
 
 template <typename IndexType, typename DType>
@@ -88,6 +90,12 @@ ParseBlock(const char *begin,
       lbegin = lend;
       continue;
     }
+    if (sampler_.enabled() &&
+        !sampler_.Accept(label, this->LinePosition(lbegin, lend))) {
+      // rejected lines are not parsed further
+      lbegin = lend;
+      continue;
+    }
     if (r == 2) {
       // has weight
       out->weight.push_back(weight);
@@ -131,14 +131,16 @@ struct RowBlockContainer {
     if (batch.qid != NULL) {
       qid.insert(qid.end(), batch.qid, batch.qid + batch.size);
     }
-    size_t ndata = batch.offset[batch.size] - batch.offset[0];
+    // a sliced batch keeps absolute offsets into its arrays
+    const size_t base = batch.offset[0];
+    size_t ndata = batch.offset[batch.size] - base;
     if (batch.field != NULL) {
       field.resize(field.size() + ndata);
       IndexType *fhead = BeginPtr(field) + offset.back();
       for (size_t i = 0; i < ndata; ++i) {
-        CHECK_LE(batch.field[i], std::numeric_limits<IndexType>::max())
+        CHECK_LE(batch.field[base + i], std::numeric_limits<IndexType>::max())
             << "field  exceed numeric bound of current type";
-        IndexType field_id = static_cast<IndexType>(batch.field[i]);
+        IndexType field_id = static_cast<IndexType>(batch.field[base + i]);
         fhead[i] = field_id;
         max_field = std::max(max_field, field_id);
       }
@@ -146,15 +148,15 @@ struct RowBlockContainer {
     index.resize(index.size() + ndata);
     IndexType *ihead = BeginPtr(index) + offset.back();
     for (size_t i = 0; i < ndata; ++i) {
-      CHECK_LE(batch.index[i], std::numeric_limits<IndexType>::max())
+      CHECK_LE(batch.index[base + i], std::numeric_limits<IndexType>::max())
           << "index  exceed numeric bound of current type";
-      IndexType findex = static_cast<IndexType>(batch.index[i]);
+      IndexType findex = static_cast<IndexType>(batch.index[base + i]);
       ihead[i] = findex;
       max_index = std::max(max_index, findex);
     }
     if (batch.value != NULL) {
       value.resize(value.size() + ndata);
-      std::memcpy(BeginPtr(value) + value.size() - ndata, batch.value,
+      std::memcpy(BeginPtr(value) + value.size() - ndata, batch.value + base,
                   ndata * sizeof(DType));
     }
     size_t shift = offset[size];
@@ -0,0 +1,84 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file row_block_iter_param.h
+ * \brief parameters of the row block iterators that are
+ *  passed through uri arguments along with parser arguments
+ */
+#ifndef DMLC_DATA_ROW_BLOCK_ITER_PARAM_H_
+#define DMLC_DATA_ROW_BLOCK_ITER_PARAM_H_
+
+#include <dmlc/parameter.h>
+#include <string>
+#include "./compact_row_block.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief parameters consumed by RowBlockIter::Create,
+ *  the remaining uri arguments are passed to the parser
+ */
+struct RowBlockIterParam : public Parameter<RowBlockIterParam> {
+  /*! \brief maximum number of rows in each batch, 0 means unlimited */
+  size_t batch_rows;
+  /*! \brief maximum number of non-zeros in each batch, 0 means unlimited */
+  size_t batch_nnz;
+  /*! \brief maximum memory cost of each batch in bytes, 0 means unlimited */
+  size_t batch_bytes;
+  /*! \brief storage format of feature values, see ValueFormat */
+  int value_format;
+  /*! \brief whether to keep in-memory data in compact pages */
+  bool compact_index;
+  /*! \brief path of the memory mapped file shared by the processes on a host */
+  std::string shared_file;
+  /*! \brief memory cost of the decoded pages of a cache file */
+  size_t cache_page_bytes;
+  /*! \brief whether to visit the pages of a cache file in a random order in each pass */
+  bool shuffle_pages;
+  /*! \brief whether to also permute the rows within each page */
+  bool shuffle_rows;
+  /*! \brief random seed of the shuffling */
+  uint64_t shuffle_seed;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(RowBlockIterParam) {
+    DMLC_DECLARE_FIELD(batch_rows).set_default(0)
+        .describe("Maximum number of rows in each returned batch, 0 means unlimited.");
+    DMLC_DECLARE_FIELD(batch_nnz).set_default(0)
+        .describe("Maximum number of non-zero entries in each returned batch, "
+                  "0 means unlimited.");
+    DMLC_DECLARE_FIELD(batch_bytes).set_default(0)
+        .describe("Maximum memory cost in bytes of each returned batch, "
+                  "0 means unlimited.");
+    DMLC_DECLARE_FIELD(value_format).set_default(kValueNative)
+        .add_enum("native", kValueNative)
+        .add_enum("float16", kValueFloat16)
+        .add_enum("bfloat16", kValueBFloat16)
+        .add_enum("uint8", kValueUInt8)
+        .describe("Storage format of the feature values held in memory or in "
+                  "the cache file, values are converted back when read.");
+    DMLC_DECLARE_FIELD(compact_index).set_default(false)
+        .describe("If true, keep in-memory data in pages whose offsets and indices "
+                  "use the narrowest integer width that fits each page. "
+                  "Cache files always use narrow pages.");
+    DMLC_DECLARE_FIELD(shared_file).set_default("")
+        .describe("If set, the parsed data is kept in this memory mapped file, "
+                  "usually under /dev/shm. The first process builds it and the "
+                  "other processes on the host reading the same input attach to it.");
+    DMLC_DECLARE_FIELD(cache_page_bytes).set_default(64UL << 20UL)
+        .describe("Memory cost in bytes of the decoded pages written to a cache file, "
+                  "smaller pages give finer grained shuffling.");
+    DMLC_DECLARE_FIELD(shuffle_pages).set_default(false)
+        .describe("If true, visit the pages of the cache file in a different random "
+                  "order in each pass.");
+    DMLC_DECLARE_FIELD(shuffle_rows).set_default(false)
+        .describe("If true, also permute the rows within each page, implies shuffle_pages.");
+    DMLC_DECLARE_FIELD(shuffle_seed).set_default(0)
+        .describe("Random seed of the page and row shuffling.");
+  }
+  /*! \return whether any batch budget is set */
+  inline bool HasBatchBudget() const {
+    return batch_rows != 0 || batch_nnz != 0 || batch_bytes != 0;
+  }
+};
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_ROW_BLOCK_ITER_PARAM_H_
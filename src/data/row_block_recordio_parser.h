@@ -0,0 +1,198 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file row_block_recordio_parser.h
+ * \brief parser of RowBlocks stored in RecordIO by RowBlockRecordIOWriter
+ */
+#ifndef DMLC_DATA_ROW_BLOCK_RECORDIO_PARSER_H_
+#define DMLC_DATA_ROW_BLOCK_RECORDIO_PARSER_H_
+
+#include <dmlc/data.h>
+#include <dmlc/omp.h>
+#include <dmlc/common.h>
+#include <dmlc/recordio.h>
+#include <dmlc/row_block_recordio.h>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "./row_block.h"
+#include "./parser.h"
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief parser of the "rowblock" format, the records are copied into
+ *  the containers without any numeric parsing.
+ *  Partitioning is done by the recordio splitter, each chunk is divided
+ *  among the threads at record boundaries.
+ */
+template <typename IndexType, typename DType = real_t>
+class RowBlockRecordIOParser : public ParserImpl<IndexType, DType> {
+ public:
+  RowBlockRecordIOParser(InputSplit *source, int nthread)
+      : bytes_read_(0), source_(source) {
+    CHECK(DMLC_LITTLE_ENDIAN) << "RowBlock records are only supported on little endian hosts";
+    nthread_ = std::max(std::min(omp_get_num_procs(), nthread), 1);
+  }
+  virtual ~RowBlockRecordIOParser() {
+    delete source_;
+  }
+  virtual void BeforeFirst(void) {
+    source_->BeforeFirst();
+  }
+  virtual size_t BytesRead(void) const {
+    return bytes_read_;
+  }
+
+ protected:
+  virtual bool ParseNext(std::vector<RowBlockContainer<IndexType, DType> > *data) {
+    InputSplit::Blob chunk;
+    if (!source_->NextChunk(&chunk)) return false;
+    bytes_read_ += chunk.size;
+    data->resize(nthread_);
+    #pragma omp parallel num_threads(nthread_)
+    {
+      omp_exc_.Run([&] {
+        const int tid = omp_get_thread_num();
+        RowBlockContainer<IndexType, DType> *out = &(*data)[tid];
+        out->Clear();
+        RecordIOChunkReader reader(chunk, tid, nthread_);
+        InputSplit::Blob rec;
+        while (reader.NextRecord(&rec)) {
+          AppendRecord(static_cast<const char*>(rec.dptr), rec.size, out);
+        }
+      });
+    }
+    omp_exc_.Rethrow();
+    this->data_ptr_ = 0;
+    return true;
+  }
+
+ private:
+  // number of threads
+  int nthread_;
+  // number of bytes read
+  size_t bytes_read_;
+  // source split that provides the records
+  InputSplit *source_;
+  // OMPException object to catch and rethrow exceptions in omp blocks
+  dmlc::OMPException omp_exc_;
+  /*!
+   * \brief copy n elements stored with src_bytes each into dst,
+   *  a plain memcpy when the stored type matches T
+   */
+  template<typename T>
+  inline static void CopyArray(const char *src, size_t n,
+                               size_t src_bytes, bool src_is_float, T *dst) {
+    if (src_bytes == sizeof(T) && src_is_float == std::is_floating_point<T>::value) {
+      if (n != 0) std::memcpy(dst, src, n * sizeof(T));
+      return;
+    }
+    for (size_t i = 0; i < n; ++i, src += src_bytes) {
+      if (src_is_float) {
+        if (src_bytes == sizeof(float)) {
+          float v; std::memcpy(&v, src, sizeof(v)); dst[i] = static_cast<T>(v);
+        } else {
+          double v; std::memcpy(&v, src, sizeof(v)); dst[i] = static_cast<T>(v);
+        }
+      } else if (std::is_signed<T>::value) {
+        if (src_bytes == sizeof(int32_t)) {
+          int32_t v; std::memcpy(&v, src, sizeof(v)); dst[i] = static_cast<T>(v);
+        } else {
+          int64_t v; std::memcpy(&v, src, sizeof(v)); dst[i] = static_cast<T>(v);
+        }
+      } else {
+        if (src_bytes == sizeof(uint32_t)) {
+          uint32_t v; std::memcpy(&v, src, sizeof(v)); dst[i] = static_cast<T>(v);
+        } else {
+          uint64_t v; std::memcpy(&v, src, sizeof(v)); dst[i] = static_cast<T>(v);
+        }
+      }
+    }
+  }
+  /*! \brief append the rows of a record to out */
+  inline static void AppendRecord(const char *rec, size_t size,
+                                  RowBlockContainer<IndexType, DType> *out) {
+    typedef RowBlockRecordHeader Header;
+    Header header;
+    CHECK_GE(size, sizeof(header)) << "invalid RowBlock record";
+    std::memcpy(&header, rec, sizeof(header));
+    CHECK(header.magic == Header::kMagic) << "invalid RowBlock record";
+    CHECK(header.version <= Header::kVersion)
+        << "RowBlock record version " << header.version << " is not supported";
+    CHECK(header.index_bytes == 4 || header.index_bytes == 8)
+        << "invalid RowBlock record index bytes";
+    CHECK(header.value_bytes == 4 || header.value_bytes == 8)
+        << "invalid RowBlock record value bytes";
+    CHECK_EQ(header.RecordBytes(), size) << "corrupted RowBlock record";
+    CHECK(header.max_index <= std::numeric_limits<IndexType>::max() &&
+          header.max_field <= std::numeric_limits<IndexType>::max())
+        << "feature index in RowBlock record exceeds the index type";
+    const size_t nrow = static_cast<size_t>(header.num_rows);
+    const size_t nnz = static_cast<size_t>(header.num_nonzero);
+    const bool is_float = header.value_is_float != 0;
+    const size_t row_begin = out->label.size();
+    const size_t nnz_begin = out->index.size();
+    if (out->offset.empty()) out->offset.push_back(0);
+    CHECK_EQ(out->offset.back(), nnz_begin);
+    const char *p = rec + sizeof(header);
+    // offsets are relative to the record
+    const uint64_t *offset = reinterpret_cast<const uint64_t*>(p);
+    std::vector<uint64_t> aligned;
+    if (reinterpret_cast<uintptr_t>(p) % alignof(uint64_t) != 0) {
+      aligned.resize(nrow + 1);
+      std::memcpy(BeginPtr(aligned), p, (nrow + 1) * sizeof(uint64_t));
+      offset = BeginPtr(aligned);
+    }
+    CHECK(offset[0] == 0 && offset[nrow] == nnz) << "corrupted RowBlock record";
+    out->offset.resize(row_begin + nrow + 1);
+    for (size_t i = 1; i <= nrow; ++i) {
+      CHECK_LE(offset[i - 1], offset[i]) << "corrupted RowBlock record";
+      out->offset[row_begin + i] = nnz_begin + static_cast<size_t>(offset[i]);
+    }
+    p += Header::AlignedBytes(nrow + 1, sizeof(uint64_t));
+    out->label.resize(row_begin + nrow);
+    CopyArray(p, nrow, header.value_bytes, is_float, BeginPtr(out->label) + row_begin);
+    p += Header::AlignedBytes(nrow, header.value_bytes);
+    // missing weights and values default to one, missing qids and fields
+    // are dropped unless every record of the block has them
+    if (header.flags & Header::kHasWeight) {
+      out->weight.resize(row_begin, 1.0f);
+      out->weight.resize(row_begin + nrow);
+      std::memcpy(BeginPtr(out->weight) + row_begin, p, nrow * sizeof(real_t));
+      p += Header::AlignedBytes(nrow, sizeof(real_t));
+    } else if (!out->weight.empty()) {
+      out->weight.resize(row_begin + nrow, 1.0f);
+    }
+    if ((header.flags & Header::kHasQid) && out->qid.size() == row_begin) {
+      out->qid.resize(row_begin + nrow);
+      std::memcpy(BeginPtr(out->qid) + row_begin, p, nrow * sizeof(uint64_t));
+    } else {
+      out->qid.clear();
+    }
+    if (header.flags & Header::kHasQid) p += Header::AlignedBytes(nrow, sizeof(uint64_t));
+    if ((header.flags & Header::kHasField) && out->field.size() == nnz_begin) {
+      out->field.resize(nnz_begin + nnz);
+      CopyArray(p, nnz, header.index_bytes, false, BeginPtr(out->field) + nnz_begin);
+      out->max_field = std::max(out->max_field, static_cast<IndexType>(header.max_field));
+    } else {
+      out->field.clear();
+    }
+    if (header.flags & Header::kHasField) p += Header::AlignedBytes(nnz, header.index_bytes);
+    out->index.resize(nnz_begin + nnz);
+    CopyArray(p, nnz, header.index_bytes, false, BeginPtr(out->index) + nnz_begin);
+    out->max_index = std::max(out->max_index, static_cast<IndexType>(header.max_index));
+    p += Header::AlignedBytes(nnz, header.index_bytes);
+    if (header.flags & Header::kHasValue) {
+      out->value.resize(nnz_begin, static_cast<DType>(1));
+      out->value.resize(nnz_begin + nnz);
+      CopyArray(p, nnz, header.value_bytes, is_float, BeginPtr(out->value) + nnz_begin);
+    } else if (!out->value.empty()) {
+      out->value.resize(nnz_begin + nnz, static_cast<DType>(1));
+    }
+  }
+};
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_ROW_BLOCK_RECORDIO_PARSER_H_
@@ -0,0 +1,115 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file row_sampler.h
+ * \brief row sampling of the text parsers, decided from the label
+ *  of a line so that rejected lines are never fully parsed
+ */
+#ifndef DMLC_DATA_ROW_SAMPLER_H_
+#define DMLC_DATA_ROW_SAMPLER_H_
+
+#include <dmlc/base.h>
+#include <dmlc/common.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace dmlc {
+namespace data {
+/*! \brief parameters of row sampling, peeled from the parser arguments */
+struct RowSamplerParam : public Parameter<RowSamplerParam> {
+  /*! \brief probability to keep a row */
+  float sample_rate;
+  /*! \brief per label probabilities to keep a row, as label:rate,label:rate */
+  std::string label_sample_rate;
+  /*! \brief seed of the sampling */
+  uint64_t sample_seed;
+  // declare parameters
+  DMLC_DECLARE_PARAMETER(RowSamplerParam) {
+    DMLC_DECLARE_FIELD(sample_rate).set_default(1.0f).set_range(0.0f, 1.0f)
+        .describe("Probability to keep each row, rows are sampled independently.");
+    DMLC_DECLARE_FIELD(label_sample_rate).set_default("")
+        .describe("Per label probabilities to keep a row, given as "
+                  "label:rate pairs separated by commas, e.g. 0:0.1,1:1. "
+                  "Rows of other labels are kept with sample_rate.");
+    DMLC_DECLARE_FIELD(sample_seed).set_default(0)
+        .describe("Random seed of the sampling, the decision of each row only "
+                  "depends on the seed and the position of the row in the input.");
+  }
+};
+
+/*!
+ * \brief Bernoulli or stratified by label row sampler.
+ *  The decision of a row is a hash of the seed and the byte position of the
+ *  line within the partition, so it does not depend on the number of threads
+ *  or the chunk size and is the same in every run and every epoch.
+ */
+class RowSampler {
+ public:
+  RowSampler() : enabled_(false) {}
+  /*!
+   * \brief initialize from the parser arguments
+   * \param args the parser arguments
+   * \return the arguments not consumed by the sampler
+   */
+  inline std::map<std::string, std::string>
+  Init(const std::map<std::string, std::string> &args) {
+    std::vector<std::pair<std::string, std::string> > unknown =
+        param_.InitAllowUnknown(args);
+    label_rate_.clear();
+    for (const std::string &item : Split(param_.label_sample_rate, ',')) {
+      if (item.empty()) continue;
+      size_t pos = item.find(':');
+      CHECK(pos != std::string::npos)
+          << "label_sample_rate expects label:rate pairs, got " << item;
+      const real_t label = static_cast<real_t>(std::strtod(item.c_str(), NULL));
+      const float rate = static_cast<float>(std::strtod(item.c_str() + pos + 1, NULL));
+      CHECK(rate >= 0.0f && rate <= 1.0f)
+          << "label_sample_rate expects rates in [0, 1], got " << item;
+      label_rate_.push_back(std::make_pair(label, rate));
+    }
+    enabled_ = param_.sample_rate < 1.0f || !label_rate_.empty();
+    return std::map<std::string, std::string>(unknown.begin(), unknown.end());
+  }
+  /*! \return whether any sampling is done */
+  inline bool enabled() const {
+    return enabled_;
+  }
+  /*!
+   * \brief decide whether to keep a row
+   * \param label label of the row
+   * \param pos position of the row in the input
+   * \return true if the row is kept
+   */
+  inline bool Accept(real_t label, size_t pos) const {
+    float rate = param_.sample_rate;
+    for (size_t i = 0; i < label_rate_.size(); ++i) {
+      if (label_rate_[i].first == label) {
+        rate = label_rate_[i].second;
+        break;
+      }
+    }
+    if (rate >= 1.0f) return true;
+    uint64_t h = Mix(param_.sample_seed ^ Mix(static_cast<uint64_t>(pos)));
+    // top 53 bits as a double in [0, 1)
+    return static_cast<double>(h >> 11) * (1.0 / 9007199254740992.0) < rate;
+  }
+
+ private:
+  /*! \brief splitmix64 finalizer */
+  inline static uint64_t Mix(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+  }
+  bool enabled_;
+  RowSamplerParam param_;
+  std::vector<std::pair<real_t, float> > label_rate_;
+};
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_ROW_SAMPLER_H_
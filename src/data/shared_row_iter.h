@@ -0,0 +1,336 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file shared_row_iter.h
+ * \brief in-memory row iterator whose data lives in a memory mapped file
+ *   shared by all the processes on a host that read the same input
+ */
+#ifndef DMLC_DATA_SHARED_ROW_ITER_H_
+#define DMLC_DATA_SHARED_ROW_ITER_H_
+
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/data.h>
+#include <dmlc/timer.h>
+#include <dmlc/memory_io.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "./row_block.h"
+#include "../io/cache_manifest.h"
+#include "../io/filesys.h"
+#include "../io/input_split_base.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace dmlc {
+namespace data {
+/*!
+ * \brief header of a shared row block file, followed by the manifest
+ *  of the input and the arrays of the row block, each aligned to kAlign
+ */
+struct SharedRowHeader {
+  /*! \brief number of arrays in the file */
+  static const int kNumArray = 7;
+  /*! \brief magic number */
+  uint32_t magic;
+  /*! \brief format version */
+  uint32_t version;
+  /*! \brief width of the indices in bytes */
+  uint32_t index_bytes;
+  /*! \brief width of the labels and values in bytes */
+  uint32_t value_bytes;
+  /*! \brief number of rows */
+  uint64_t num_rows;
+  /*! \brief number of non-zero entries */
+  uint64_t num_nonzero;
+  /*! \brief maximum feature index */
+  uint64_t max_index;
+  /*! \brief maximum field index */
+  uint64_t max_field;
+  /*! \brief length of the serialized manifest following the header */
+  uint64_t manifest_bytes;
+  /*!
+   * \brief byte offsets of offset, label, weight, qid, field, index and value,
+   *  0 if the array is absent
+   */
+  uint64_t array_begin[kNumArray];
+  /*! \brief byte offset and length of the serialized dataset statistics */
+  uint64_t stats_begin, stats_bytes;
+  /*! \brief total size of the file, guards against truncated files */
+  uint64_t file_bytes;
+};
+
+/*!
+ * \brief row iterator that keeps the whole data in a memory mapped file,
+ *  typically under /dev/shm, so that the processes on a host that read the
+ *  same input share a single parsed copy.
+ *
+ *  The first process to take the exclusive lock on <file>.lock parses the
+ *  input, writes <file>.tmp and renames it to <file>, then releases the lock.
+ *  Processes that find a complete file built from the same source and the
+ *  same, unchanged input files map it read-only without parsing; the rename
+ *  makes a partially written file invisible to them. A file built from
+ *  input files that changed since is rebuilt under the lock.
+ *  The returned row block points into the mapping.
+ * \tparam IndexType the type of index we are using
+ */
+template<typename IndexType, typename DType = real_t>
+class SharedRowIter: public RowBlockIter<IndexType, DType> {
+ public:
+  /*! \brief factory creating the parser, only called by the process building the file */
+  typedef std::function<Parser<IndexType, DType> *()> ParserFactory;
+  // magic number of the shared file
+  static const uint32_t kMagic = 0xced7a3d2;
+  // version of the shared file format
+  static const uint32_t kVersion = 2;
+  // alignment of the arrays in the file
+  static const size_t kAlign = 64;
+  /*!
+   * \brief constructor
+   * \param factory creates the parser over the input
+   * \param shared_file path of the shared file, should be on a tmpfs such as
+   *  /dev/shm to keep the data in memory
+   * \param uri the input files, the file is rebuilt when any of them changes
+   * \param source description of the input and the parser, the file is
+   *  rebuilt when it changes
+   */
+  SharedRowIter(const ParserFactory &factory,
+                const std::string &shared_file,
+                const std::string &uri,
+                const std::string &source)
+      : shared_file_(shared_file), source_(source),
+        at_head_(true), data_(NULL), size_(0) {
+#ifdef _WIN32
+    LOG(FATAL) << "shared row block files are not supported on Windows";
+#else
+    io::InputSplitBase::ListInputFiles(
+        io::FileSystem::GetInstance(io::URI(uri.c_str())), uri, false, &files_);
+    CHECK_NE(files_.size(), 0U)
+        << "Cannot find any files that matches the URI pattern " << uri;
+    int lock = open((shared_file_ + ".lock").c_str(), O_RDWR | O_CREAT, 0644);
+    CHECK_NE(lock, -1) << "cannot open lock file of " << shared_file_
+                       << ": " << strerror(errno);
+    CHECK_EQ(flock(lock, LOCK_EX), 0) << "cannot lock " << shared_file_;
+    if (!this->Map()) {
+      std::unique_ptr<Parser<IndexType, DType> > parser(factory());
+      this->Build(parser.get());
+      CHECK(this->Map()) << "failed to map " << shared_file_ << " after building it";
+    } else {
+      LOG(INFO) << "attached to shared row block file " << shared_file_;
+    }
+    flock(lock, LOCK_UN);
+    close(lock);
+#endif  // _WIN32
+  }
+  virtual ~SharedRowIter() {
+#ifndef _WIN32
+    if (data_ != NULL) munmap(data_, size_);
+#endif  // _WIN32
+  }
+  virtual void BeforeFirst(void) {
+    at_head_ = true;
+  }
+  virtual bool Next(void) {
+    if (at_head_) {
+      at_head_ = false;
+      return true;
+    } else {
+      return false;
+    }
+  }
+  virtual const RowBlock<IndexType, DType> &Value(void) const {
+    return row_;
+  }
+  virtual size_t NumCol(void) const {
+    return num_col_;
+  }
+  virtual const DatasetStats *Stats(void) const {
+    return &stats_;
+  }
+
+ private:
+  // path of the shared file
+  std::string shared_file_;
+  // description of the input and the parser
+  std::string source_;
+  // the input files, compared with the manifest in the shared file
+  std::vector<io::FileInfo> files_;
+  // at head
+  bool at_head_;
+  // the mapped file
+  char *data_;
+  // size of the mapping
+  size_t size_;
+  // maximum feature dimension
+  size_t num_col_;
+  // row block pointing into the mapping
+  RowBlock<IndexType, DType> row_;
+  // statistics of the data
+  DatasetStats stats_;
+  /*! \return size rounded up to the alignment */
+  inline static uint64_t Align(uint64_t size) {
+    return (size + kAlign - 1) / kAlign * kAlign;
+  }
+  /*!
+   * \brief map the shared file if it is complete and built from the same
+   *  source and the same, unchanged input files
+   * \return whether the file is mapped
+   */
+  inline bool Map(void);
+  /*!
+   * \brief parse the input and write the shared file
+   * \param parser the parser over the input
+   */
+  inline void Build(Parser<IndexType, DType> *parser);
+};
+
+#ifndef _WIN32
+template<typename IndexType, typename DType>
+inline bool SharedRowIter<IndexType, DType>::Map(void) {
+  int fd = open(shared_file_.c_str(), O_RDONLY);
+  if (fd == -1) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 ||
+      static_cast<size_t>(st.st_size) < sizeof(SharedRowHeader)) {
+    close(fd);
+    return false;
+  }
+  size_t size = static_cast<size_t>(st.st_size);
+  void *ptr = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (ptr == MAP_FAILED) return false;
+  const char *data = static_cast<const char*>(ptr);
+  SharedRowHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != kMagic || header.version != kVersion ||
+      header.index_bytes != sizeof(IndexType) || header.value_bytes != sizeof(DType) ||
+      header.file_bytes != size ||
+      header.manifest_bytes > size - sizeof(header)) {
+    munmap(ptr, size);
+    return false;
+  }
+  io::CacheManifest manifest;
+  MemoryFixedSizeStream fmanifest(static_cast<char*>(ptr) + sizeof(header),
+                                  header.manifest_bytes);
+  if (!manifest.Load(&fmanifest) || manifest.source != source_) {
+    munmap(ptr, size);
+    return false;
+  }
+  if (!manifest.SameFiles(files_)) {
+    LOG(INFO) << "input of shared row block file " << shared_file_ << " changed, rebuilding";
+    munmap(ptr, size);
+    return false;
+  }
+  data_ = static_cast<char*>(ptr);
+  size_ = size;
+  const uint64_t *begin = header.array_begin;
+  row_.size = header.num_rows;
+  row_.offset = reinterpret_cast<const size_t*>(data + begin[0]);
+  row_.label = begin[1] ? reinterpret_cast<const DType*>(data + begin[1]) : NULL;
+  row_.weight = begin[2] ? reinterpret_cast<const real_t*>(data + begin[2]) : NULL;
+  row_.qid = begin[3] ? reinterpret_cast<const uint64_t*>(data + begin[3]) : NULL;
+  row_.field = begin[4] ? reinterpret_cast<const IndexType*>(data + begin[4]) : NULL;
+  row_.index = reinterpret_cast<const IndexType*>(data + begin[5]);
+  row_.value = begin[6] ? reinterpret_cast<const DType*>(data + begin[6]) : NULL;
+  num_col_ = static_cast<size_t>(header.max_index) + 1;
+  MemoryFixedSizeStream fs(data_ + header.stats_begin, header.stats_bytes);
+  CHECK(stats_.Load(&fs)) << "invalid statistics in " << shared_file_;
+  return true;
+}
+
+template<typename IndexType, typename DType>
+inline void SharedRowIter<IndexType, DType>::Build(Parser<IndexType, DType> *parser) {
+  RowBlockContainer<IndexType, DType> data;
+  DatasetStats stats;
+  double tstart = GetTime();
+  while (parser->Next()) {
+    data.Push(parser->Value());
+    stats.Add(parser->Value());
+  }
+  std::string stats_blob;
+  {
+    MemoryStringStream fs(&stats_blob);
+    stats.Save(&fs);
+  }
+  SharedRowHeader header;
+  std::memset(&header, 0, sizeof(header));
+  header.magic = kMagic;
+  header.version = kVersion;
+  header.index_bytes = sizeof(IndexType);
+  header.value_bytes = sizeof(DType);
+  header.num_rows = data.Size();
+  header.num_nonzero = data.index.size();
+  header.max_index = data.max_index;
+  header.max_field = data.max_field;
+  // the manifest records the input files the data was parsed from
+  io::CacheManifest manifest;
+  manifest.source = source_;
+  for (size_t i = 0; i < files_.size(); ++i) {
+    manifest.files.push_back(io::CacheManifestEntry(files_[i]));
+  }
+  std::string manifest_blob;
+  {
+    MemoryStringStream fs(&manifest_blob);
+    manifest.Save(&fs);
+  }
+  header.manifest_bytes = manifest_blob.length();
+  const void *arrays[SharedRowHeader::kNumArray] = {
+    BeginPtr(data.offset), BeginPtr(data.label), BeginPtr(data.weight),
+    BeginPtr(data.qid), BeginPtr(data.field), BeginPtr(data.index), BeginPtr(data.value)
+  };
+  const uint64_t bytes[SharedRowHeader::kNumArray] = {
+    data.offset.size() * sizeof(size_t), data.label.size() * sizeof(DType),
+    data.weight.size() * sizeof(real_t), data.qid.size() * sizeof(uint64_t),
+    data.field.size() * sizeof(IndexType), data.index.size() * sizeof(IndexType),
+    data.value.size() * sizeof(DType)
+  };
+  uint64_t pos = Align(sizeof(header) + manifest_blob.length());
+  for (int i = 0; i < SharedRowHeader::kNumArray; ++i) {
+    // the offset and index arrays are always present so that the row block is valid
+    if (bytes[i] == 0 && i != 0 && i != 5) continue;
+    header.array_begin[i] = pos;
+    pos = Align(pos + bytes[i]);
+  }
+  header.stats_begin = pos;
+  header.stats_bytes = stats_blob.length();
+  header.file_bytes = pos + stats_blob.length();
+
+  const std::string tmp_file = shared_file_ + ".tmp";
+  {
+    std::unique_ptr<Stream> fo(Stream::Create(tmp_file.c_str(), "w"));
+    const char zeros[kAlign] = {0};
+    uint64_t written = 0;
+    auto write = [&fo, &written, &zeros](const void *ptr, uint64_t begin, uint64_t size) {
+      CHECK_LE(written, begin);
+      fo->Write(zeros, begin - written);
+      if (size != 0) fo->Write(ptr, size);
+      written = begin + size;
+    };
+    write(&header, 0, sizeof(header));
+    write(manifest_blob.data(), sizeof(header), manifest_blob.length());
+    for (int i = 0; i < SharedRowHeader::kNumArray; ++i) {
+      if (header.array_begin[i] != 0) write(arrays[i], header.array_begin[i], bytes[i]);
+    }
+    write(stats_blob.data(), header.stats_begin, header.stats_bytes);
+  }
+  CHECK_EQ(std::rename(tmp_file.c_str(), shared_file_.c_str()), 0)
+      << "cannot rename " << tmp_file << " to " << shared_file_;
+  double tdiff = GetTime() - tstart;
+  LOG(INFO) << "built shared row block file " << shared_file_ << " at "
+            << (parser->BytesRead() >> 20UL) / tdiff << " MB/sec, "
+            << (header.file_bytes >> 20UL) << "MB shared";
+}
+#endif  // _WIN32
+}  // namespace data
+}  // namespace dmlc
+#endif  // DMLC_DATA_SHARED_ROW_ITER_H_
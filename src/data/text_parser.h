@@ -10,6 +10,7 @@
 #include <dmlc/data.h>
 #include <dmlc/omp.h>
 #include <dmlc/common.h>
+#include <dmlc/trace.h>
 #include <thread>
 #include <mutex>
 #include <vector>
@@ -20,16 +21,22 @@
 
 namespace dmlc {
 namespace data {
+template <typename IndexType, typename DType>
+class LazyTextIter;
+
 /*!
  * \brief Text parser that parses the input lines
  * and returns rows in input data
  */
 template <typename IndexType, typename DType = real_t>
 class TextParserBase : public ParserImpl<IndexType, DType> {
+  // parses single lines and line ranges with ParseBlock
+  friend class LazyTextIter<IndexType, DType>;
+
  public:
   explicit TextParserBase(InputSplit *source,
                           int nthread)
-      : bytes_read_(0), source_(source) {
+      : bytes_read_(0), chunk_pos_(0), chunk_begin_(NULL), source_(source) {
     int maxthread = std::max(omp_get_num_procs() / 2 - 4, 1);
     nthread_ = std::min(maxthread, nthread);
   }
@@ -38,6 +45,7 @@ class TextParserBase : public ParserImpl<IndexType, DType> {
   }
   virtual void BeforeFirst(void) {
     source_->BeforeFirst();
+    chunk_pos_ = 0;
   }
   virtual size_t BytesRead(void) const {
     return bytes_read_;
@@ -73,6 +81,16 @@ class TextParserBase : public ParserImpl<IndexType, DType> {
      }
      return begin;
   }
+  /*!
+   * \brief position of the first character of a line in the input of this
+   *  partition, independent of how the input is divided into chunks and threads
+   * \param lbegin beginning of the line, may point to the preceding end of line
+   * \param lend end of the line
+   */
+  inline size_t LinePosition(const char *lbegin, const char *lend) const {
+    while (lbegin != lend && (*lbegin == '\n' || *lbegin == '\r')) ++lbegin;
+    return chunk_pos_ + static_cast<size_t>(lbegin - chunk_begin_);
+  }
   /*!
    * \brief Ignore UTF-8 BOM if present
    * \param begin reference to begin pointer
@@ -99,6 +117,10 @@ class TextParserBase : public ParserImpl<IndexType, DType> {
   int nthread_;
   // number of bytes readed
   size_t bytes_read_;
+  // position of the current chunk in the input since BeforeFirst
+  size_t chunk_pos_;
+  // beginning of the current chunk
+  const char *chunk_begin_;
   // source split that provides the data
   InputSplit *source_;
   // OMPException object to catch and rethrow exceptions in omp blocks
@@ -109,14 +131,19 @@ class TextParserBase : public ParserImpl<IndexType, DType> {
 template <typename IndexType, typename DType>
 inline bool TextParserBase<IndexType, DType>::FillData(
     std::vector<RowBlockContainer<IndexType, DType> > *data) {
+  DMLC_TRACE_SCOPE("TextParser::FillData", "parse");
   InputSplit::Blob chunk;
-  if (!source_->NextChunk(&chunk)) return false;
+  {
+    DMLC_TRACE_SCOPE("TextParser::NextChunk", "io");
+    if (!source_->NextChunk(&chunk)) return false;
+  }
   const int nthread = omp_get_max_threads();
   // reserve space for data
   data->resize(nthread);
   bytes_read_ += chunk.size;
   CHECK_NE(chunk.size, 0U);
   const char *head = reinterpret_cast<char *>(chunk.dptr);
+  chunk_begin_ = head;
 #pragma omp parallel num_threads(nthread)
   {
   omp_exc_.Run([&] {
@@ -132,11 +159,13 @@ inline bool TextParserBase<IndexType, DType>::FillData(
     } else {
       pend = BackFindEndLine(head + send, head);
     }
+    DMLC_TRACE_SCOPE("TextParser::ParseBlock", "parse");
     ParseBlock(pbegin, pend, &(*data)[tid]);
   });
   }
   omp_exc_.Rethrow();
 
+  chunk_pos_ += chunk.size;
   this->data_ptr_ = 0;
   return true;
 }
@@ -3,6 +3,7 @@
 #include <dmlc/base.h>
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
+#include <dmlc/parameter.h>
 #include <cstring>
 #include "io/uri_spec.h"
 #include "io/line_split.h"
@@ -121,7 +122,9 @@ InputSplit* InputSplit::Create(const char *uri_,
   if (spec.cache_file.length() == 0) {
     return new ThreadedInputSplit(split, batch_size);
   } else {
-    return new CachedInputSplit(split, spec.cache_file.c_str());
+    // DMLC_CACHE_MEMORY_MB sets the memory kept for the leading chunks of the cache
+    size_t memory_budget = dmlc::GetEnv("DMLC_CACHE_MEMORY_MB", size_t(0)) << 20UL;
+    return new CachedInputSplit(split, spec.cache_file.c_str(), true, memory_budget);
   }
 #else
   CHECK(spec.cache_file.length() == 0)
@@ -0,0 +1,122 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file cache_manifest.h
+ * \brief manifest of the input files a cache was built from,
+ *  used to detect stale caches and to update them incrementally
+ */
+#ifndef DMLC_IO_CACHE_MANIFEST_H_
+#define DMLC_IO_CACHE_MANIFEST_H_
+
+#include <dmlc/io.h>
+#include <string>
+#include <vector>
+#include "./filesys.h"
+
+namespace dmlc {
+namespace io {
+/*! \brief an input file recorded in a cache manifest */
+struct CacheManifestEntry {
+  /*! \brief path of the file */
+  std::string path;
+  /*! \brief size of the file */
+  uint64_t size;
+  /*! \brief last modification time of the file */
+  int64_t mtime;
+  /*! \brief entity tag of the file */
+  std::string etag;
+  /*! \brief pages of the cache holding the rows of the file */
+  uint64_t page_begin, page_end;
+  /*! \brief bytes of the cache holding the pages of the file */
+  uint64_t byte_begin, byte_end;
+  /*! \brief default constructor */
+  CacheManifestEntry()
+      : size(0), mtime(0), page_begin(0), page_end(0), byte_begin(0), byte_end(0) {}
+  /*! \brief construct from the information of a file */
+  explicit CacheManifestEntry(const FileInfo &info)
+      : path(info.path.str()), size(info.size), mtime(info.mtime), etag(info.etag),
+        page_begin(0), page_end(0), byte_begin(0), byte_end(0) {}
+  /*! \return whether info describes the same, unchanged file */
+  inline bool SameFile(const FileInfo &info) const {
+    return path == info.path.str() && size == info.size &&
+        mtime == info.mtime && etag == info.etag;
+  }
+  /*! \brief save the entry to stream */
+  inline void Save(Stream *fo) const {
+    fo->Write(path);
+    fo->Write(size);
+    fo->Write(mtime);
+    fo->Write(etag);
+    fo->Write(page_begin);
+    fo->Write(page_end);
+    fo->Write(byte_begin);
+    fo->Write(byte_end);
+  }
+  /*! \brief load the entry from stream, return false on a truncated stream */
+  inline bool Load(Stream *fi) {
+    return fi->Read(&path) && fi->Read(&size) && fi->Read(&mtime) &&
+        fi->Read(&etag) && fi->Read(&page_begin) && fi->Read(&page_end) &&
+        fi->Read(&byte_begin) && fi->Read(&byte_end);
+  }
+};
+
+/*!
+ * \brief manifest of a cache: what built it, its size and the input files.
+ *  A cache is stale when the manifest is missing, when its recorded size
+ *  differs from the cache file, or when the input files changed.
+ */
+struct CacheManifest {
+  /*! \brief magic number of the manifest */
+  static const uint32_t kMagic = 0xced7a3f0;
+  /*! \brief description of what built the cache, such as the parser arguments */
+  std::string source;
+  /*! \brief size of the cache file in bytes */
+  uint64_t cache_size;
+  /*! \brief the input files, in the order they are read */
+  std::vector<CacheManifestEntry> files;
+  /*! \brief default constructor */
+  CacheManifest() : cache_size(0) {}
+  /*! \return whether files are the recorded files, all unchanged */
+  inline bool SameFiles(const std::vector<FileInfo> &info) const {
+    return info.size() == files.size() && this->NumUnchanged(info) == files.size();
+  }
+  /*! \return length of the leading recorded files that are unchanged in info */
+  inline size_t NumUnchanged(const std::vector<FileInfo> &info) const {
+    size_t n = 0;
+    while (n < files.size() && n < info.size() && files[n].SameFile(info[n])) ++n;
+    return n;
+  }
+  /*!
+   * \brief find a recorded file that is unchanged in info
+   * \return the index of the recorded file, files.size() if there is none
+   */
+  inline size_t FindUnchanged(const FileInfo &info) const {
+    for (size_t i = 0; i < files.size(); ++i) {
+      if (files[i].SameFile(info)) return i;
+    }
+    return files.size();
+  }
+  /*! \brief save the manifest to stream */
+  inline void Save(Stream *fo) const {
+    const uint32_t magic = kMagic;
+    fo->Write(magic);
+    fo->Write(source);
+    fo->Write(cache_size);
+    fo->Write(static_cast<uint64_t>(files.size()));
+    for (size_t i = 0; i < files.size(); ++i) files[i].Save(fo);
+  }
+  /*! \brief load the manifest from stream, return false if it is not a valid manifest */
+  inline bool Load(Stream *fi) {
+    uint32_t magic;
+    uint64_t nfile;
+    if (!fi->Read(&magic) || magic != kMagic) return false;
+    if (!fi->Read(&source) || !fi->Read(&cache_size) || !fi->Read(&nfile)) return false;
+    files.resize(nfile);
+    for (size_t i = 0; i < files.size(); ++i) {
+      if (!files[i].Load(fi)) return false;
+    }
+    return true;
+  }
+};
+}  // namespace io
+}  // namespace dmlc
+#endif  // DMLC_IO_CACHE_MANIFEST_H_
@@ -14,8 +14,13 @@
 
 #if DMLC_ENABLE_STD_THREAD
 #include <dmlc/threadediter.h>
+#include <atomic>
+#include <cstring>
+#include <memory>
 #include <string>
+#include <vector>
 #include <algorithm>
+#include "./cache_manifest.h"
 #include "./input_split_base.h"
 
 namespace dmlc {
@@ -23,7 +28,13 @@ namespace io {
 /*!
  * \brief InputSplit that reads from an existing InputSplit
  *  and cache the data into local disk, the second iteration
- *  will be reading from the local cached data
+ *  will be reading from the local cached data.
+ *  A manifest of the input files is written next to the cache once it is
+ *  complete, an incomplete cache or one whose input files changed is rebuilt.
+ *
+ *  Given a memory budget, the leading chunks that fit in it are also kept in
+ *  pooled memory blocks, later iterations serve them from memory and read
+ *  only the remaining chunks from the cache file.
  */
 class CachedInputSplit : public InputSplit {
  public:
@@ -32,13 +43,18 @@ class CachedInputSplit : public InputSplit {
    * \param base source input split
    * \param cache_file the path to cache file
    * \param reuse_exist_cache whether reuse existing cache file, if any
+   * \param memory_budget number of bytes of memory reserved for the chunks kept in memory
    */
   CachedInputSplit(InputSplitBase *base,
                    const char *cache_file,
-                   bool reuse_exist_cache = true)
+                   bool reuse_exist_cache = true,
+                   size_t memory_budget = 0)
       : buffer_size_(InputSplitBase::kBufferSize),
         cache_file_(cache_file),
-        fo_(NULL), fi_(NULL),
+        fo_(NULL), fi_(NULL), cache_bytes_(0),
+        memory_budget_(memory_budget), memory_bytes_(0), memory_reserved_(0),
+        memory_sealed_(memory_budget == 0), memory_end_(0), memory_pos_(0),
+        memory_hits_(0), disk_reads_(0),
         base_(base), tmp_chunk_(NULL),
         iter_preproc_(NULL) {
     if (reuse_exist_cache) {
@@ -93,6 +109,27 @@ class CachedInputSplit : public InputSplit {
   virtual size_t GetTotalSize(void) {
     return base_->GetTotalSize();
   }
+  /*! \return number of chunks served from memory */
+  inline size_t MemoryHits(void) const {
+    return memory_hits_;
+  }
+  /*! \return number of chunks read from the cache file after it was built */
+  inline size_t DiskReads(void) const {
+    return disk_reads_;
+  }
+  /*! \return fraction of the chunks served from memory */
+  inline double MemoryHitRate(void) const {
+    size_t hits = memory_hits_, total = hits + disk_reads_;
+    return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+  }
+  /*! \return number of bytes of chunks kept in memory */
+  inline size_t MemoryBytes(void) const {
+    return memory_bytes_;
+  }
+  /*! \return number of bytes reserved by the memory blocks, at most the budget */
+  inline size_t MemoryReservedBytes(void) const {
+    return memory_reserved_;
+  }
   // implement next record
   virtual bool NextRecord(Blob *out_rec) {
     auto *iter = iter_preproc_ != NULL ? iter_preproc_ : &iter_cached_;
@@ -127,6 +164,37 @@ class CachedInputSplit : public InputSplit {
   dmlc::Stream *fo_;
   /*! \brief input stream from cache file */
   dmlc::SeekStream *fi_;
+  /*! \brief number of bytes written to the cache file */
+  size_t cache_bytes_;
+  /*! \brief a chunk kept in memory */
+  struct MemoryChunk {
+    /*! \brief the block holding the chunk */
+    size_t block;
+    /*! \brief offset and size of the chunk in the block */
+    size_t offset, size;
+  };
+  /*! \brief size of the pooled memory blocks, 16MB */
+  static const size_t kMemoryBlockSize = 16UL << 20UL;
+  /*! \brief maximum number of bytes of chunks kept in memory */
+  size_t memory_budget_;
+  /*! \brief number of bytes of chunks kept in memory */
+  size_t memory_bytes_;
+  /*! \brief capacity of the pooled memory blocks, counted against the budget */
+  size_t memory_reserved_;
+  /*! \brief whether a chunk did not fit, later chunks are then not kept */
+  bool memory_sealed_;
+  /*! \brief offset in the cache file of the first chunk not kept in memory */
+  size_t memory_end_;
+  /*! \brief pooled memory blocks */
+  std::vector<std::vector<char> > memory_blocks_;
+  /*! \brief the leading chunks kept in memory */
+  std::vector<MemoryChunk> memory_chunks_;
+  /*! \brief next chunk to serve from memory */
+  size_t memory_pos_;
+  /*! \brief number of chunks served from memory */
+  std::atomic<size_t> memory_hits_;
+  /*! \brief number of chunks read from the cache file */
+  std::atomic<size_t> disk_reads_;
   /*! \brief the place where we get the data */
   InputSplitBase *base_;
   /*! \brief current chunk of data */
@@ -143,10 +211,44 @@ class CachedInputSplit : public InputSplit {
    *  initialization is successful
    */
   inline bool InitCachedIter(void);
+  /*!
+   * \brief keep a chunk in memory if it is still in the leading
+   *  chunks that fit in the memory budget
+   * \param begin beginning of the chunk
+   * \param size size of the chunk
+   */
+  inline void KeepInMemory(const char *begin, size_t size);
+  /*! \return path of the manifest of the cache */
+  inline std::string ManifestFile(void) const {
+    return cache_file_ + ".meta";
+  }
+  /*! \brief write the manifest of the complete cache */
+  inline void SaveManifest(void) const {
+    CacheManifest manifest;
+    manifest.cache_size = cache_bytes_;
+    for (const FileInfo &info : base_->GetFileInfo()) {
+      manifest.files.push_back(CacheManifestEntry(info));
+    }
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(ManifestFile().c_str(), "w"));
+    manifest.Save(fo.get());
+  }
+  /*! \return whether the cache is complete and its input files are unchanged */
+  inline bool CheckManifest(void) const {
+    std::unique_ptr<dmlc::Stream> fi(
+        dmlc::Stream::Create(ManifestFile().c_str(), "r", true));
+    CacheManifest manifest;
+    if (fi == nullptr || !manifest.Load(fi.get())) return false;
+    URI path(cache_file_.c_str());
+    return manifest.SameFiles(base_->GetFileInfo()) &&
+        manifest.cache_size == FileSystem::GetInstance(path)->GetPathInfo(path).size;
+  }
 };
 
 inline void CachedInputSplit:: InitPreprocIter(void) {
+  // drop the old manifest, it is written again once the cache is complete
+  delete dmlc::Stream::Create(ManifestFile().c_str(), "w");
   fo_ = dmlc::Stream::Create(cache_file_.c_str(), "w");
+  cache_bytes_ = 0;
   iter_preproc_ = new ThreadedIter<InputSplitBase::Chunk>();
   iter_preproc_->set_max_capacity(16);
   iter_preproc_->Init([this](InputSplitBase::Chunk **dptr) {
@@ -154,37 +256,99 @@ inline void CachedInputSplit:: InitPreprocIter(void) {
         *dptr = new InputSplitBase::Chunk(buffer_size_);
       }
       auto *p = *dptr;
-      if (!base_->NextChunkEx(p)) return false;
+      if (!base_->NextChunkEx(p)) {
+        this->SaveManifest();
+        return false;
+      }
       // after loading, save to disk
       size_t size = p->end - p->begin;
       fo_->Write(&size, sizeof(size));
       fo_->Write(p->begin, size);
+      cache_bytes_ += sizeof(size) + size;
+      this->KeepInMemory(p->begin, size);
       return true;
     });
 }
 
+inline void CachedInputSplit::KeepInMemory(const char *begin, size_t size) {
+  if (memory_sealed_) return;
+  if (memory_blocks_.empty() ||
+      memory_blocks_.back().capacity() - memory_blocks_.back().size() < size) {
+    const size_t remaining = memory_budget_ - memory_reserved_;
+    if (size > remaining) {
+      // keep only a prefix, so the rest is a contiguous range of the cache file
+      memory_sealed_ = true;
+      return;
+    }
+    // the last block only takes what is left of the budget
+    const size_t max_block_size = kMemoryBlockSize;
+    const size_t block_size = std::min(max_block_size, remaining);
+    memory_blocks_.emplace_back();
+    memory_blocks_.back().reserve(std::max(size, block_size));
+    memory_reserved_ += memory_blocks_.back().capacity();
+  }
+  std::vector<char> &block = memory_blocks_.back();
+  MemoryChunk chunk;
+  chunk.block = memory_blocks_.size() - 1;
+  chunk.offset = block.size();
+  chunk.size = size;
+  block.insert(block.end(), begin, begin + size);
+  memory_chunks_.push_back(chunk);
+  memory_bytes_ += size;
+  memory_end_ += sizeof(size) + size;
+}
+
 inline bool CachedInputSplit::InitCachedIter(void) {
   fi_ = dmlc::SeekStream::CreateForRead(cache_file_.c_str(), true);
   if (fi_ == NULL) return false;
+  if (!this->CheckManifest()) {
+    LOG(INFO) << "cache file " << cache_file_ << " is incomplete or stale, rebuilding";
+    delete fi_;
+    fi_ = NULL;
+    return false;
+  }
+  // the chunks kept in memory are skipped in the cache file
+  fi_->Seek(memory_end_);
+  memory_pos_ = 0;
   iter_cached_.Init([this](InputSplitBase::Chunk **dptr) {
       if (*dptr == NULL) {
         *dptr = new InputSplitBase::Chunk(buffer_size_);
       }
       auto *p = *dptr;
+      if (memory_pos_ < memory_chunks_.size()) {
+        const MemoryChunk &chunk = memory_chunks_[memory_pos_++];
+        p->data.resize(chunk.size / sizeof(uint32_t) + 1);
+        p->begin = reinterpret_cast<char*>(BeginPtr(p->data));
+        p->end = p->begin + chunk.size;
+        std::memcpy(p->begin, BeginPtr(memory_blocks_[chunk.block]) + chunk.offset,
+                    chunk.size);
+        ++memory_hits_;
+        return true;
+      }
       // read data from cache file
       size_t size;
       size_t nread = fi_->Read(&size, sizeof(size));
-      if (nread == 0) return false;
+      if (nread == 0) {
+        memory_sealed_ = true;
+        return false;
+      }
       CHECK(nread == sizeof(size))
           << cache_file_ << " has invalid cache file format";
-      p->data.resize(size / sizeof(size_t) + 1);
+      p->data.resize(size / sizeof(uint32_t) + 1);
       p->begin = reinterpret_cast<char*>(BeginPtr(p->data));
       p->end = p->begin + size;
       CHECK(fi_->Read(p->begin, size) == size)
           << cache_file_ << " has invalid cache file format";
+      ++disk_reads_;
+      // a reused cache file fills the memory during the first iteration
+      this->KeepInMemory(p->begin, size);
+      if (memory_pos_ < memory_chunks_.size()) ++memory_pos_;
       return true;
     },
-    [this]() { fi_->Seek(0); });
+    [this]() {
+      fi_->Seek(memory_end_);
+      memory_pos_ = 0;
+    });
   return true;
 }
 }  // namespace io
@@ -67,8 +67,12 @@ struct FileInfo {
   size_t size;
   /*! \brief the type of the file */
   FileType type;
+  /*! \brief last modification time in seconds since epoch, 0 if unknown */
+  int64_t mtime;
+  /*! \brief entity tag of the object, empty if unknown */
+  std::string etag;
   /*! \brief default constructor */
-  FileInfo() : size(0), type(kFile) {}
+  FileInfo() : size(0), type(kFile), mtime(0) {}
 };
 
 /*! \brief file system system interface */
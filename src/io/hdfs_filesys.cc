@@ -1,5 +1,6 @@
 // Copyright by Contributors
 #include <dmlc/logging.h>
+#include <dmlc/trace.h>
 #include <algorithm>
 #include <limits>
 #include "./hdfs_filesys.h"
@@ -29,6 +30,7 @@ class HDFSStream : public SeekStream {
   }
 
   virtual size_t Read(void *ptr, size_t size) {
+    DMLC_TRACE_SCOPE("HDFSFileSystem::Read", "fs");
     char *buf = static_cast<char*>(ptr);
     size_t nleft = size;
     while (nleft != 0) {
@@ -49,6 +51,7 @@ class HDFSStream : public SeekStream {
   }
 
   virtual void Write(const void *ptr, size_t size) {
+    DMLC_TRACE_SCOPE("HDFSFileSystem::Write", "fs");
     const char *buf = reinterpret_cast<const char*>(ptr);
     while (size != 0) {
       tSize nwrite = hdfsWrite(fs_, fp_, buf, size);
@@ -127,6 +130,7 @@ void HDFSFileSystem::ResetNamenode(const std::string &namenode) {
 inline FileInfo ConvertPathInfo(const URI &path, const hdfsFileInfo &info) {
   FileInfo ret;
   ret.size = info.mSize;
+  ret.mtime = static_cast<int64_t>(info.mLastMod);
   switch (info.mKind) {
     case 'D': ret.type = kDirectory; break;
     case 'F': ret.type = kFile; break;
@@ -166,6 +170,7 @@ void HDFSFileSystem::ListDirectory(const URI &path, std::vector<FileInfo> *out_l
 SeekStream *HDFSFileSystem::Open(const URI &path,
                                  const char* const mode,
                                  bool allow_null) {
+  DMLC_TRACE_SCOPE("HDFSFileSystem::Open", "fs");
   using namespace std;
   int flag = 0;
   if (!strcmp(mode, "r")) {
@@ -1,6 +1,7 @@
 // Copyright by Contributors
 #include <dmlc/logging.h>
 #include <dmlc/common.h>
+#include <dmlc/trace.h>
 #include <algorithm>
 #include "./line_split.h"
 
@@ -93,7 +94,8 @@ std::string InputSplitBase::StripEnd(std::string str, char ch) {
   return str;
 }
 
-std::vector<URI> InputSplitBase::ConvertToURIs(const std::string& uri) {
+std::vector<URI> InputSplitBase::ConvertToURIs(FileSystem *filesys,
+                                               const std::string& uri) {
   // split by :
   const char dlm = ';';
   std::vector<std::string> file_list = Split(uri, dlm);
@@ -109,7 +111,7 @@ std::vector<URI> InputSplitBase::ConvertToURIs(const std::string& uri) {
       URI dir = path;
       dir.name = path.name.substr(0, pos);
       std::vector<FileInfo> dfiles;
-      filesys_->ListDirectory(dir, &dfiles);
+      filesys->ListDirectory(dir, &dfiles);
       bool exact_match = false;
       for (size_t i = 0; i < dfiles.size(); ++i) {
         if (StripEnd(dfiles[i].path.name, '/') == StripEnd(path.name, '/')) {
@@ -146,35 +148,43 @@ std::vector<URI> InputSplitBase::ConvertToURIs(const std::string& uri) {
   return expanded_list;
 }
 
-void InputSplitBase::InitInputFileInfo(const std::string& uri,
-                                       const bool recurse_directories) {
-  std::vector<URI> expanded_list = this->ConvertToURIs(uri);
+void InputSplitBase::ListInputFiles(FileSystem *filesys,
+                                    const std::string& uri,
+                                    const bool recurse_directories,
+                                    std::vector<FileInfo> *out_files) {
+  std::vector<URI> expanded_list = ConvertToURIs(filesys, uri);
   for (size_t i = 0; i < expanded_list.size(); ++i) {
     const URI& path = expanded_list[i];
-    FileInfo info = filesys_->GetPathInfo(path);
+    FileInfo info = filesys->GetPathInfo(path);
     if (info.type == kDirectory) {
       std::vector<FileInfo> dfiles;
       if (!recurse_directories) {
-        filesys_->ListDirectory(info.path, &dfiles);
+        filesys->ListDirectory(info.path, &dfiles);
       } else {
-        filesys_->ListDirectoryRecursive(info.path, &dfiles);
+        filesys->ListDirectoryRecursive(info.path, &dfiles);
       }
       for (size_t i = 0; i < dfiles.size(); ++i) {
         if (dfiles[i].size != 0 && dfiles[i].type == kFile) {
-          files_.push_back(dfiles[i]);
+          out_files->push_back(dfiles[i]);
         }
       }
     } else {
       if (info.size != 0) {
-        files_.push_back(info);
+        out_files->push_back(info);
       }
     }
   }
+}
+
+void InputSplitBase::InitInputFileInfo(const std::string& uri,
+                                       const bool recurse_directories) {
+  ListInputFiles(filesys_, uri, recurse_directories, &files_);
   CHECK_NE(files_.size(), 0U)
       << "Cannot find any files that matches the URI pattern " << uri;
 }
 
 size_t InputSplitBase::Read(void *ptr, size_t size) {
+  DMLC_TRACE_SCOPE("InputSplit::Read", "io");
   const bool is_text_parser = this->IsTextParser();
 
   if (fs_ == NULL) {
@@ -48,6 +48,22 @@ class InputSplitBase : public InputSplit {
   virtual size_t GetTotalSize(void) {
     return file_offset_.back();
   }
+  /*! \return the input files, in the order they are read */
+  const std::vector<FileInfo> &GetFileInfo(void) const {
+    return files_;
+  }
+  /*!
+   * \brief list the non-empty files an uri refers to, in the order
+   *  an input split over the uri reads them
+   * \param filesys the filesystem of the uri
+   * \param uri the uri, a ';' separated list of files, directories or patterns
+   * \param recurse_directories recursively travese directories
+   * \param out_files the files are appended to it
+   */
+  static void ListInputFiles(FileSystem *filesys,
+                             const std::string& uri,
+                             const bool recurse_directories,
+                             std::vector<FileInfo> *out_files);
   // implement next record
   virtual bool NextRecord(Blob *out_rec) {
     while (!ExtractNextRecord(out_rec, &tmp_chunk_)) {
@@ -177,7 +193,9 @@ class InputSplitBase : public InputSplit {
   FindLastRecordBegin(const char *begin, const char *end) = 0;
 
   /*! \brief split string list of files into vector of URIs */
-  std::vector<URI> ConvertToURIs(const std::string& uri);
+  std::vector<URI> ConvertToURIs(const std::string& uri) {
+    return ConvertToURIs(filesys_, uri);
+  }
   /*! \brief same as stream.Read */
   size_t Read(void *ptr, size_t size);
 
@@ -189,8 +207,10 @@ class InputSplitBase : public InputSplit {
   /*! \brief initialize information in files */
   void InitInputFileInfo(const std::string& uri,
                          const bool recurse_directories);
+  /*! \brief split string list of files into vector of URIs */
+  static std::vector<URI> ConvertToURIs(FileSystem *filesys, const std::string& uri);
   /*! \brief strip continous chars in the end of str */
-  std::string StripEnd(std::string str, char ch);
+  static std::string StripEnd(std::string str, char ch);
 };
 }  // namespace io
 }  // namespace dmlc
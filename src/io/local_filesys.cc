@@ -2,6 +2,7 @@
 
 #include <dmlc/base.h>
 #include <dmlc/logging.h>
+#include <dmlc/trace.h>
 #include <errno.h>
 extern "C" {
 #include <sys/stat.h>
@@ -32,9 +33,11 @@ class FileStream : public SeekStream {
     this->Close();
   }
   virtual size_t Read(void *ptr, size_t size) {
+    DMLC_TRACE_SCOPE("LocalFileSystem::Read", "fs");
     return std::fread(ptr, 1, size, fp_);
   }
   virtual void Write(const void *ptr, size_t size) {
+    DMLC_TRACE_SCOPE("LocalFileSystem::Write", "fs");
     CHECK(std::fwrite(ptr, 1, size, fp_) == size)
         << "FileStream.Write incomplete";
   }
@@ -87,6 +90,7 @@ FileInfo LocalFileSystem::GetPathInfo(const URI &path) {
                << path.name << " error: " << strerror(errsv);
   }
   ret.size = sb.st_size;
+  ret.mtime = static_cast<int64_t>(sb.st_mtime);
 
   if ((sb.st_mode & S_IFMT) == S_IFDIR) {
     ret.type = kDirectory;
@@ -147,6 +151,7 @@ void LocalFileSystem::ListDirectory(const URI &path, std::vector<FileInfo> *out_
 SeekStream *LocalFileSystem::Open(const URI &path,
                                   const char* const mode,
                                   bool allow_null) {
+  DMLC_TRACE_SCOPE("LocalFileSystem::Open", "fs");
   bool use_stdio = false;
   FILE *fp = NULL;
 #ifdef _WIN32
@@ -174,6 +179,7 @@ SeekStream *LocalFileSystem::Open(const URI &path,
     std::wstring flag(wmode.c_str());
     if (flag == L"w") flag = L"wb";
     if (flag == L"r") flag = L"rb";
+    if (flag == L"a") flag = L"ab";
 #if DMLC_USE_FOPEN64
     fp = _wfopen(fname.c_str(), flag.c_str());
 #else  // DMLC_USE_FOPEN64
@@ -196,6 +202,7 @@ SeekStream *LocalFileSystem::Open(const URI &path,
     std::string flag = mode;
     if (flag == "w") flag = "wb";
     if (flag == "r") flag = "rb";
+    if (flag == "a") flag = "ab";
 #if DMLC_USE_FOPEN64
     fp = fopen64(fname, flag.c_str());
 #else  // DMLC_USE_FOPEN64
@@ -8,6 +8,7 @@ extern "C" {
 }
 #include <dmlc/io.h>
 #include <dmlc/logging.h>
+#include <dmlc/trace.h>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -496,6 +497,7 @@ class CURLReadStreamBase : public SeekStream {
 
 // read data in
 size_t CURLReadStreamBase::Read(void *ptr, size_t size) {
+  DMLC_TRACE_SCOPE("S3FileSystem::Read", "fs");
   // lazy initialize
   if (mcurl_ == NULL) Init(curr_bytes_);
   // check at end
@@ -864,6 +866,7 @@ class WriteStream : public Stream {
 };
 
 void WriteStream::Write(const void *ptr, size_t size) {
+  DMLC_TRACE_SCOPE("S3FileSystem::Write", "fs");
   size_t rlen = buffer_.length();
   buffer_.resize(rlen + size);
   std::memcpy(BeginPtr(buffer_) + rlen, ptr, size);
@@ -1122,6 +1125,8 @@ void S3FileSystem::ListObjects(const URI &path, std::vector<FileInfo> *out_list)
         CHECK(data.GetNext("Key", &value));
         // add root path to be consistent with other filesys convention
         info.path.name = '/' + value.str();
+        XMLIter fields = data;
+        if (fields.GetNext("ETag", &value)) info.etag = value.str();
         CHECK(data.GetNext("Size", &value));
         info.size = static_cast<size_t>(atol(value.str().c_str()));
         info.type = kFile;
@@ -1289,6 +1294,7 @@ Stream *S3FileSystem::Open(const URI &path, const char* const flag, bool allow_n
 }
 
 SeekStream *S3FileSystem::OpenForRead(const URI &path, bool allow_null) {
+  DMLC_TRACE_SCOPE("S3FileSystem::OpenForRead", "fs");
   // simple http read stream
   if (!allow_null && (path.protocol == "http://"|| path.protocol == "https://")) {
     return new s3::HttpReadStream(path);
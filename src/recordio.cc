@@ -3,6 +3,7 @@
 #include <dmlc/base.h>
 #include <dmlc/recordio.h>
 #include <dmlc/logging.h>
+#include <dmlc/trace.h>
 #include <algorithm>
 
 
@@ -51,6 +52,7 @@ void RecordIOWriter::WriteRecord(const void *buf, size_t size) {
 }
 
 bool RecordIOReader::NextRecord(std::string *out_rec) {
+  DMLC_TRACE_SCOPE("RecordIOReader::NextRecord", "io");
   if (end_of_stream_) return false;
   const uint32_t kMagic = RecordIOWriter::kMagic;
   out_rec->clear();
@@ -0,0 +1,169 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file trace.cc
+ * \brief the global tracer and its Chrome trace event output
+ */
+#include <dmlc/trace.h>
+#include <dmlc/json.h>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#else
+#include <unistd.h>
+#endif  // _WIN32
+
+namespace dmlc {
+namespace {
+/*! \brief a recorded scope as a complete event of the Chrome trace event format */
+struct ChromeTraceEvent {
+  Tracer::Event event;
+  double origin;
+  int pid;
+  int tid;
+  void Save(JSONWriter *writer) const {
+    writer->BeginObject(false);
+    writer->WriteObjectKeyValue("name", std::string(event.name));
+    writer->WriteObjectKeyValue("cat", std::string(event.category));
+    writer->WriteObjectKeyValue("ph", std::string("X"));
+    writer->WriteObjectKeyValue("ts", (event.begin - origin) * 1e6);
+    writer->WriteObjectKeyValue("dur", (event.end - event.begin) * 1e6);
+    writer->WriteObjectKeyValue("pid", pid);
+    writer->WriteObjectKeyValue("tid", tid);
+    writer->EndObject();
+  }
+};
+}  // namespace
+
+Tracer *Tracer::Get() {
+  // never destroyed so that scopes closing in static destructors stay valid
+  static Tracer *inst = new Tracer();
+  return inst;
+}
+
+void Tracer::Start() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // the threads discard the events of the previous run on their next record
+  epoch_.fetch_add(1, std::memory_order_release);
+  this->RetireExited();
+  dropped_.store(0, std::memory_order_relaxed);
+  origin_ = GetMonotonicTime();
+  recording_.store(true, std::memory_order_release);
+}
+
+void Tracer::Stop() {
+  recording_.store(false, std::memory_order_release);
+}
+
+void Tracer::Record(const char *name, const char *category, double begin, double end) {
+  if (!this->IsRecording()) return;
+  Buffer *buffer = this->LocalBuffer();
+  const uint64_t epoch = epoch_.load(std::memory_order_acquire);
+  size_t size = buffer->size.load(std::memory_order_relaxed);
+  if (buffer->epoch.load(std::memory_order_relaxed) != epoch) {
+    // readers that see the new epoch see the reset size too
+    size = 0;
+    buffer->size.store(0, std::memory_order_relaxed);
+    buffer->epoch.store(epoch, std::memory_order_release);
+  }
+  if (size >= kMaxEventsPerThread) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  std::unique_ptr<Event[]> &chunk = buffer->chunks[size / kEventsPerChunk];
+  if (chunk == nullptr) chunk.reset(new Event[kEventsPerChunk]);
+  Event &event = chunk[size % kEventsPerChunk];
+  event.name = name;
+  event.category = category;
+  event.begin = begin;
+  event.end = end;
+  buffer->size.store(size + 1, std::memory_order_release);
+}
+
+size_t Tracer::NumEvents() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t num_events = 0;
+  for (size_t i = 0; i < buffers_.size(); ++i) {
+    num_events += this->NumLiveEvents(*buffers_[i]);
+  }
+  return num_events;
+}
+
+void Tracer::Dump(std::ostream *os) {
+#ifdef _WIN32
+  const int pid = _getpid();
+#else
+  const int pid = static_cast<int>(getpid());
+#endif  // _WIN32
+  std::vector<ChromeTraceEvent> trace;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      const Buffer &buffer = *buffers_[i];
+      const size_t num_events = this->NumLiveEvents(buffer);
+      for (size_t j = 0; j < num_events; ++j) {
+        ChromeTraceEvent e;
+        e.event = buffer.chunks[j / kEventsPerChunk][j % kEventsPerChunk];
+        e.origin = origin_;
+        e.pid = pid;
+        e.tid = buffer.tid;
+        trace.push_back(e);
+      }
+    }
+  }
+  // timestamps are in microseconds, keep sub-microsecond digits
+  const std::streamsize precision = os->precision(3);
+  const std::ios_base::fmtflags flags = os->setf(std::ios::fixed, std::ios::floatfield);
+  JSONWriter writer(os);
+  writer.BeginObject();
+  writer.WriteObjectKeyValue("displayTimeUnit", std::string("ms"));
+  writer.WriteObjectKeyValue("droppedEvents", this->NumDropped());
+  writer.WriteObjectKeyValue("traceEvents", trace);
+  writer.EndObject();
+  os->flags(flags);
+  os->precision(precision);
+}
+
+Tracer::Buffer *Tracer::LocalBuffer() {
+  // marks the buffer when the thread exits, so that it can be retired
+  struct LocalHandle {
+    std::shared_ptr<Buffer> buffer;
+    ~LocalHandle() {
+      if (buffer != nullptr) buffer->exited.store(true, std::memory_order_release);
+    }
+  };
+  static thread_local LocalHandle local;
+  if (local.buffer == nullptr) {
+    local.buffer = std::make_shared<Buffer>();
+    local.buffer->epoch.store(epoch_.load(std::memory_order_acquire),
+                              std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mutex_);
+    this->RetireExited();
+    local.buffer->tid = next_tid_++;
+    buffers_.push_back(local.buffer);
+  }
+  return local.buffer.get();
+}
+
+size_t Tracer::NumLiveEvents(const Buffer &buffer) const {
+  // epoch_ only changes under mutex_, so the run cannot end while reading
+  if (buffer.epoch.load(std::memory_order_acquire) !=
+      epoch_.load(std::memory_order_relaxed)) {
+    return 0;
+  }
+  return buffer.size.load(std::memory_order_acquire);
+}
+
+void Tracer::RetireExited() {
+  for (size_t i = 0; i < buffers_.size();) {
+    if (buffers_[i]->exited.load(std::memory_order_acquire) &&
+        this->NumLiveEvents(*buffers_[i]) == 0) {
+      buffers_[i] = buffers_.back();
+      buffers_.pop_back();
+    } else {
+      ++i;
+    }
+  }
+}
+}  // namespace dmlc
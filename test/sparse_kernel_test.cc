@@ -0,0 +1,67 @@
+// benchmark the batched sparse kernels against the row by row SDot
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <dmlc/data.h>
+#include <dmlc/timer.h>
+#include <dmlc/sparse_kernel.h>
+
+int main(int argc, char *argv[]) {
+  if (argc < 4) {
+    printf("Usage: <nrow> <ncol> <nnz_per_row> [nrepeat]\n");
+    return 0;
+  }
+  using namespace dmlc;
+  size_t nrow = std::strtoul(argv[1], NULL, 10);
+  size_t ncol = std::strtoul(argv[2], NULL, 10);
+  size_t len = std::strtoul(argv[3], NULL, 10);
+  int nrepeat = argc > 4 ? atoi(argv[4]) : 10;
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<uint32_t> col(0, static_cast<uint32_t>(ncol - 1));
+  std::vector<size_t> offset(1, 0);
+  std::vector<uint32_t> index;
+  std::vector<float> value, label(nrow), w(ncol, 0.5f), out(nrow), grad(ncol);
+  for (size_t i = 0; i < nrow; ++i) {
+    for (size_t j = 0; j < len; ++j) {
+      index.push_back(col(rng));
+      value.push_back(1.0f);
+    }
+    offset.push_back(index.size());
+  }
+  RowBlock<uint32_t> batch;
+  batch.size = nrow;
+  batch.offset = offset.data();
+  batch.label = label.data();
+  batch.weight = NULL;
+  batch.qid = NULL;
+  batch.field = NULL;
+  batch.index = index.data();
+  batch.value = value.data();
+  double nnz = static_cast<double>(index.size()) * nrepeat;
+
+  double tstart = GetTime();
+  for (int r = 0; r < nrepeat; ++r) {
+    for (size_t i = 0; i < nrow; ++i) {
+      out[i] = batch[i].SDot(w.data(), ncol);
+    }
+  }
+  double tdiff = GetTime() - tstart;
+  printf("SDot:            %g Mnnz/sec\n", nnz / tdiff / 1e6);
+
+  for (int nthread = 1; nthread <= 2; ++nthread) {
+    tstart = GetTime();
+    for (int r = 0; r < nrepeat; ++r) {
+      SpMV(batch, w.data(), ncol, out.data(), nthread == 1 ? 1 : 0);
+    }
+    tdiff = GetTime() - tstart;
+    printf("SpMV[%s]:      %g Mnnz/sec\n", nthread == 1 ? "1" : "n", nnz / tdiff / 1e6);
+    tstart = GetTime();
+    for (int r = 0; r < nrepeat; ++r) {
+      SpMVTrans(batch, out.data(), ncol, grad.data(), nthread == 1 ? 1 : 0);
+    }
+    tdiff = GetTime() - tstart;
+    printf("SpMVTrans[%s]: %g Mnnz/sec\n", nthread == 1 ? "1" : "n", nnz / tdiff / 1e6);
+  }
+  return 0;
+}
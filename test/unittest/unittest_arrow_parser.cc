@@ -0,0 +1,105 @@
+#include <dmlc/data.h>
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include "./build_config.h"
+
+namespace {
+// sample.arrow holds rows r = 0..11 in record batches of 4, 3 and 5 rows, columns
+//   label: r % 2, name: string, a: int32 r * 10 or null when r % 3 == 0,
+//   tags: list<int64>, b: float64 0 when r % 4 == 0 else r + 0.5,
+//   c: bool r % 2, d: float16 r / 4, e: uint8 r, w: float32 r + 1
+const char *kSample = CMAKE_CURRENT_SOURCE_DIR "/sample.arrow";
+// dictionary_union.arrow holds rows r = 0..5 in record batches of 3 rows, columns
+//   cat: dictionary<string, int32>, x: float64 r * 1.5, u: sparse_union<int32, string>,
+//   y: int32 r * 10, v: dense_union<float64, string>, z: float32 r + 0.25,
+// dictionary_union_v4.arrow holds the same data in metadata version V4
+const char *kDictUnion = CMAKE_CURRENT_SOURCE_DIR "/dictionary_union.arrow";
+const char *kDictUnionV4 = CMAKE_CURRENT_SOURCE_DIR "/dictionary_union_v4.arrow";
+
+// read all rows as maps from feature index to value
+size_t ReadRows(const char *file, const std::string &args,
+                unsigned part, unsigned nparts,
+                std::vector<std::map<uint32_t, float> > *rows,
+                std::vector<float> *labels, std::vector<float> *weights) {
+  std::unique_ptr<dmlc::Parser<uint32_t> > parser(dmlc::Parser<uint32_t>::Create(
+      (std::string(file) + "?format=arrow" + args).c_str(), part, nparts, "auto"));
+  size_t nrow = 0;
+  while (parser->Next()) {
+    const dmlc::RowBlock<uint32_t> &batch = parser->Value();
+    for (size_t i = 0; i < batch.size; ++i, ++nrow) {
+      dmlc::Row<uint32_t> r = batch[i];
+      std::map<uint32_t, float> row;
+      for (size_t j = 0; j < r.length; ++j) row[r.get_index(j)] = r.get_value(j);
+      rows->push_back(row);
+      labels->push_back(r.get_label());
+      weights->push_back(r.get_weight());
+    }
+  }
+  return nrow;
+}
+}  // namespace
+
+TEST(ArrowParser, dense) {
+  std::vector<std::map<uint32_t, float> > rows;
+  std::vector<float> labels, weights;
+  ASSERT_EQ(ReadRows(kSample, "&label_column=0&weight_column=8", 0, 1,
+                     &rows, &labels, &weights), 12U);
+  for (size_t r = 0; r < rows.size(); ++r) {
+    EXPECT_EQ(labels[r], static_cast<float>(r % 2));
+    EXPECT_EQ(weights[r], static_cast<float>(r + 1));
+    std::map<uint32_t, float> expect;
+    if (r % 3 != 0) expect[0] = r * 10.0f;
+    expect[1] = r % 4 == 0 ? 0.0f : r + 0.5f;
+    expect[2] = static_cast<float>(r % 2);
+    expect[3] = r * 0.25f;
+    expect[4] = static_cast<float>(r);
+    EXPECT_EQ(rows[r], expect);
+  }
+}
+
+TEST(ArrowParser, sparse_and_partition) {
+  std::vector<std::map<uint32_t, float> > all, parts;
+  std::vector<float> labels, weights;
+  ReadRows(kSample, "&label_column=0&weight_column=8&sparse=1", 0, 1, &all, &labels, &weights);
+  for (size_t r = 0; r < all.size(); ++r) {
+    for (const auto &kv : all[r]) EXPECT_NE(kv.second, 0.0f);
+  }
+  EXPECT_EQ(all[0].size(), 0U);
+  EXPECT_EQ(all[5].size(), 5U);
+  // each part gets one record batch
+  const size_t expect_rows[] = {4, 3, 5};
+  for (unsigned part = 0; part < 3; ++part) {
+    EXPECT_EQ(ReadRows(kSample, "&label_column=0&weight_column=8&sparse=1", part, 3,
+                       &parts, &labels, &weights), expect_rows[part]);
+  }
+  EXPECT_EQ(parts, all);
+}
+
+TEST(ArrowParser, no_label) {
+  std::vector<std::map<uint32_t, float> > rows;
+  std::vector<float> labels, weights;
+  ASSERT_EQ(ReadRows(kSample, "", 0, 1, &rows, &labels, &weights), 12U);
+  // label and weight columns become features 0 and 6
+  EXPECT_EQ(rows[5].size(), 7U);
+  EXPECT_EQ(rows[5][0], 1.0f);
+  EXPECT_EQ(rows[5][6], 6.0f);
+  EXPECT_EQ(labels[5], 0.0f);
+}
+
+TEST(ArrowParser, dictionary_and_union) {
+  for (const char *file : {kDictUnion, kDictUnionV4}) {
+    std::vector<std::map<uint32_t, float> > rows;
+    std::vector<float> labels, weights;
+    ASSERT_EQ(ReadRows(file, "&label_column=3", 0, 1, &rows, &labels, &weights), 6U) << file;
+    for (size_t r = 0; r < rows.size(); ++r) {
+      EXPECT_EQ(labels[r], r * 10.0f);
+      std::map<uint32_t, float> expect;
+      expect[0] = r * 1.5f;
+      expect[1] = r + 0.25f;
+      EXPECT_EQ(rows[r], expect);
+    }
+  }
+}
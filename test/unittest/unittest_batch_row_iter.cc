@@ -0,0 +1,129 @@
+#include "../src/data/batch_row_iter.h"
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dmlc;
+using namespace dmlc::data;
+
+namespace {
+// iterator that replays a list of blocks, row i has i % 5 entries with index i
+class BlockListIter : public DataIter<RowBlock<uint32_t> > {
+ public:
+  BlockListIter(size_t nrow, size_t rows_per_block) {
+    for (size_t begin = 0; begin < nrow; begin += rows_per_block) {
+      RowBlockContainer<uint32_t> c;
+      for (size_t i = begin; i < std::min(nrow, begin + rows_per_block); ++i) {
+        c.label.push_back(static_cast<real_t>(i));
+        for (size_t j = 0; j < i % 5; ++j) {
+          c.index.push_back(static_cast<uint32_t>(i));
+          c.value.push_back(static_cast<real_t>(j));
+        }
+        c.offset.push_back(c.index.size());
+      }
+      blocks_.push_back(c);
+    }
+    this->BeforeFirst();
+  }
+  virtual void BeforeFirst(void) {
+    pos_ = 0;
+  }
+  virtual bool Next(void) {
+    if (pos_ == blocks_.size()) return false;
+    value_ = blocks_[pos_++].GetBlock();
+    return true;
+  }
+  virtual const RowBlock<uint32_t> &Value(void) const {
+    return value_;
+  }
+
+ private:
+  std::vector<RowBlockContainer<uint32_t> > blocks_;
+  size_t pos_;
+  RowBlock<uint32_t> value_;
+};
+
+// check that the batches cover all rows in order, return number of batches
+size_t CheckBatches(RowBlockIter<uint32_t> *iter, size_t nrow,
+                    size_t max_rows, size_t max_nnz) {
+  size_t row = 0, nbatch = 0;
+  while (iter->Next()) {
+    const RowBlock<uint32_t> &batch = iter->Value();
+    size_t nnz = batch.offset[batch.size] - batch.offset[0];
+    EXPECT_GT(batch.size, 0U);
+    if (max_rows != 0) {
+      EXPECT_LE(batch.size, max_rows);
+    }
+    if (max_nnz != 0 && batch.size > 1) {
+      EXPECT_LE(nnz, max_nnz);
+    }
+    for (size_t i = 0; i < batch.size; ++i, ++row) {
+      Row<uint32_t> r = batch[i];
+      EXPECT_EQ(r.get_label(), static_cast<real_t>(row));
+      EXPECT_EQ(r.length, row % 5);
+      for (size_t j = 0; j < r.length; ++j) {
+        EXPECT_EQ(r.get_index(j), row);
+        EXPECT_EQ(r.get_value(j), static_cast<real_t>(j));
+      }
+    }
+    ++nbatch;
+  }
+  EXPECT_EQ(row, nrow);
+  return nbatch;
+}
+}  // namespace
+
+TEST(BatchRowIter, row_budget) {
+  BatchRowIter<uint32_t> iter(new BlockListIter(103, 10), 7, 0, 0);
+  for (int epoch = 0; epoch < 2; ++epoch) {
+    iter.BeforeFirst();
+    EXPECT_EQ(CheckBatches(&iter, 103, 7, 0), 15U);
+  }
+  EXPECT_EQ(iter.NumCol(), 103U);
+}
+
+TEST(BatchRowIter, nnz_budget) {
+  BatchRowIter<uint32_t> iter(new BlockListIter(100, 9), 0, 6, 0);
+  CheckBatches(&iter, 100, 0, 6);
+  // rows with 4 entries exceed a budget of 3 on their own
+  BatchRowIter<uint32_t> tight(new BlockListIter(100, 9), 0, 3, 0);
+  CheckBatches(&tight, 100, 0, 3);
+}
+
+TEST(BatchRowIter, byte_budget) {
+  const size_t max_bytes = 256;
+  BatchRowIter<uint32_t> iter(new BlockListIter(100, 13), 0, 0, max_bytes);
+  while (iter.Next()) {
+    const RowBlock<uint32_t> &batch = iter.Value();
+    if (batch.size > 1) {
+      size_t nnz = batch.offset[batch.size] - batch.offset[0];
+      size_t bytes = batch.size * (sizeof(size_t) + sizeof(real_t)) +
+          nnz * (sizeof(uint32_t) + sizeof(real_t));
+      EXPECT_LE(bytes, max_bytes);
+    }
+  }
+  iter.BeforeFirst();
+  CheckBatches(&iter, 100, 0, 0);
+}
+
+TEST(BatchRowIter, uri_args) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(path.c_str());
+    for (size_t i = 0; i < 50; ++i) {
+      of << i;
+      for (size_t j = 0; j < i % 5; ++j) of << " " << i << ":" << j;
+      of << "\n";
+    }
+  }
+  std::unique_ptr<RowBlockIter<uint32_t> > iter(
+      RowBlockIter<uint32_t>::Create((path + "?format=libsvm&batch_rows=8").c_str(),
+                                     0, 1, "auto"));
+  EXPECT_EQ(CheckBatches(iter.get(), 50, 8, 0), 7U);
+  EXPECT_EQ(iter->NumCol(), 50U);
+}
@@ -0,0 +1,165 @@
+#include "../src/data/compact_row_block.h"
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/memory_io.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace dmlc;
+using namespace dmlc::data;
+
+TEST(CompactRowBlock, half_conversion) {
+  EXPECT_EQ(FloatToHalf(0.0f), 0x0000);
+  EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+  EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+  EXPECT_EQ(FloatToHalf(65504.0f), 0x7bff);
+  EXPECT_EQ(FloatToHalf(1e6f), 0x7c00);
+  EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -24)), 0x0001);
+  EXPECT_EQ(FloatToHalf(std::ldexp(1.0f, -26)), 0x0000);
+  // every finite half survives a round trip
+  for (uint32_t h = 0; h < 0x10000U; ++h) {
+    if ((h & 0x7c00U) == 0x7c00U) continue;
+    EXPECT_EQ(FloatToHalf(HalfToFloat(static_cast<uint16_t>(h))), h);
+  }
+  EXPECT_EQ(FloatToBFloat16(1.0f), 0x3f80);
+  EXPECT_EQ(BFloat16ToFloat(FloatToBFloat16(-3.5f)), -3.5f);
+}
+
+TEST(CompactRowBlock, encode_decode) {
+  std::mt19937 rng(0);
+  std::uniform_real_distribution<float> dist(-4.0f, 4.0f);
+  RowBlockContainer<uint32_t> data;
+  for (size_t i = 0; i < 1000; ++i) {
+    for (size_t j = 0; j < i % 7; ++j) {
+      data.index.push_back(static_cast<uint32_t>(i * 3 + j));
+      data.value.push_back(dist(rng));
+      data.max_index = std::max(data.max_index, data.index.back());
+    }
+    data.label.push_back(static_cast<real_t>(i % 2));
+    data.offset.push_back(data.index.size());
+  }
+  const int formats[] = {kValueNative, kValueFloat16, kValueBFloat16, kValueUInt8};
+  const float tolerance[] = {0.0f, 4.0f / 1024, 4.0f / 128, 8.0f / 255};
+  for (int k = 0; k < 4; ++k) {
+    CompactRowBlock<uint32_t> page, loaded;
+    page.Encode(data, formats[k]);
+    EXPECT_EQ(page.value.size(),
+              data.value.size() * ValueFormatBytes(formats[k], sizeof(real_t)));
+    std::string blob;
+    MemoryStringStream fs(&blob);
+    page.Save(&fs);
+    fs.Seek(0);
+    ASSERT_TRUE(loaded.Load(&fs));
+    RowBlockContainer<uint32_t> out;
+    loaded.Decode(&out);
+    EXPECT_EQ(out.offset, data.offset);
+    EXPECT_EQ(out.index, data.index);
+    EXPECT_EQ(out.label, data.label);
+    EXPECT_EQ(out.max_index, data.max_index);
+    ASSERT_EQ(out.value.size(), data.value.size());
+    for (size_t i = 0; i < data.value.size(); ++i) {
+      EXPECT_NEAR(out.value[i], data.value[i], tolerance[k]);
+    }
+  }
+  // binary values are exact under 8-bit quantization
+  for (size_t i = 0; i < data.value.size(); ++i) {
+    data.value[i] = static_cast<real_t>(i % 2);
+  }
+  CompactRowBlock<uint32_t> page;
+  page.Encode(data, kValueUInt8);
+  RowBlockContainer<uint32_t> out;
+  page.Decode(&out);
+  EXPECT_EQ(out.value, data.value);
+}
+
+TEST(CompactRowBlock, row_iter) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(path.c_str());
+    for (size_t i = 0; i < 100; ++i) {
+      of << i % 2;
+      for (size_t j = 0; j < 4; ++j) of << " " << i + j << ":" << 0.25 * j;
+      of << "\n";
+    }
+  }
+  const std::string cache = tempdir.path + "/train.cache";
+  {
+    // a cache of an unknown format is rebuilt
+    std::ofstream of(cache.c_str());
+    of << "stale";
+  }
+  const std::string uris[] = {
+    path + "?value_format=float16",
+    path + "?compact_index=1",
+    path + "?value_format=bfloat16#" + cache,
+    path + "?value_format=bfloat16#" + cache,
+    path + "#" + cache
+  };
+  for (const std::string &uri : uris) {
+    std::unique_ptr<RowBlockIter<uint32_t> > iter(
+        RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+    size_t nrow = 0;
+    while (iter->Next()) {
+      const RowBlock<uint32_t> &batch = iter->Value();
+      for (size_t i = 0; i < batch.size; ++i, ++nrow) {
+        Row<uint32_t> r = batch[i];
+        EXPECT_EQ(r.get_label(), static_cast<real_t>(nrow % 2));
+        ASSERT_EQ(r.length, 4U);
+        for (size_t j = 0; j < 4; ++j) {
+          EXPECT_EQ(r.get_index(j), nrow + j);
+          EXPECT_EQ(r.get_value(j), 0.25f * j);
+        }
+      }
+    }
+    EXPECT_EQ(nrow, 100U);
+  }
+}
+
+TEST(CompactRowBlock, narrow_index) {
+  RowBlockContainer<uint64_t> data;
+  const uint64_t base = 1ULL << 40;
+  for (size_t i = 0; i < 300; ++i) {
+    data.index.push_back(base + i * 7);
+    data.field.push_back(i % 3);
+    data.value.push_back(1.0f);
+    data.label.push_back(0.0f);
+    data.offset.push_back(data.index.size());
+    data.max_index = std::max(data.max_index, data.index.back());
+    data.max_field = std::max(data.max_field, data.field.back());
+  }
+  CompactRowBlock<uint64_t> page;
+  page.Encode(data, kValueNative);
+  // indices span 2100 values above a large base
+  EXPECT_EQ(page.index.width, 2U);
+  EXPECT_EQ(page.index.base, base);
+  EXPECT_EQ(page.field.width, 1U);
+  EXPECT_EQ(page.offset.width, 2U);
+  EXPECT_LT(page.MemCostBytes() * 2, data.MemCostBytes());
+  std::string blob;
+  MemoryStringStream fs(&blob);
+  page.Save(&fs);
+  fs.Seek(0);
+  CompactRowBlock<uint64_t> loaded;
+  ASSERT_TRUE(loaded.Load(&fs));
+  RowBlockContainer<uint64_t> out;
+  loaded.Decode(&out);
+  EXPECT_EQ(out.offset, data.offset);
+  EXPECT_EQ(out.index, data.index);
+  EXPECT_EQ(out.field, data.field);
+  EXPECT_EQ(out.max_index, data.max_index);
+  EXPECT_EQ(out.max_field, data.max_field);
+  // a slice is encoded relative to its own first row
+  page.Encode(data.GetBlock().Slice(100, 200), kValueNative);
+  EXPECT_EQ(page.Size(), 100U);
+  EXPECT_EQ(page.index.base, base + 700);
+  EXPECT_EQ(page.offset.width, 1U);
+  page.Decode(&out);
+  EXPECT_EQ(out.offset.back(), 100U);
+  EXPECT_EQ(out.index[0], base + 700);
+}
@@ -0,0 +1,124 @@
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/memory_io.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+TEST(DatasetStats, add) {
+  std::vector<size_t> offset = {0, 2, 3, 6};
+  std::vector<float> label = {1.0f, 0.0f, 1.0f};
+  std::vector<uint64_t> index = {3, 1ULL << 40, 3, 7, 1ULL << 40, 5};
+  std::vector<uint64_t> field = {0, 1, 0, 2, 1, 0};
+  dmlc::RowBlock<uint64_t> batch;
+  batch.size = 3;
+  batch.offset = offset.data();
+  batch.label = label.data();
+  batch.weight = NULL;
+  batch.qid = NULL;
+  batch.field = field.data();
+  batch.index = index.data();
+  batch.value = NULL;
+  dmlc::DatasetStats stats;
+  stats.Add(batch);
+  stats.Add(batch.Slice(1, 3));
+  EXPECT_EQ(stats.num_row, 5U);
+  EXPECT_EQ(stats.num_nonzero, 10U);
+  EXPECT_EQ(stats.num_col, (1ULL << 40) + 1);
+  EXPECT_EQ(stats.num_field, 3U);
+  EXPECT_EQ(stats.label_count.size(), 2U);
+  EXPECT_EQ(stats.label_count[0.0f], 2U);
+  EXPECT_EQ(stats.label_count[1.0f], 3U);
+  EXPECT_EQ(stats.FeatureCount(3), 3U);
+  EXPECT_EQ(stats.FeatureCount(4), 0U);
+  EXPECT_EQ(stats.FeatureCount(7), 2U);
+  // the sketch holds a single large feature, so its estimate is exact
+  EXPECT_EQ(stats.FeatureCount(1ULL << 40), 3U);
+  std::string blob;
+  dmlc::MemoryStringStream fs(&blob);
+  stats.Save(&fs);
+  fs.Seek(0);
+  dmlc::DatasetStats loaded;
+  ASSERT_TRUE(loaded.Load(&fs));
+  EXPECT_EQ(loaded.num_nonzero, stats.num_nonzero);
+  EXPECT_EQ(loaded.label_count, stats.label_count);
+  EXPECT_EQ(loaded.FeatureCount(1ULL << 40), 3U);
+}
+
+TEST(DatasetStats, row_iter) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(path.c_str());
+    for (size_t i = 0; i < 300; ++i) {
+      of << i % 3;
+      for (size_t j = 0; j <= i % 4; ++j) of << " " << j * 10 << ":1";
+      of << "\n";
+    }
+  }
+  const std::string cache = tempdir.path + "/train.cache";
+  const std::string uris[] = {
+    path, path + "?compact_index=1", path + "#" + cache, path + "#" + cache
+  };
+  for (const std::string &uri : uris) {
+    std::unique_ptr<dmlc::RowBlockIter<uint32_t> > iter(
+        dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+    const dmlc::DatasetStats *stats = iter->Stats();
+    ASSERT_TRUE(stats != NULL);
+    EXPECT_EQ(iter->NumCol(), 31U);
+    EXPECT_EQ(stats->num_row, 300U);
+    EXPECT_EQ(stats->num_nonzero, 750U);
+    EXPECT_EQ(stats->num_col, 31U);
+    EXPECT_EQ(stats->num_field, 0U);
+    EXPECT_EQ(stats->label_count.at(2.0f), 100U);
+    EXPECT_EQ(stats->FeatureCount(0), 300U);
+    EXPECT_EQ(stats->FeatureCount(30), 75U);
+  }
+}
+
+namespace {
+void WriteLibSVM(const std::string &path, size_t nrow, float label) {
+  std::ofstream of(path.c_str());
+  for (size_t i = 0; i < nrow; ++i) {
+    of << label << " " << i % 5 << ":1\n";
+  }
+}
+
+size_t CountRows(dmlc::RowBlockIter<uint32_t> *iter) {
+  size_t nrow = 0;
+  iter->BeforeFirst();
+  while (iter->Next()) nrow += iter->Value().size;
+  return nrow;
+}
+}  // namespace
+
+TEST(DatasetStats, incremental_cache) {
+  dmlc::TemporaryDirectory tempdir, datadir;
+  const std::string dir = datadir.path;
+  WriteLibSVM(dir + "/part-0", 100, 0.0f);
+  WriteLibSVM(dir + "/part-1", 50, 1.0f);
+  const std::string uri = dir + "/#" + tempdir.path + "/train.cache";
+  auto check = [&uri](size_t nrow, size_t npos) {
+    std::unique_ptr<dmlc::RowBlockIter<uint32_t> > iter(
+        dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+    EXPECT_EQ(CountRows(iter.get()), nrow);
+    ASSERT_TRUE(iter->Stats() != NULL);
+    EXPECT_EQ(iter->Stats()->num_row, nrow);
+    EXPECT_EQ(iter->Stats()->label_count.at(1.0f), npos);
+  };
+  check(150, 50);
+  // reuse the cache as is
+  check(150, 50);
+  // a new file is appended to the cache
+  WriteLibSVM(dir + "/part-2", 30, 1.0f);
+  check(180, 80);
+  // a changed file is parsed again
+  WriteLibSVM(dir + "/part-0", 20, 1.0f);
+  check(100, 100);
+  // a removed file is dropped from the cache
+  std::remove((dir + "/part-1").c_str());
+  check(50, 50);
+}
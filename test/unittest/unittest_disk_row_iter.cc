@@ -0,0 +1,132 @@
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+const size_t kRows = 2000;
+
+std::string WriteData(const dmlc::TemporaryDirectory &tempdir) {
+  const std::string path = tempdir.path + "/train.libsvm";
+  std::ofstream of(path.c_str());
+  for (size_t i = 0; i < kRows; ++i) {
+    of << i << " " << i % 10 << ":1 " << 10 + i % 7 << ":2\n";
+  }
+  return path;
+}
+
+// the labels of the rows in the order of one pass
+std::vector<size_t> Pass(dmlc::RowBlockIter<uint32_t> *iter) {
+  std::vector<size_t> order;
+  iter->BeforeFirst();
+  while (iter->Next()) {
+    const dmlc::RowBlock<uint32_t> &batch = iter->Value();
+    for (size_t i = 0; i < batch.size; ++i) {
+      EXPECT_EQ(batch[i].length, 2U);
+      EXPECT_EQ(batch[i].get_index(1), 10 + static_cast<size_t>(batch[i].get_label()) % 7);
+      order.push_back(static_cast<size_t>(batch[i].get_label()));
+    }
+  }
+  return order;
+}
+
+bool IsPermutation(std::vector<size_t> order) {
+  std::sort(order.begin(), order.end());
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (order[i] != i) return false;
+  }
+  return order.size() == kRows;
+}
+}  // namespace
+
+TEST(DiskRowIter, shuffle_pages) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = WriteData(tempdir);
+  const std::string cache = "#" + tempdir.path + "/train.cache";
+  const std::string small_pages = path + "?cache_page_bytes=4096";
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > plain(
+      dmlc::RowBlockIter<uint32_t>::Create((small_pages + cache).c_str(), 0, 1, "libsvm"));
+  std::vector<size_t> sequential = Pass(plain.get());
+  ASSERT_TRUE(IsPermutation(sequential));
+  EXPECT_TRUE(std::is_sorted(sequential.begin(), sequential.end()));
+
+  const std::string shuffled = small_pages + "&shuffle_pages=1&shuffle_seed=7" + cache;
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > iter(
+      dmlc::RowBlockIter<uint32_t>::Create(shuffled.c_str(), 0, 1, "libsvm"));
+  std::vector<size_t> first = Pass(iter.get());
+  std::vector<size_t> second = Pass(iter.get());
+  ASSERT_TRUE(IsPermutation(first));
+  ASSERT_TRUE(IsPermutation(second));
+  EXPECT_NE(first, sequential);
+  EXPECT_NE(first, second);
+  // the order of each pass is reproducible from the seed
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > again(
+      dmlc::RowBlockIter<uint32_t>::Create(shuffled.c_str(), 0, 1, "libsvm"));
+  EXPECT_EQ(Pass(again.get()), first);
+  EXPECT_EQ(Pass(again.get()), second);
+}
+
+TEST(DiskRowIter, shuffle_rows) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = WriteData(tempdir);
+  const std::string uri = path + "?cache_page_bytes=4096&shuffle_rows=1#" +
+      tempdir.path + "/train.cache";
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > iter(
+      dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+  std::vector<size_t> order = Pass(iter.get());
+  ASSERT_TRUE(IsPermutation(order));
+  // no two rows of a page of about a hundred rows stay next to each other throughout
+  size_t adjacent = 0;
+  for (size_t i = 1; i < order.size(); ++i) {
+    if (order[i] == order[i - 1] + 1) ++adjacent;
+  }
+  EXPECT_LT(adjacent, kRows / 10);
+}
+
+TEST(DiskRowIter, page_reader) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = WriteData(tempdir);
+  const std::string uri = path + "?cache_page_bytes=4096#" + tempdir.path + "/train.cache";
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > iter(
+      dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+  std::unique_ptr<dmlc::RowBlockPageReader<uint32_t> > reader(iter->CreatePageReader(0));
+  ASSERT_TRUE(reader != nullptr);
+  ASSERT_GT(reader->NumPages(), 10U);
+  // visiting the pages backwards sees the rows of the sequential order
+  std::vector<std::vector<size_t> > pages(reader->NumPages());
+  for (size_t i = reader->NumPages(); i != 0; --i) {
+    dmlc::RowBlockPageReader<uint32_t>::PagePtr page = reader->GetPage(i - 1);
+    for (size_t j = 0; j < page->size; ++j) {
+      pages[i - 1].push_back(static_cast<size_t>((*page)[j].get_label()));
+    }
+  }
+  std::vector<size_t> order;
+  for (const std::vector<size_t> &page : pages) {
+    order.insert(order.end(), page.begin(), page.end());
+  }
+  EXPECT_EQ(order, Pass(iter.get()));
+  // without a memory budget only the last page is cached
+  EXPECT_EQ(reader->NumHits(), 0U);
+  reader->GetPage(0);
+  reader->GetPage(0);
+  reader->GetPage(1);
+  EXPECT_EQ(reader->NumHits(), 2U);
+  EXPECT_EQ(reader->NumMisses(), reader->NumPages() + 1);
+
+  // with a budget covering every page, the pages are read once
+  reader.reset(iter->CreatePageReader(64UL << 20UL));
+  std::vector<size_t> all;
+  for (size_t i = 0; i < reader->NumPages(); ++i) all.push_back(i);
+  reader->Prefetch(all);
+  for (int pass = 0; pass < 2; ++pass) {
+    for (size_t i = 0; i < all.size(); ++i) {
+      EXPECT_EQ(reader->GetPage(i)->size, pages[i].size());
+    }
+  }
+  EXPECT_GE(reader->NumHits(), all.size());
+  EXPECT_LE(reader->NumMisses(), all.size());
+}
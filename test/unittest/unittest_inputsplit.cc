@@ -9,6 +9,8 @@
 #include <future>
 #include <cstdlib>
 #include <gtest/gtest.h>
+#include "../src/io/cached_input_split.h"
+#include "../src/io/line_split.h"
 
 namespace {
 
@@ -144,6 +146,56 @@ TEST(InputSplit, test_split_libsvm_distributed) {
   }
 }
 
+TEST(InputSplit, test_cached_split_memory_tier) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/train.txt";
+  const size_t kLines = 1000000;
+  {
+    // about 13MB, spanning two chunks of the line splitter
+    std::ofstream of(path.c_str());
+    for (size_t i = 0; i < kLines; ++i) of << "line " << i % 1000000000 << "\n";
+  }
+  auto count = [](dmlc::InputSplit *split) {
+    size_t n = 0;
+    dmlc::InputSplit::Blob rec;
+    split->BeforeFirst();
+    while (split->NextRecord(&rec)) ++n;
+    return n;
+  };
+  const size_t budgets[] = {0, 10UL << 20UL, 64UL << 20UL};
+  for (size_t budget : budgets) {
+    const std::string cache = tempdir.path + "/train.cache" + std::to_string(budget);
+    for (int reuse = 0; reuse < 2; ++reuse) {
+      dmlc::io::URI uri(path.c_str());
+      std::unique_ptr<dmlc::io::CachedInputSplit> split(new dmlc::io::CachedInputSplit(
+          new dmlc::io::LineSplitter(dmlc::io::FileSystem::GetInstance(uri),
+                                     path.c_str(), 0, 1),
+          cache.c_str(), true, budget));
+      for (int epoch = 0; epoch < 3; ++epoch) {
+        EXPECT_EQ(count(split.get()), kLines);
+      }
+      // the pooled blocks, not only the chunks in them, stay within the budget
+      EXPECT_LE(split->MemoryBytes(), split->MemoryReservedBytes());
+      EXPECT_LE(split->MemoryReservedBytes(), budget);
+      if (budget == 0) {
+        EXPECT_EQ(split->MemoryHits(), 0U);
+      } else if (budget < (13UL << 20UL)) {
+        // the leading chunk is in memory, the rest is read from disk
+        EXPECT_GT(split->MemoryHits(), 0U);
+        EXPECT_GT(split->DiskReads(), 0U);
+      } else {
+        // everything is in memory once the cache file was read once
+        if (reuse) {
+          EXPECT_EQ(split->MemoryHits(), 2 * split->DiskReads());
+        } else {
+          EXPECT_EQ(split->DiskReads(), 0U);
+        }
+        EXPECT_GT(split->MemoryHitRate(), 0.5);
+      }
+    }
+  }
+}
+
 #ifdef DMLC_UNIT_TESTS_USE_CMAKE
 /* Don't run the following when CMake is not used */
 
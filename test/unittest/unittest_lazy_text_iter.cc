@@ -0,0 +1,156 @@
+#include "../src/data/lazy_text_iter.h"
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+// the rows of a file read by the regular parser
+std::unique_ptr<dmlc::data::RowBlockContainer<uint32_t> >
+ParseAll(const std::string &uri, const char *type) {
+  std::unique_ptr<dmlc::data::RowBlockContainer<uint32_t> > rows(
+      new dmlc::data::RowBlockContainer<uint32_t>());
+  std::unique_ptr<dmlc::Parser<uint32_t> > parser(
+      dmlc::Parser<uint32_t>::Create(uri.c_str(), 0, 1, type));
+  while (parser->Next()) rows->Push(parser->Value());
+  return rows;
+}
+
+void ExpectSameRow(const dmlc::Row<uint32_t> &a, const dmlc::Row<uint32_t> &b) {
+  EXPECT_EQ(a.get_label(), b.get_label());
+  EXPECT_EQ(a.get_weight(), b.get_weight());
+  ASSERT_EQ(a.length, b.length);
+  for (size_t j = 0; j < a.length; ++j) {
+    EXPECT_EQ(a.get_index(j), b.get_index(j));
+    EXPECT_EQ(a.get_value(j), b.get_value(j));
+  }
+}
+}  // namespace
+
+TEST(LazyTextIter, index_lines) {
+  std::string text = "a\r\nbb\n\n\rccc";
+  text += "\n" + std::string(40, 'x') + "\n" + std::string(17, 'y') + "\r\n\n";
+  std::vector<const char*> lbegin, lend;
+  dmlc::data::IndexLines(text.data(), text.data() + text.length(), &lbegin, &lend);
+  std::vector<std::string> lines;
+  for (size_t i = 0; i < lbegin.size(); ++i) lines.push_back(std::string(lbegin[i], lend[i]));
+  EXPECT_EQ(lines, std::vector<std::string>(
+      {"a", "bb", "ccc", std::string(40, 'x'), std::string(17, 'y')}));
+  // lines without a number are skipped on request
+  text = " \t\n1 2:3\n# ok\n-1\n";
+  lbegin.clear();
+  lend.clear();
+  dmlc::data::IndexLines(text.data(), text.data() + text.length(), &lbegin, &lend, true);
+  lines.clear();
+  for (size_t i = 0; i < lbegin.size(); ++i) lines.push_back(std::string(lbegin[i], lend[i]));
+  EXPECT_EQ(lines, std::vector<std::string>({"1 2:3", "-1"}));
+}
+
+TEST(LazyTextIter, blank_lines) {
+  // lines of blanks hold no row in the libsvm format
+  dmlc::TemporaryDirectory tempdir;
+  const std::string libsvm = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(libsvm.c_str());
+    of << "   \n1 3:0.5\n\t \n0 1:2\n \r\n1 2:1.5 4:1\n  \n";
+  }
+  std::unique_ptr<dmlc::data::RowBlockContainer<uint32_t> > expected =
+      ParseAll(libsvm, "libsvm");
+  ASSERT_EQ(expected->Size(), 3U);
+  const dmlc::RowBlock<uint32_t> rows = expected->GetBlock();
+  std::unique_ptr<dmlc::LazyRowBlockIter<uint32_t> > iter(
+      dmlc::LazyRowBlockIter<uint32_t>::Create(libsvm.c_str(), 0, 1, "libsvm"));
+  ASSERT_TRUE(iter->Next());
+  const dmlc::LazyRowBlock<uint32_t> &block = iter->Value();
+  ASSERT_EQ(block.Size(), 3U);
+  for (size_t i = 0; i < block.Size(); ++i) {
+    EXPECT_EQ(block.Label(i), rows.label[i]);
+    ExpectSameRow(block.GetRow(i), rows[i]);
+  }
+  const dmlc::RowBlock<uint32_t> all = block.All();
+  ASSERT_EQ(all.size, 3U);
+  for (size_t i = 0; i < all.size; ++i) ExpectSameRow(all[i], rows[i]);
+  EXPECT_FALSE(iter->Next());
+}
+
+TEST(LazyTextIter, libsvm) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string libsvm = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(libsvm.c_str());
+    for (size_t i = 0; i < 5000; ++i) {
+      of << i % 3 << ":" << 0.5 * (i % 4 + 1);
+      for (size_t j = 0; j < i % 5; ++j) of << " " << i + j * 7 << ":" << j + 0.25;
+      of << (i % 100 == 0 ? "\r\n\n" : "\n");
+    }
+  }
+  std::unique_ptr<dmlc::data::RowBlockContainer<uint32_t> > expected =
+      ParseAll(libsvm, "libsvm");
+  ASSERT_EQ(expected->Size(), 5000U);
+  const dmlc::RowBlock<uint32_t> rows = expected->GetBlock();
+
+  std::unique_ptr<dmlc::LazyRowBlockIter<uint32_t> > iter(
+      dmlc::LazyRowBlockIter<uint32_t>::Create(libsvm.c_str(), 0, 1, "libsvm"));
+  for (int pass = 0; pass < 2; ++pass) {
+    iter->BeforeFirst();
+    size_t base = 0;
+    while (iter->Next()) {
+      const dmlc::LazyRowBlock<uint32_t> &block = iter->Value();
+      // labels alone do not parse the rows
+      std::vector<size_t> selected;
+      for (size_t i = 0; i < block.Size(); ++i) {
+        EXPECT_EQ(block.Label(i), rows.label[base + i]);
+        if (block.Label(i) == 2.0f) selected.push_back(i);
+      }
+      EXPECT_EQ(block.NumParsed(), 0U);
+      const dmlc::RowBlock<uint32_t> subset = block.Select(selected);
+      ASSERT_EQ(subset.size, selected.size());
+      for (size_t i = 0; i < selected.size(); ++i) {
+        ExpectSameRow(subset[i], rows[base + selected[i]]);
+      }
+      EXPECT_EQ(block.NumParsed(), selected.size());
+      if (block.Size() > 3) {
+        const char *begin, *end;
+        block.Line(3, &begin, &end);
+        EXPECT_EQ(block.Label(3), static_cast<float>(atof(std::string(begin, end).c_str())));
+        ExpectSameRow(block.GetRow(3), rows[base + 3]);
+      }
+      const dmlc::RowBlock<uint32_t> all = block.All();
+      ASSERT_EQ(all.size, block.Size());
+      EXPECT_EQ(block.NumParsed(), block.Size());
+      for (size_t i = 0; i < all.size; ++i) ExpectSameRow(all[i], rows[base + i]);
+      base += block.Size();
+    }
+    EXPECT_EQ(base, 5000U);
+  }
+  EXPECT_GT(iter->BytesRead(), 0U);
+}
+
+TEST(LazyTextIter, csv) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string csv = tempdir.path + "/train.csv";
+  {
+    std::ofstream of(csv.c_str());
+    for (size_t i = 0; i < 1000; ++i) {
+      of << i * 0.75 << "," << i % 7 << "," << 1.0 / (i + 1) << "\n";
+    }
+  }
+  const std::string uri = csv + "?label_column=1";
+  std::unique_ptr<dmlc::data::RowBlockContainer<uint32_t> > expected = ParseAll(uri, "csv");
+  const dmlc::RowBlock<uint32_t> rows = expected->GetBlock();
+  std::unique_ptr<dmlc::LazyRowBlockIter<uint32_t> > iter(
+      dmlc::LazyRowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "csv"));
+  size_t base = 0;
+  while (iter->Next()) {
+    const dmlc::LazyRowBlock<uint32_t> &block = iter->Value();
+    for (size_t i = 0; i < block.Size(); ++i) {
+      EXPECT_EQ(block.Label(i), rows.label[base + i]);
+      ExpectSameRow(block.GetRow(i), rows[base + i]);
+    }
+    base += block.Size();
+  }
+  EXPECT_EQ(base, 1000U);
+}
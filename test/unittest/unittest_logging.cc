@@ -2,7 +2,14 @@
 #define DMLC_LOG_FATAL_THROW 0
 
 #include <dmlc/logging.h>
+#include <dmlc/async_logging.h>
 #include <gtest/gtest.h>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST(Logging, basics) {
   LOG(INFO) << "hello";
@@ -17,3 +24,85 @@ TEST(Logging, basics) {
 
   ASSERT_DEATH(CHECK_NE(x, y), ".*");
 }
+
+TEST(Logging, async_logger) {
+  std::mutex mutex;
+  std::vector<std::string> lines;
+  {
+    dmlc::AsyncLogger logger(64, [&mutex, &lines](const char *data, size_t size) {
+      std::lock_guard<std::mutex> lock(mutex);
+      std::istringstream is(std::string(data, size));
+      std::string line;
+      while (std::getline(is, line)) lines.push_back(line);
+    });
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&logger, t]() {
+        for (int i = 0; i < 1000; ++i) {
+          std::string msg = std::to_string(t) + " " + std::to_string(i) + "\n";
+          logger.Push(&msg);
+        }
+      });
+    }
+    for (std::thread &thread : threads) thread.join();
+    logger.Flush();
+    size_t logged = 0, reported = 0;
+    std::vector<int> last(4, -1);
+    for (const std::string &line : lines) {
+      int t, i;
+      if (line.find("dropped") != std::string::npos) {
+        reported += std::stoul(line.substr(line.find(']') + 2));
+        continue;
+      }
+      ASSERT_EQ(std::sscanf(line.c_str(), "%d %d", &t, &i), 2);
+      // the messages of a thread keep their order
+      EXPECT_GT(i, last[t]);
+      last[t] = i;
+      ++logged;
+    }
+    EXPECT_EQ(logged + logger.NumDropped(), 4000U);
+    EXPECT_EQ(reported, logger.NumDropped());
+    // once stopped, messages are written synchronously
+    logger.Stop();
+    std::string msg = "after stop\n";
+    logger.Push(&msg);
+    EXPECT_EQ(lines.back(), "after stop");
+  }
+}
+
+namespace {
+// counts the messages written by the rate limited macros
+const char *Count(int *n) {
+  ++*n;
+  return "";
+}
+}  // namespace
+
+TEST(Logging, rate_limited) {
+  int every_n = 0, every_0 = 0, first_n = 0, every_t = 0;
+  for (int i = 0; i < 10; ++i) {
+    LOG_EVERY_N(INFO, 4) << "every 4th " << i << Count(&every_n);
+    // a period of 0 does not divide by zero, it logs every call
+    LOG_EVERY_N(INFO, 0) << "every call " << i << Count(&every_0);
+    LOG_FIRST_N(INFO, 3) << "first 3 " << i << Count(&first_n);
+    LOG_EVERY_T(INFO, 3600) << "hourly " << i << Count(&every_t);
+  }
+  EXPECT_EQ(every_n, 3);
+  EXPECT_EQ(every_0, 10);
+  EXPECT_EQ(first_n, 3);
+  EXPECT_EQ(every_t, 1);
+  // each call site keeps its own state, shared by the threads
+  int every_n2 = 0;
+  std::mutex mutex;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&every_n2, &mutex]() {
+      for (int i = 0; i < 250; ++i) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (true) LOG_EVERY_N(INFO, 100) << Count(&every_n2);
+      }
+    });
+  }
+  for (std::thread &thread : threads) thread.join();
+  EXPECT_EQ(every_n2, 10);
+}
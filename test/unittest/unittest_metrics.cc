@@ -0,0 +1,81 @@
+// Copyright by Contributors
+#include <dmlc/metrics.h>
+#include <dmlc/timer.h>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(Timer, monotonic) {
+  const double begin = dmlc::GetMonotonicTime();
+  dmlc::Stopwatch watch;
+  const uint64_t ticks = dmlc::GetTicks();
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  EXPECT_GE(dmlc::GetMonotonicTime() - begin, 0.019);
+  EXPECT_GT(dmlc::GetTicks(), ticks);
+  EXPECT_GE(watch.Elapsed(), 0.019);
+  EXPECT_LT(watch.Elapsed(), 5.0);
+  double total = 0;
+  {
+    dmlc::ScopedTimer timer(&total);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_GE(total, 0.009);
+  EXPECT_LT(total, 5.0);
+}
+
+TEST(Metrics, counter) {
+  dmlc::Counter *counter = dmlc::MetricRegistry::Get()->GetCounter("test.counter");
+  EXPECT_EQ(counter, dmlc::MetricRegistry::Get()->GetCounter("test.counter"));
+  const int kThreads = 4;
+  const int kAdds = 10000;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([counter]() {
+        for (int j = 0; j < kAdds; ++j) counter->Add();
+      });
+  }
+  counter->Add(5);
+  for (auto &t : threads) t.join();
+  EXPECT_EQ(counter->Value(), kThreads * kAdds + 5);
+}
+
+TEST(Metrics, histogram) {
+  dmlc::Histogram histogram(dmlc::Histogram::ExponentialBounds(1.0, 2.0, 4));
+  std::thread worker([&histogram]() {
+      for (int i = 0; i < 10; ++i) histogram.Observe(0.5);
+    });
+  for (int i = 0; i < 10; ++i) histogram.Observe(3.0);
+  histogram.Observe(100.0);
+  worker.join();
+  dmlc::HistogramSnapshot snapshot = histogram.Snapshot();
+  ASSERT_EQ(snapshot.counts.size(), 5U);
+  EXPECT_EQ(snapshot.counts[0], 10U);
+  EXPECT_EQ(snapshot.counts[2], 10U);
+  EXPECT_EQ(snapshot.counts[4], 1U);
+  EXPECT_EQ(snapshot.count, 21U);
+  EXPECT_DOUBLE_EQ(snapshot.sum, 135.0);
+  EXPECT_DOUBLE_EQ(snapshot.Quantile(0.4), 1.0);
+  EXPECT_DOUBLE_EQ(snapshot.Quantile(0.9), 4.0);
+  EXPECT_DOUBLE_EQ(snapshot.Quantile(1.0), 8.0);
+}
+
+TEST(Metrics, snapshot) {
+  dmlc::MetricRegistry *registry = dmlc::MetricRegistry::Get();
+  registry->GetCounter("test.snapshot_rows")->Add(42);
+  dmlc::Histogram *latency = registry->GetHistogram(
+      "test.snapshot_seconds", dmlc::Histogram::ExponentialBounds(1e-6, 10.0, 8));
+  {
+    dmlc::HistogramTimer timer(latency);
+  }
+  dmlc::MetricsSnapshot snapshot = registry->Snapshot();
+  EXPECT_EQ(snapshot.counters["test.snapshot_rows"], 42);
+  EXPECT_EQ(snapshot.histograms["test.snapshot_seconds"].count, 1U);
+  std::ostringstream os;
+  dmlc::JSONWriter writer(&os);
+  writer.Write(snapshot);
+  const std::string json = os.str();
+  EXPECT_NE(json.find("\"test.snapshot_rows\": 42"), std::string::npos);
+  EXPECT_NE(json.find("\"test.snapshot_seconds\""), std::string::npos);
+}
@@ -1,8 +1,13 @@
 #include "../src/data/csv_parser.h"
 #include "../src/data/libsvm_parser.h"
 #include "../src/data/libfm_parser.h"
+#include "../src/data/hashed_libsvm_parser.h"
 #include <cstdio>
 #include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <vector>
+#include <dmlc/filesystem.h>
 #include <dmlc/io.h>
 #include <gtest/gtest.h>
 
@@ -49,6 +54,19 @@ public:
   }
 };
 
+template <typename IndexType, typename DType = real_t>
+class HashedLibSVMParserTest : public HashedLibSVMParser<IndexType, DType> {
+public:
+  explicit HashedLibSVMParserTest(InputSplit *source,
+                                  const std::map<std::string, std::string> &args,
+                                  int nthread)
+      : HashedLibSVMParser<IndexType, DType>(source, args, nthread) {}
+  void CallParseBlock(char *begin, char *end,
+                      RowBlockContainer<IndexType, DType> *out) {
+    HashedLibSVMParser<IndexType, DType>::ParseBlock(begin, end, out);
+  }
+};
+
 }  // namespace parser_test
 
 namespace {
@@ -486,3 +504,125 @@ TEST(LibFMParser, test_indexing_mode_auto_detect_2) {
   CHECK(rctr->index == expected_index);
   CHECK(rctr->value == expected_value);  // perform element-wise comparsion
 }
+
+TEST(HashedLibSVMParser, test_hash_names) {
+  using namespace parser_test;
+  InputSplit *source = nullptr;
+  const std::map<std::string, std::string> args{{"hash_bits", "10"}};
+  std::unique_ptr<HashedLibSVMParserTest<unsigned>> parser(
+      new HashedLibSVMParserTest<unsigned>(source, args, 1));
+  RowBlockContainer<unsigned>* rctr = new RowBlockContainer<unsigned>();
+  std::string data = "1 qid:3 user=alice:0.5 item=42\n"
+                     "0:2 item=42:-1 |ctx item=42\n";
+  char* out_data = const_cast<char*>(data.c_str());
+  parser->CallParseBlock(out_data, out_data + data.size(), rctr);
+
+  const uint32_t seed = parser->NamespaceSeed(NULL, 0);
+  const uint32_t ctx_seed = parser->NamespaceSeed("ctx", 3);
+  real_t sign;
+  const unsigned alice = parser->HashFeature("user=alice", 10, seed, &sign);
+  const unsigned item = parser->HashFeature("item=42", 7, seed, &sign);
+  const unsigned ctx_item = parser->HashFeature("item=42", 7, ctx_seed, &sign);
+  CHECK_NE(item, ctx_item);
+
+  const std::vector<size_t> expected_offset{0, 2, 4};
+  const std::vector<real_t> expected_label{1, 0};
+  const std::vector<unsigned> expected_index{alice, item, item, ctx_item};
+  const std::vector<real_t> expected_value{0.5f, 1.0f, -1.0f, 1.0f};
+  CHECK(rctr->offset == expected_offset);
+  CHECK(rctr->label == expected_label);
+  CHECK_EQ(rctr->weight.size(), 1U);
+  CHECK_EQ(rctr->weight[0], 2.0f);
+  CHECK_EQ(rctr->qid.size(), 1U);
+  CHECK_EQ(rctr->qid[0], 3U);
+  CHECK(rctr->index == expected_index);
+  CHECK(rctr->value == expected_value);
+  for (unsigned index : rctr->index) {
+    CHECK_LT(index, 1U << 10);
+  }
+  delete rctr;
+}
+
+TEST(HashedLibSVMParser, test_signed_hash) {
+  using namespace parser_test;
+  InputSplit *source = nullptr;
+  const std::map<std::string, std::string> args{{"signed_hash", "1"}};
+  std::unique_ptr<HashedLibSVMParserTest<unsigned>> parser(
+      new HashedLibSVMParserTest<unsigned>(source, args, 1));
+  RowBlockContainer<unsigned>* rctr = new RowBlockContainer<unsigned>();
+  std::string data;
+  for (int i = 0; i < 64; ++i) {
+    data += "1 f" + std::to_string(i) + ":2\n";
+  }
+  char* out_data = const_cast<char*>(data.c_str());
+  parser->CallParseBlock(out_data, out_data + data.size(), rctr);
+  CHECK_EQ(rctr->value.size(), 64U);
+  size_t num_negative = 0;
+  for (size_t i = 0; i < rctr->value.size(); ++i) {
+    const std::string name = "f" + std::to_string(i);
+    real_t sign;
+    parser->HashFeature(name.c_str(), name.length(),
+                        parser->NamespaceSeed(NULL, 0), &sign);
+    CHECK_EQ(rctr->value[i], 2.0f * sign);
+    if (sign < 0) ++num_negative;
+  }
+  // signs are drawn from the hash, so both must show up
+  CHECK_GT(num_negative, 0U);
+  CHECK_LT(num_negative, 64U);
+  delete rctr;
+}
+
+TEST(RowSampler, sample_at_parse_time) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string libsvm = tempdir.path + "/train.libsvm";
+  const std::string libfm = tempdir.path + "/train.libfm";
+  const std::string csv = tempdir.path + "/train.csv";
+  {
+    std::ofstream of_svm(libsvm.c_str()), of_fm(libfm.c_str()), of_csv(csv.c_str());
+    for (int i = 0; i < 10000; ++i) {
+      const int label = i % 10 == 0 ? 1 : 0;
+      of_svm << label << " " << i << ":1\n";
+      of_fm << label << " 0:" << i << ":1\n";
+      of_csv << i << "," << label << "\n";
+    }
+  }
+  // collect the first feature of the kept rows, for each pass over the data
+  auto read = [](const std::string &uri, const char *type, size_t *num_pos) {
+    std::unique_ptr<Parser<uint32_t> > parser(
+        Parser<uint32_t>::Create(uri.c_str(), 0, 1, type));
+    std::vector<std::vector<real_t> > passes(2);
+    *num_pos = 0;
+    for (size_t k = 0; k < passes.size(); ++k) {
+      parser->BeforeFirst();
+      while (parser->Next()) {
+        const RowBlock<uint32_t> &batch = parser->Value();
+        for (size_t i = 0; i < batch.size; ++i) {
+          passes[k].push_back(batch[i].get_index(0) + batch[i].get_value(0));
+          if (k == 0 && batch[i].get_label() == 1) ++*num_pos;
+        }
+      }
+    }
+    EXPECT_EQ(passes[0], passes[1]);
+    return passes[0];
+  };
+  size_t num_pos;
+  std::vector<real_t> rows = read(libsvm + "?sample_rate=0.3&sample_seed=7", "libsvm", &num_pos);
+  EXPECT_GT(rows.size(), 2700U);
+  EXPECT_LT(rows.size(), 3300U);
+  // the decision only depends on the seed and the position of the line
+  EXPECT_EQ(read(libsvm + "?sample_rate=0.3&sample_seed=7", "libsvm", &num_pos), rows);
+  EXPECT_NE(read(libsvm + "?sample_rate=0.3&sample_seed=8", "libsvm", &num_pos), rows);
+  // stratified by label, keep every positive row and a fifth of the others
+  rows = read(libsvm + "?sample_rate=0.2&label_sample_rate=1:1", "libsvm", &num_pos);
+  EXPECT_EQ(num_pos, 1000U);
+  EXPECT_GT(rows.size(), 1000U + 1600U);
+  EXPECT_LT(rows.size(), 1000U + 2000U);
+  rows = read(libfm + "?label_sample_rate=0:0,1:0.5", "libfm", &num_pos);
+  EXPECT_EQ(rows.size(), num_pos);
+  EXPECT_GT(num_pos, 400U);
+  EXPECT_LT(num_pos, 600U);
+  rows = read(csv + "?label_column=1&label_sample_rate=0:0", "csv", &num_pos);
+  EXPECT_EQ(rows.size(), 1000U);
+  EXPECT_EQ(num_pos, 1000U);
+  for (size_t i = 0; i < rows.size(); ++i) EXPECT_EQ(rows[i], i * 10.0f);
+}
@@ -0,0 +1,98 @@
+#include <dmlc/quantile_sketch.h>
+#include <dmlc/memory_io.h>
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+// fraction of data strictly less than value
+inline double Rank(const std::vector<float> &sorted, float value) {
+  return static_cast<double>(std::lower_bound(sorted.begin(), sorted.end(), value)
+                             - sorted.begin()) / sorted.size();
+}
+}  // namespace
+
+TEST(QuantileSketch, rank_error) {
+  const double eps = 0.01;
+  std::mt19937 rng(0);
+  std::normal_distribution<float> dist(0.0f, 1.0f);
+  std::vector<float> values(100000);
+  dmlc::WeightedQuantileSketch<float> sketch(eps);
+  for (float &v : values) {
+    v = dist(rng);
+    sketch.Push(v);
+  }
+  std::sort(values.begin(), values.end());
+  dmlc::WeightedQuantileSummary<float> summary;
+  sketch.GetSummary(&summary);
+  EXPECT_DOUBLE_EQ(summary.Total(), static_cast<double>(values.size()));
+  EXPECT_EQ(summary.data.front().value, values.front());
+  EXPECT_EQ(summary.data.back().value, values.back());
+  for (int q = 1; q < 10; ++q) {
+    float v = summary.Query(summary.Total() * q / 10);
+    EXPECT_NEAR(Rank(values, v), q / 10.0, eps);
+  }
+}
+
+TEST(QuantileSketch, merge_and_serialize) {
+  typedef dmlc::RowBlock<unsigned> Block;
+  const double eps = 0.01;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> dist(0.0f, 1.0f);
+  // two workers, each sees half of a dense two-column dataset
+  const size_t nrow = 20000;
+  std::vector<size_t> offset;
+  std::vector<unsigned> index;
+  std::vector<float> value, label(nrow, 0.0f), col1;
+  for (size_t i = 0; i < nrow; ++i) {
+    offset.push_back(index.size());
+    index.push_back(0); value.push_back(dist(rng));
+    index.push_back(1); value.push_back(dist(rng) * 10.0f);
+    col1.push_back(value.back());
+  }
+  offset.push_back(index.size());
+  Block block;
+  block.size = nrow;
+  block.offset = offset.data();
+  block.label = label.data();
+  block.weight = NULL;
+  block.qid = NULL;
+  block.field = NULL;
+  block.index = index.data();
+  block.value = value.data();
+
+  dmlc::FeatureQuantileSketch<float> worker0(eps), worker1(eps);
+  worker0.Push(block.Slice(0, nrow / 2));
+  worker1.Push(block.Slice(nrow / 2, nrow));
+  // ship worker1 to worker0 through a stream
+  std::string blob;
+  dmlc::MemoryStringStream fs(&blob);
+  worker1.Save(&fs);
+  fs.Seek(0);
+  ASSERT_TRUE(worker0.Load(&fs));
+  ASSERT_EQ(worker0.NumCol(), 2U);
+
+  dmlc::WeightedQuantileSummary<float> summary;
+  worker0.GetSummary(1, &summary);
+  EXPECT_DOUBLE_EQ(summary.Total(), static_cast<double>(nrow));
+  std::sort(col1.begin(), col1.end());
+  std::vector<float> cuts = worker0.GetCuts(1, 16);
+  ASSERT_LE(cuts.size(), 17U);
+  ASSERT_GE(cuts.size(), 2U);
+  EXPECT_EQ(cuts.front(), col1.front());
+  EXPECT_EQ(cuts.back(), col1.back());
+  for (size_t i = 1; i < cuts.size(); ++i) {
+    EXPECT_LT(cuts[i - 1], cuts[i]);
+  }
+  for (size_t i = 1; i + 1 < cuts.size(); ++i) {
+    EXPECT_NEAR(Rank(col1, cuts[i]), static_cast<double>(i) / (cuts.size() - 1),
+                1.0 / 16 + eps);
+  }
+  // the threads see the entries of each feature in row order
+  dmlc::FeatureQuantileSketch<float> serial(eps, 1), parallel(eps, 4);
+  serial.Push(block);
+  parallel.Push(block);
+  EXPECT_EQ(serial.GetCuts(0, 16), parallel.GetCuts(0, 16));
+  EXPECT_EQ(serial.GetCuts(1, 16), parallel.GetCuts(1, 16));
+}
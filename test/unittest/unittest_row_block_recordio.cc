@@ -0,0 +1,208 @@
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/io.h>
+#include <dmlc/row_block_recordio.h>
+#include <gtest/gtest.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+// an output stream that cannot tell its position, as a remote write stream
+class NoSeekStream : public dmlc::Stream {
+ public:
+  explicit NoSeekStream(dmlc::Stream *stream) : stream_(stream) {}
+  virtual size_t Read(void *ptr, size_t size) {
+    return stream_->Read(ptr, size);
+  }
+  virtual void Write(const void *ptr, size_t size) {
+    stream_->Write(ptr, size);
+  }
+
+ private:
+  dmlc::Stream *stream_;
+};
+
+// a row read back from a parser
+struct TestRow {
+  float label, weight;
+  uint64_t qid;
+  std::vector<uint64_t> index;
+  std::vector<float> value;
+};
+
+template<typename IndexType>
+std::vector<TestRow> ReadRows(const std::string &uri, unsigned part,
+                              unsigned nparts, const char *type) {
+  std::unique_ptr<dmlc::Parser<IndexType> > parser(
+      dmlc::Parser<IndexType>::Create(uri.c_str(), part, nparts, type));
+  std::vector<TestRow> rows;
+  while (parser->Next()) {
+    const dmlc::RowBlock<IndexType> &batch = parser->Value();
+    for (size_t i = 0; i < batch.size; ++i) {
+      dmlc::Row<IndexType> r = batch[i];
+      TestRow row;
+      row.label = r.get_label();
+      row.weight = r.get_weight();
+      row.qid = r.get_qid();
+      for (size_t j = 0; j < r.length; ++j) {
+        row.index.push_back(r.get_index(j));
+        row.value.push_back(r.get_value(j));
+      }
+      rows.push_back(row);
+    }
+  }
+  return rows;
+}
+
+void ExpectSameRows(const std::vector<TestRow> &a, const std::vector<TestRow> &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].label, b[i].label);
+    EXPECT_EQ(a[i].weight, b[i].weight);
+    EXPECT_EQ(a[i].qid, b[i].qid);
+    EXPECT_EQ(a[i].index, b[i].index);
+    EXPECT_EQ(a[i].value, b[i].value);
+  }
+}
+}  // namespace
+
+TEST(RowBlockRecordIO, libsvm_round_trip) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string libsvm = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(libsvm.c_str());
+    for (size_t i = 0; i < 1000; ++i) {
+      of << i % 3 << ":" << 0.5 * i << " qid:" << i / 10;
+      for (size_t j = 0; j < i % 5; ++j) of << " " << i + j * 7 << ":" << j + 0.25;
+      of << "\n";
+    }
+  }
+  const std::string rec = tempdir.path + "/train.rec";
+  {
+    std::unique_ptr<dmlc::Parser<uint32_t> > parser(
+        dmlc::Parser<uint32_t>::Create(libsvm.c_str(), 0, 1, "libsvm"));
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(rec.c_str(), "w"));
+    dmlc::RowBlockRecordIOWriter<uint32_t> writer(fo.get(), 37);
+    while (parser->Next()) writer.Write(parser->Value());
+  }
+  std::vector<TestRow> expected = ReadRows<uint32_t>(libsvm, 0, 1, "libsvm");
+  ASSERT_EQ(expected.size(), 1000U);
+  ExpectSameRows(ReadRows<uint32_t>(rec, 0, 1, "rowblock"), expected);
+  // indices written as 32 bits are widened for 64-bit readers
+  ExpectSameRows(ReadRows<uint64_t>(rec, 0, 1, "rowblock"), expected);
+  // partitions cover all the rows in order
+  std::vector<TestRow> parts;
+  for (unsigned part = 0; part < 3; ++part) {
+    std::vector<TestRow> rows = ReadRows<uint32_t>(rec, part, 3, "rowblock");
+    EXPECT_GT(rows.size(), 0U);
+    parts.insert(parts.end(), rows.begin(), rows.end());
+  }
+  ExpectSameRows(parts, expected);
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > iter(
+      dmlc::RowBlockIter<uint32_t>::Create(rec.c_str(), 0, 1, "rowblock"));
+  EXPECT_EQ(iter->NumCol(), 999U + 3 * 7 + 1);
+}
+
+TEST(RowBlockRecordIO, optional_arrays) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string rec = tempdir.path + "/train.rec";
+  std::vector<uint32_t> index = {1, 5, 2};
+  std::vector<float> value = {0.5f, 2.0f, -1.0f};
+  std::vector<float> weight = {3.0f, 4.0f};
+  std::vector<size_t> offset = {0, 2, 3};
+  std::vector<float> label = {1.0f, 0.0f};
+  {
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(rec.c_str(), "w"));
+    dmlc::RowBlockRecordIOWriter<uint32_t> writer(fo.get());
+    dmlc::RowBlock<uint32_t> batch;
+    batch.size = 2;
+    batch.offset = offset.data();
+    batch.label = label.data();
+    batch.weight = weight.data();
+    batch.qid = NULL;
+    batch.field = NULL;
+    batch.index = index.data();
+    batch.value = value.data();
+    writer.Write(batch);
+    // binary rows without weights
+    batch.weight = NULL;
+    batch.value = NULL;
+    writer.Write(batch);
+  }
+  std::vector<TestRow> rows = ReadRows<uint32_t>(rec, 0, 1, "rowblock");
+  ASSERT_EQ(rows.size(), 4U);
+  EXPECT_EQ(rows[0].weight, 3.0f);
+  EXPECT_EQ(rows[1].value, std::vector<float>({-1.0f}));
+  EXPECT_EQ(rows[2].weight, 1.0f);
+  EXPECT_EQ(rows[2].value, std::vector<float>({1.0f, 1.0f}));
+  EXPECT_EQ(rows[3].index, std::vector<uint64_t>({2}));
+}
+
+TEST(RowBlockRecordIO, index) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string rec = tempdir.path + "/train.rec";
+  const std::string idx = tempdir.path + "/train.idx";
+  std::vector<uint32_t> index(10);
+  std::vector<size_t> offset(11);
+  std::vector<float> label(10);
+  for (size_t i = 0; i < 10; ++i) {
+    index[i] = static_cast<uint32_t>(i);
+    offset[i + 1] = i + 1;
+    label[i] = static_cast<float>(i);
+  }
+  // the second record is split at the recordio magic number
+  index[4] = dmlc::RecordIOWriter::kMagic;
+  {
+    std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(rec.c_str(), "w"));
+    std::unique_ptr<dmlc::Stream> findex(dmlc::Stream::Create(idx.c_str(), "w"));
+    NoSeekStream no_seek(fo.get());
+    dmlc::RowBlockRecordIOWriter<uint32_t> writer(&no_seek, 3, findex.get());
+    dmlc::RowBlock<uint32_t> batch;
+    batch.size = 10;
+    batch.offset = offset.data();
+    batch.label = label.data();
+    batch.weight = NULL;
+    batch.qid = NULL;
+    batch.field = NULL;
+    batch.index = index.data();
+    batch.value = NULL;
+    writer.Write(batch);
+    EXPECT_EQ(writer.NumRecords(), 4U);
+  }
+  std::ifstream is(idx.c_str());
+  std::unique_ptr<dmlc::SeekStream> fi(dmlc::SeekStream::CreateForRead(rec.c_str()));
+  const uint32_t recordio_magic = dmlc::RecordIOWriter::kMagic;
+  size_t key, pos, num_lines = 0, last = 0;
+  while (is >> key >> pos) {
+    EXPECT_EQ(key, num_lines);
+    if (num_lines != 0) {
+      EXPECT_GT(pos, last);
+    }
+    // each offset is the head of the first part of a record
+    uint32_t head[2];
+    fi->Seek(pos);
+    ASSERT_EQ(fi->Read(head, sizeof(head)), sizeof(head));
+    EXPECT_EQ(head[0], recordio_magic);
+    EXPECT_LE(dmlc::RecordIOWriter::DecodeFlag(head[1]), 1U);
+    last = pos;
+    ++num_lines;
+  }
+  EXPECT_EQ(num_lines, 4U);
+  // the index drives the indexed_recordio splits
+  std::unique_ptr<dmlc::InputSplit> split(
+      dmlc::InputSplit::Create(rec.c_str(), idx.c_str(), 0, 1, "indexed_recordio"));
+  dmlc::InputSplit::Blob blob;
+  const uint32_t magic = dmlc::RowBlockRecordHeader::kMagic;
+  size_t num_records = 0;
+  while (split->NextRecord(&blob)) {
+    const dmlc::RowBlockRecordHeader *header =
+        static_cast<const dmlc::RowBlockRecordHeader*>(blob.dptr);
+    EXPECT_EQ(header->magic, magic);
+    EXPECT_EQ(header->num_rows, num_records == 3 ? 1U : 3U);
+    EXPECT_EQ(blob.size, header->RecordBytes());
+    ++num_records;
+  }
+  EXPECT_EQ(num_records, 4U);
+}
@@ -0,0 +1,181 @@
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <dmlc/io.h>
+#include <dmlc/row_block_text_writer.h>
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+std::string FormatFloat(float value) {
+  char buf[dmlc::kMaxNumberChars];
+  return std::string(buf, dmlc::ToChars(buf, value));
+}
+
+// number of significant digits of a formatted number
+size_t SignificantDigits(const std::string &text) {
+  std::string digits;
+  for (size_t i = 0; i < text.length() && text[i] != 'e'; ++i) {
+    if (text[i] >= '0' && text[i] <= '9') digits += text[i];
+  }
+  const size_t begin = digits.find_first_not_of('0');
+  if (begin == std::string::npos) return 0;
+  return digits.find_last_not_of('0') + 1 - begin;
+}
+
+// a row read back from a parser
+struct TestRow {
+  float label, weight;
+  uint64_t qid;
+  std::vector<uint64_t> field, index;
+  std::vector<float> value;
+};
+
+std::vector<TestRow> ReadRows(const std::string &uri, const char *type) {
+  std::unique_ptr<dmlc::Parser<uint32_t> > parser(
+      dmlc::Parser<uint32_t>::Create(uri.c_str(), 0, 1, type));
+  std::vector<TestRow> rows;
+  while (parser->Next()) {
+    const dmlc::RowBlock<uint32_t> &batch = parser->Value();
+    for (size_t i = 0; i < batch.size; ++i) {
+      dmlc::Row<uint32_t> r = batch[i];
+      TestRow row;
+      row.label = r.get_label();
+      row.weight = r.get_weight();
+      row.qid = r.get_qid();
+      for (size_t j = 0; j < r.length; ++j) {
+        if (r.field != NULL) row.field.push_back(r.get_field(j));
+        row.index.push_back(r.get_index(j));
+        row.value.push_back(r.get_value(j));
+      }
+      rows.push_back(row);
+    }
+  }
+  return rows;
+}
+
+// parse a file and write it back with the writer
+void Rewrite(const std::string &in, const char *type, const std::string &out,
+             const std::map<std::string, std::string> &args) {
+  std::unique_ptr<dmlc::Parser<uint32_t> > parser(
+      dmlc::Parser<uint32_t>::Create(in.c_str(), 0, 1, type));
+  std::unique_ptr<dmlc::Stream> fo(dmlc::Stream::Create(out.c_str(), "w"));
+  dmlc::RowBlockTextWriter<uint32_t> writer(fo.get(), args, 4);
+  while (parser->Next()) writer.Write(parser->Value());
+  EXPECT_GT(writer.BytesWritten(), 0U);
+}
+
+void ExpectSameRows(const std::vector<TestRow> &a, const std::vector<TestRow> &b) {
+  ASSERT_EQ(a.size(), b.size());
+  for (size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(a[i].label, b[i].label);
+    EXPECT_EQ(a[i].weight, b[i].weight);
+    EXPECT_EQ(a[i].qid, b[i].qid);
+    EXPECT_EQ(a[i].field, b[i].field);
+    EXPECT_EQ(a[i].index, b[i].index);
+    EXPECT_EQ(a[i].value, b[i].value);
+  }
+}
+}  // namespace
+
+TEST(RowBlockTextWriter, to_chars) {
+  EXPECT_EQ(FormatFloat(0.0f), "0");
+  EXPECT_EQ(FormatFloat(1.0f), "1");
+  EXPECT_EQ(FormatFloat(-2.5f), "-2.5");
+  EXPECT_EQ(FormatFloat(0.1f), "0.1");
+  EXPECT_EQ(FormatFloat(0.003f), "0.003");
+  EXPECT_EQ(FormatFloat(123456.75f), "123456.75");
+  EXPECT_EQ(FormatFloat(1e20f), "1e+20");
+  EXPECT_EQ(FormatFloat(1.5e-12f), "1.5e-12");
+  EXPECT_EQ(FormatFloat(std::numeric_limits<float>::infinity()), "inf");
+  char buf[dmlc::kMaxNumberChars];
+  EXPECT_EQ(std::string(buf, dmlc::ToChars(buf, static_cast<int64_t>(-9876543210LL))),
+            "-9876543210");
+  EXPECT_EQ(std::string(buf, dmlc::ToChars(buf, static_cast<uint32_t>(7))), "7");
+  // random bit patterns read back as the same float, with the fewest digits
+  std::mt19937 rng(0);
+  for (int i = 0; i < 100000; ++i) {
+    uint32_t bits = static_cast<uint32_t>(rng());
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    if (std::isnan(value)) continue;
+    const std::string text = FormatFloat(value);
+    ASSERT_EQ(strtof(text.c_str(), NULL), value) << text;
+    char shortest[64];
+    for (int precision = 1; precision <= 9; ++precision) {
+      snprintf(shortest, sizeof(shortest), "%.*g", precision, value);
+      if (strtof(shortest, NULL) == value) break;
+    }
+    EXPECT_LE(SignificantDigits(text), SignificantDigits(shortest)) << text << " " << shortest;
+  }
+}
+
+TEST(RowBlockTextWriter, libsvm_round_trip) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string libsvm = tempdir.path + "/train.libsvm";
+  {
+    std::ofstream of(libsvm.c_str());
+    for (size_t i = 0; i < 3000; ++i) {
+      of << i % 3 << ":" << 0.5 * i << " qid:" << i / 10;
+      for (size_t j = 0; j < i % 5; ++j) of << " " << i + j * 7 << ":" << j * 0.1 + 0.25;
+      of << "\n";
+    }
+  }
+  const std::string out = tempdir.path + "/out.libsvm";
+  Rewrite(libsvm, "libsvm", out, {});
+  std::vector<TestRow> expected = ReadRows(libsvm, "libsvm");
+  ASSERT_EQ(expected.size(), 3000U);
+  ExpectSameRows(ReadRows(out, "libsvm"), expected);
+  // 1-based output
+  Rewrite(libsvm, "libsvm", out, {{"indexing_mode", "1"}});
+  ExpectSameRows(ReadRows(out + "?indexing_mode=1", "libsvm"), expected);
+}
+
+TEST(RowBlockTextWriter, libfm_round_trip) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string libfm = tempdir.path + "/train.libfm";
+  {
+    std::ofstream of(libfm.c_str());
+    for (size_t i = 0; i < 1000; ++i) {
+      of << i % 2;
+      for (size_t j = 0; j < i % 4; ++j) of << " " << j << ":" << i + j << ":" << 1.0 / (j + 3);
+      of << "\n";
+    }
+  }
+  const std::string out = tempdir.path + "/out.libfm";
+  Rewrite(libfm, "libfm", out, {{"format", "libfm"}});
+  std::vector<TestRow> expected = ReadRows(libfm, "libfm");
+  ASSERT_EQ(expected.size(), 1000U);
+  ExpectSameRows(ReadRows(out, "libfm"), expected);
+}
+
+TEST(RowBlockTextWriter, csv_round_trip) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string csv = tempdir.path + "/train.csv";
+  {
+    std::ofstream of(csv.c_str());
+    for (size_t i = 0; i < 1000; ++i) {
+      of << i * 0.75 << "," << i % 7 << "," << 1.0 / (i + 1) << "," << -static_cast<int>(i)
+         << "\n";
+    }
+  }
+  const std::string out = tempdir.path + "/out.csv";
+  // the default arguments of the writer and the parser agree
+  Rewrite(csv, "csv", out, {{"format", "csv"}});
+  ExpectSameRows(ReadRows(out, "csv"), ReadRows(csv, "csv"));
+  Rewrite(csv + "?label_column=1", "csv", out, {{"format", "csv"}, {"label_column", "1"}});
+  std::vector<TestRow> expected = ReadRows(csv + "?label_column=1", "csv");
+  ASSERT_EQ(expected.size(), 1000U);
+  ExpectSameRows(ReadRows(out + "?label_column=1", "csv"), expected);
+  // rows with absent features are written dense
+  std::ifstream is(out.c_str());
+  std::string line;
+  std::getline(is, line);
+  EXPECT_EQ(line, "0,0,1,0");
+}
@@ -0,0 +1,72 @@
+#include <dmlc/data.h>
+#include <dmlc/filesystem.h>
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+
+namespace {
+// write nrow rows, row i has label i % 2, weight 0.5 and i % 3 + 1 entries
+void WriteLibSVM(const std::string &path, size_t nrow) {
+  std::ofstream of(path.c_str());
+  for (size_t i = 0; i < nrow; ++i) {
+    of << i % 2 << ":0.5";
+    for (size_t j = 0; j <= i % 3; ++j) of << " " << j * 7 << ":" << i;
+    of << "\n";
+  }
+}
+// inode of the file, changes when the file is replaced by a rename
+ino_t Inode(const std::string &path) {
+  struct stat st;
+  EXPECT_EQ(stat(path.c_str(), &st), 0);
+  return st.st_ino;
+}
+}  // namespace
+
+TEST(SharedRowIter, attach) {
+  dmlc::TemporaryDirectory tempdir;
+  const std::string path = tempdir.path + "/train.libsvm";
+  WriteLibSVM(path, 200);
+  const std::string shm = tempdir.path + "/train.shm";
+  const std::string uri = path + "?shared_file=" + shm;
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > first(
+      dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+  const ino_t built = Inode(shm);
+  // the second iterator attaches to the shared file without rebuilding it
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > second(
+      dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+  EXPECT_EQ(Inode(shm), built);
+  // a rewritten input is parsed again instead of attaching to the stale file
+  WriteLibSVM(path, 100);
+  std::unique_ptr<dmlc::RowBlockIter<uint32_t> > third(
+      dmlc::RowBlockIter<uint32_t>::Create(uri.c_str(), 0, 1, "libsvm"));
+  EXPECT_NE(Inode(shm), built);
+  const size_t nrows[] = {200, 200, 100};
+  dmlc::RowBlockIter<uint32_t> *iters[] = {first.get(), second.get(), third.get()};
+  for (size_t k = 0; k < 3; ++k) {
+    dmlc::RowBlockIter<uint32_t> *iter = iters[k];
+    EXPECT_EQ(iter->NumCol(), 15U);
+    ASSERT_TRUE(iter->Stats() != NULL);
+    EXPECT_EQ(iter->Stats()->num_row, nrows[k]);
+    iter->BeforeFirst();
+    ASSERT_TRUE(iter->Next());
+    const dmlc::RowBlock<uint32_t> &batch = iter->Value();
+    ASSERT_EQ(batch.size, nrows[k]);
+    EXPECT_TRUE(batch.weight != NULL);
+    EXPECT_TRUE(batch.qid == NULL);
+    for (size_t i = 0; i < batch.size; ++i) {
+      dmlc::Row<uint32_t> row = batch[i];
+      EXPECT_EQ(row.get_label(), static_cast<float>(i % 2));
+      EXPECT_EQ(row.get_weight(), 0.5f);
+      ASSERT_EQ(row.length, i % 3 + 1);
+      EXPECT_EQ(row.get_index(row.length - 1), (i % 3) * 7);
+      EXPECT_EQ(row.get_value(0), static_cast<float>(i));
+    }
+    EXPECT_FALSE(iter->Next());
+  }
+}
+#endif  // _WIN32
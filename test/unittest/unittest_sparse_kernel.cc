@@ -0,0 +1,107 @@
+#include <dmlc/sparse_kernel.h>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+struct CSR {
+  std::vector<size_t> offset;
+  std::vector<uint32_t> index;
+  std::vector<float> value, label;
+  dmlc::RowBlock<uint32_t> Block(bool with_value) {
+    dmlc::RowBlock<uint32_t> b;
+    b.size = label.size();
+    b.offset = offset.data();
+    b.label = label.data();
+    b.weight = NULL;
+    b.qid = NULL;
+    b.field = NULL;
+    b.index = index.data();
+    b.value = with_value ? value.data() : NULL;
+    return b;
+  }
+};
+
+CSR MakeCSR(size_t nrow, size_t ncol, size_t max_len) {
+  std::mt19937 rng(0);
+  std::uniform_int_distribution<size_t> len(0, max_len);
+  std::uniform_int_distribution<uint32_t> col(0, static_cast<uint32_t>(ncol - 1));
+  std::uniform_real_distribution<float> val(-1.0f, 1.0f);
+  CSR m;
+  m.offset.push_back(0);
+  for (size_t i = 0; i < nrow; ++i) {
+    size_t n = len(rng);
+    for (size_t j = 0; j < n; ++j) {
+      m.index.push_back(col(rng));
+      m.value.push_back(val(rng));
+    }
+    m.offset.push_back(m.index.size());
+    m.label.push_back(0.0f);
+  }
+  return m;
+}
+}  // namespace
+
+TEST(SparseKernel, spmv) {
+  const size_t ncol = 1000;
+  CSR m = MakeCSR(3000, ncol, 40);
+  std::vector<float> w(ncol);
+  for (size_t j = 0; j < ncol; ++j) w[j] = 0.001f * j - 0.3f;
+  for (int with_value = 0; with_value < 2; ++with_value) {
+    dmlc::RowBlock<uint32_t> batch = m.Block(with_value != 0);
+    std::vector<float> out(batch.size);
+    dmlc::SpMV(batch, w.data(), ncol, out.data());
+    for (size_t i = 0; i < batch.size; ++i) {
+      EXPECT_NEAR(out[i], batch[i].SDot(w.data(), ncol), 1e-4f);
+    }
+    // a slice keeps its absolute offsets
+    dmlc::RowBlock<uint32_t> part = batch.Slice(100, 200);
+    dmlc::SpMV(part, w.data(), ncol, out.data(), 2);
+    for (size_t i = 0; i < part.size; ++i) {
+      EXPECT_NEAR(out[i], batch[100 + i].SDot(w.data(), ncol), 1e-4f);
+    }
+  }
+}
+
+TEST(SparseKernel, spmv_trans) {
+  const size_t ncol = 500;
+  CSR m = MakeCSR(5000, ncol, 30);
+  dmlc::RowBlock<uint32_t> batch = m.Block(true);
+  std::vector<double> g(batch.size), expect(ncol, 1.0), out(ncol, 1.0);
+  for (size_t i = 0; i < batch.size; ++i) g[i] = (i % 7) * 0.5 - 1.0;
+  for (size_t i = 0; i < batch.size; ++i) {
+    for (size_t j = batch.offset[i]; j < batch.offset[i + 1]; ++j) {
+      expect[batch.index[j]] += g[i] * batch.value[j];
+    }
+  }
+  for (int nthread = 1; nthread <= 4; nthread += 3) {
+    std::fill(out.begin(), out.end(), 1.0);
+    dmlc::SpMVTrans(batch, g.data(), ncol, out.data(), nthread);
+    for (size_t j = 0; j < ncol; ++j) {
+      EXPECT_NEAR(out[j], expect[j], 1e-6);
+    }
+  }
+}
+
+TEST(SparseKernel, spmm) {
+  const size_t ncol = 200, k = 5;
+  CSR m = MakeCSR(300, ncol, 10);
+  dmlc::RowBlock<uint32_t> batch = m.Block(true);
+  std::vector<float> w(ncol * k), out(batch.size * k), col(ncol), ref(batch.size);
+  for (size_t j = 0; j < w.size(); ++j) w[j] = 0.01f * (j % 37);
+  dmlc::SpMM(batch, w.data(), ncol, k, out.data());
+  for (size_t c = 0; c < k; ++c) {
+    for (size_t j = 0; j < ncol; ++j) col[j] = w[j * k + c];
+    dmlc::SpMV(batch, col.data(), ncol, ref.data());
+    for (size_t i = 0; i < batch.size; ++i) {
+      EXPECT_NEAR(out[i * k + c], ref[i], 1e-4f);
+    }
+  }
+}
+
+TEST(SparseKernel, index_bound) {
+  CSR m = MakeCSR(10, 100, 5);
+  std::vector<float> w(50), out(10);
+  EXPECT_THROW(dmlc::SpMV(m.Block(true), w.data(), w.size(), out.data()),
+               dmlc::Error);
+}
@@ -155,6 +155,45 @@ TEST(ThreadGroup, ThreadLaunchQueueThread) {
   CHECK_EQ(queue_thread->size_approx(), 0);
 }
 
+/*!
+ * \brief Test BlockingQueueThread handing batches of items to its callback
+ */
+TEST(ThreadGroup, ThreadLaunchQueueThreadBatch) {
+  using BQ = dmlc::BlockingQueueThread<int, -1>;
+  std::shared_ptr<dmlc::ThreadGroup> thread_group = std::make_shared<dmlc::ThreadGroup>();
+  std::shared_ptr<BQ> queue_thread = std::make_shared<BQ>("BlockingQueueThreadBatch",
+                                                          thread_group.get());
+  constexpr int kNumItems = 1000;
+  constexpr size_t kMaxBatch = 64;
+  std::vector<int> items(kNumItems);
+  for (int i = 0; i < kNumItems; ++i) {
+    items[i] = i;
+  }
+  // Queue everything before the thread starts so that the batches are full
+  queue_thread->enqueue_bulk(items.data(), items.size());
+  std::atomic<int> sum(0), num_items(0), num_batches(0);
+  std::atomic<size_t> largest_batch(0);
+  BQ::launch_run_batch(queue_thread,
+                       [&](int *batch, size_t count) -> int {
+                         for (size_t i = 0; i < count; ++i) {
+                           sum += batch[i];
+                         }
+                         num_items += static_cast<int>(count);
+                         ++num_batches;
+                         if (count > largest_batch) {
+                           largest_batch = count;
+                         }
+                         return 0;
+                       },
+                       kMaxBatch);
+  thread_group->request_shutdown_all(false);
+  thread_group->join_all();
+  GTEST_ASSERT_EQ(num_items.load(), kNumItems);
+  GTEST_ASSERT_EQ(sum.load(), kNumItems * (kNumItems - 1) / 2);
+  GTEST_ASSERT_LE(largest_batch.load(), kMaxBatch);
+  GTEST_ASSERT_LT(num_batches.load(), kNumItems);
+}
+
 using Tick = std::chrono::high_resolution_clock::time_point;
 static inline Tick Now() { return std::chrono::high_resolution_clock::now(); }
 static inline uint64_t GetDurationInNanoseconds(const Tick &t1, const Tick &t2) {
@@ -241,3 +280,72 @@ TEST(ThreadGroup, TimerThreadSimple) {
   GTEST_ASSERT_LE(count, MAX_COUNT_WHILE_SLEEPING); // Should not have had time to do 20 of them
 }
 
+
+/*!
+ * \brief Test TimerWheel with many one-shot timers, a periodic timer and cancellation
+ */
+TEST(ThreadGroup, TimerWheel) {
+  dmlc::TimerWheel wheel;
+  std::thread runner([&wheel]() { wheel.Run(); });
+  constexpr int kNumTimers = 2000;
+  std::atomic<int> fired(0);
+  std::atomic<int> cancelled_fired(0);
+  std::vector<dmlc::TimerWheel::TimerId> to_cancel;
+  for (int i = 0; i < kNumTimers; ++i) {
+    // spread over more than one turn of the first wheel
+    wheel.Schedule(std::chrono::milliseconds(1 + i % 300), [&fired]() { ++fired; });
+    to_cancel.push_back(wheel.Schedule(std::chrono::milliseconds(200 + i % 100),
+                                       [&cancelled_fired]() { ++cancelled_fired; }));
+  }
+  std::atomic<int> periodic(0);
+  dmlc::TimerWheel::TimerId periodic_id =
+    wheel.SchedulePeriodic(std::chrono::milliseconds(TIMER_PERIOD), [&periodic]() { ++periodic; });
+  for (dmlc::TimerWheel::TimerId id : to_cancel) {
+    GTEST_ASSERT_EQ(wheel.Cancel(id), true);
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_DURATION));
+  GTEST_ASSERT_EQ(wheel.Cancel(periodic_id), true);
+  GTEST_ASSERT_EQ(wheel.Cancel(periodic_id), false);
+  wheel.Stop();
+  runner.join();
+  GTEST_ASSERT_EQ(fired.load(), kNumTimers);
+  GTEST_ASSERT_EQ(cancelled_fired.load(), 0);
+  GTEST_ASSERT_GE(periodic.load(), MIN_COUNT_WHILE_SLEEPING);
+  GTEST_ASSERT_LE(periodic.load(), MAX_COUNT_WHILE_SLEEPING);
+  GTEST_ASSERT_EQ(wheel.Size(), 0U);
+}
+
+/*!
+ * \brief Test that the timers of a ThreadGroup share a single timer wheel thread
+ */
+TEST(ThreadGroup, TimersShareWheelThread) {
+  std::shared_ptr<dmlc::ThreadGroup> thread_group = std::make_shared<dmlc::ThreadGroup>();
+  using Duration = std::chrono::milliseconds;
+  constexpr int kNumTimers = 50;
+  std::atomic<int> count(0);
+  for (int i = 0; i < kNumTimers; ++i) {
+    dmlc::CreateTimer(TName("SharedTimer", i), Duration(TIMER_PERIOD), thread_group.get(),
+                      [&count]() -> int {
+                        ++count;
+                        return 0;
+                      });
+  }
+  // the timers are registered by name next to the single timer wheel thread
+  GTEST_ASSERT_EQ(thread_group->size(), static_cast<size_t>(kNumTimers) + 1);
+  GTEST_ASSERT_EQ(dmlc::CreateTimer(TName("SharedTimer", 0), Duration(TIMER_PERIOD),
+                                    thread_group.get(), []() -> int { return 0; }), false);
+  std::this_thread::sleep_for(Duration(SLEEP_DURATION));
+  // a timer looked up by name can be stopped on its own
+  std::shared_ptr<dmlc::ThreadGroup::Thread> timer =
+    thread_group->thread_by_name(TName("SharedTimer", 0));
+  GTEST_ASSERT_NE(timer.get(), nullptr);
+  timer->request_shutdown();
+  GTEST_ASSERT_EQ(thread_group->thread_by_name(TName("SharedTimer", 0)).get(), nullptr);
+  GTEST_ASSERT_EQ(thread_group->size(), static_cast<size_t>(kNumTimers));
+  thread_group->request_shutdown_all();
+  thread_group->join_all();
+  const int final_count = count.load();
+  GTEST_ASSERT_GE(final_count, kNumTimers * static_cast<int>(MIN_COUNT_WHILE_SLEEPING));
+  std::this_thread::sleep_for(Duration(TIMER_PERIOD * 3));
+  GTEST_ASSERT_EQ(count.load(), final_count);
+}
@@ -0,0 +1,162 @@
+// Copyright by Contributors
+#include <dmlc/thread_local.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+std::atomic<int> num_alive(0);
+
+struct Tracked {
+  int64_t value;
+  Tracked() : value(0) { ++num_alive; }
+  ~Tracked() { --num_alive; }
+};
+}  // namespace
+
+TEST(ThreadLocal, registry) {
+  std::atomic<int64_t> retired(0);
+  dmlc::ThreadLocalRegistry<Tracked> registry(
+      [](Tracked *t) { t->value = 1; },
+      [&retired](Tracked *t) { retired += t->value; });
+  const int kThreads = 4;
+  std::mutex mutex;
+  std::condition_variable cond;
+  int ready = 0;
+  bool release = false;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.emplace_back([&, i]() {
+        Tracked *t = registry.Get();
+        EXPECT_EQ(t, registry.Get());
+        t->value += i;
+        std::unique_lock<std::mutex> lock(mutex);
+        ++ready;
+        cond.notify_all();
+        cond.wait(lock, [&release]() { return release; });
+      });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&ready]() { return ready == kThreads; });
+  }
+  // all the threads are alive and parked
+  EXPECT_EQ(registry.NumLive(), static_cast<size_t>(kThreads));
+  int64_t total = 0;
+  registry.ForEach([&total](Tracked &t) { total += t.value; });
+  EXPECT_EQ(total, kThreads + kThreads * (kThreads - 1) / 2);
+  EXPECT_EQ(retired.load(), 0);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    release = true;
+  }
+  cond.notify_all();
+  for (auto &t : threads) t.join();
+  // the exit hook merged the instances, which were destroyed
+  EXPECT_EQ(retired.load(), total);
+  EXPECT_EQ(registry.NumLive(), 0U);
+  EXPECT_EQ(num_alive.load(), 0);
+
+  // the slots of the exited threads are reused
+  for (int i = 0; i < 10; ++i) {
+    std::thread([&registry]() { registry.Get(); }).join();
+  }
+  size_t num_slots = 0;
+  registry.Get();
+  registry.ForEach([&num_slots](Tracked &) { ++num_slots; });
+  EXPECT_EQ(num_slots, 1U);
+}
+
+TEST(ThreadLocal, registry_outlived_by_thread) {
+  std::mutex mutex;
+  std::condition_variable cond;
+  bool registered = false, destroyed = false;
+  std::unique_ptr<dmlc::ThreadLocalRegistry<Tracked> > registry(
+      new dmlc::ThreadLocalRegistry<Tracked>());
+  std::thread worker([&]() {
+      registry->Get();
+      std::unique_lock<std::mutex> lock(mutex);
+      registered = true;
+      cond.notify_all();
+      cond.wait(lock, [&destroyed]() { return destroyed; });
+    });
+  {
+    std::unique_lock<std::mutex> lock(mutex);
+    cond.wait(lock, [&registered]() { return registered; });
+    registry.reset();
+    EXPECT_EQ(num_alive.load(), 0);
+    destroyed = true;
+  }
+  cond.notify_all();
+  worker.join();
+  EXPECT_EQ(num_alive.load(), 0);
+}
+
+TEST(ThreadLocal, registry_destroyed_while_thread_exits) {
+  for (int i = 0; i < 20; ++i) {
+    std::unique_ptr<std::atomic<int> > retired(new std::atomic<int>(0));
+    std::atomic<int> *counter = retired.get();
+    std::unique_ptr<dmlc::ThreadLocalRegistry<Tracked> > registry(
+        new dmlc::ThreadLocalRegistry<Tracked>(
+            dmlc::ThreadLocalRegistry<Tracked>::InitHook(),
+            [counter](Tracked *) {
+              std::this_thread::sleep_for(std::chrono::microseconds(100));
+              counter->fetch_add(1);
+            }));
+    std::atomic<bool> registered(false);
+    std::thread worker([&registry, &registered]() {
+        registry->Get();
+        registered.store(true);
+      });
+    while (!registered.load()) std::this_thread::yield();
+    // the destructor either destroys the instance or waits for the exit hook
+    registry.reset();
+    const int seen = retired->load();
+    worker.join();
+    EXPECT_EQ(retired->load(), seen);
+    EXPECT_EQ(num_alive.load(), 0);
+  }
+}
+
+TEST(ThreadLocal, registry_id_reused) {
+  std::unique_ptr<dmlc::ThreadLocalRegistry<Tracked> > first(
+      new dmlc::ThreadLocalRegistry<Tracked>([](Tracked *t) { t->value = 1; }));
+  first->Get()->value = 5;
+  first.reset();
+  // a registry taking the identifier of the destroyed one starts afresh
+  dmlc::ThreadLocalRegistry<Tracked> second([](Tracked *t) { t->value = 2; });
+  EXPECT_EQ(second.Get()->value, 2);
+  EXPECT_EQ(second.NumLive(), 1U);
+  EXPECT_EQ(num_alive.load(), 1);
+}
+
+TEST(ThreadLocal, arena) {
+  dmlc::ThreadLocalArena *arena = dmlc::ThreadLocalArena::Get();
+  EXPECT_EQ(arena, dmlc::ThreadLocalArena::Get());
+  arena->Reset();
+  std::vector<char*> ptrs;
+  for (int i = 0; i < 1000; ++i) {
+    char *ptr = static_cast<char*>(arena->Allocate(100, 32));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 32, 0U);
+    std::fill(ptr, ptr + 100, static_cast<char>(i));
+    ptrs.push_back(ptr);
+  }
+  char *large = static_cast<char*>(arena->Allocate(1 << 20));
+  std::fill(large, large + (1 << 20), 'x');
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(ptrs[i][0], static_cast<char>(i));
+    EXPECT_EQ(ptrs[i][99], static_cast<char>(i));
+  }
+  EXPECT_EQ(arena->BytesAllocated(), 1000U * 100U + (1U << 20));
+  arena->Reset();
+  EXPECT_EQ(arena->BytesAllocated(), 0U);
+  // the blocks are reused after a reset
+  EXPECT_EQ(arena->Allocate(100, 32), ptrs[0]);
+  std::thread([arena]() { EXPECT_NE(dmlc::ThreadLocalArena::Get(), arena); }).join();
+}
@@ -0,0 +1,90 @@
+// Copyright by Contributors
+#define DMLC_ENABLE_TRACE 1
+#include <dmlc/trace.h>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <sstream>
+#include <string>
+#include <thread>
+
+namespace {
+size_t CountOccurrences(const std::string &text, const std::string &pattern) {
+  size_t count = 0;
+  for (size_t pos = text.find(pattern); pos != std::string::npos;
+       pos = text.find(pattern, pos + 1)) {
+    ++count;
+  }
+  return count;
+}
+}  // namespace
+
+TEST(Trace, scopes) {
+  dmlc::Tracer *tracer = dmlc::Tracer::Get();
+  {
+    DMLC_TRACE_SCOPE("before_start", "test");
+  }
+  tracer->Start();
+  EXPECT_TRUE(tracer->IsRecording());
+  {
+    DMLC_TRACE_SCOPE("outer", "test");
+    DMLC_TRACE_SCOPE("inner", "test");
+  }
+  std::thread worker([]() {
+    for (int i = 0; i < 3; ++i) {
+      DMLC_TRACE_SCOPE("worker", "test");
+    }
+  });
+  worker.join();
+  tracer->Stop();
+  {
+    DMLC_TRACE_SCOPE("after_stop", "test");
+  }
+  EXPECT_EQ(tracer->NumEvents(), 5U);
+  EXPECT_EQ(tracer->NumDropped(), 0U);
+
+  std::ostringstream os;
+  tracer->Dump(&os);
+  const std::string trace = os.str();
+  EXPECT_NE(trace.find("\"traceEvents\""), std::string::npos);
+  EXPECT_EQ(CountOccurrences(trace, "\"ph\": \"X\""), 5U);
+  EXPECT_EQ(CountOccurrences(trace, "\"name\": \"outer\""), 1U);
+  EXPECT_EQ(CountOccurrences(trace, "\"name\": \"worker\""), 3U);
+  EXPECT_EQ(CountOccurrences(trace, "before_start"), 0U);
+  EXPECT_EQ(CountOccurrences(trace, "after_stop"), 0U);
+
+  // a new run discards the events of the previous one
+  tracer->Start();
+  tracer->Stop();
+  EXPECT_EQ(tracer->NumEvents(), 0U);
+}
+
+TEST(Trace, dump_while_recording) {
+  dmlc::Tracer *tracer = dmlc::Tracer::Get();
+  tracer->Start();
+  std::atomic<bool> done(false);
+  std::thread worker([&done]() {
+    for (int i = 0; i < 10000; ++i) {
+      DMLC_TRACE_SCOPE("busy", "test");
+    }
+    done.store(true);
+  });
+  // readers see a prefix of the events while the worker appends
+  size_t last = 0;
+  while (!done.load()) {
+    std::ostringstream os;
+    tracer->Dump(&os);
+    const size_t num_events = tracer->NumEvents();
+    EXPECT_GE(num_events, last);
+    last = num_events;
+  }
+  worker.join();
+  // the events of threads that exited are kept until the next Start
+  for (int t = 0; t < 8; ++t) {
+    std::thread([]() { DMLC_TRACE_SCOPE("short_lived", "test"); }).join();
+  }
+  tracer->Stop();
+  EXPECT_EQ(tracer->NumEvents(), 10008U);
+  tracer->Start();
+  tracer->Stop();
+  EXPECT_EQ(tracer->NumEvents(), 0U);
+}
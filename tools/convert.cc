@@ -0,0 +1,203 @@
+/*!
+ *  Copyright (c) 2019 by Contributors
+ * \file convert.cc
+ * \brief convert text datasets into binary formats that load without parsing.
+ *
+ *  The input is cut into nshard parts that are parsed and written by nworker
+ *  threads, each part going to its own output file, so the shards can later
+ *  be read in parallel or by different machines.
+ *
+ *  Usage:
+ *
+ *    tools/convert input=s3://bucket/train.libsvm output=train format=libsvm \
+ *        to=rowblock nshard=8 nworker=4
+ *
+ *  writes train-0.rec ... train-7.rec, readable with the "rowblock" parser,
+ *  and train-0.idx ... train-7.idx, the record offsets in the format of the
+ *  indexed_recordio splits. to=cache builds the DiskRowIter caches
+ *  train-0.cache ... instead, readable with RowBlockIter::Create and the
+ *  same input, nshard and cache file. Parser arguments, like label_column
+ *  of csv, go in the input uri: input=train.csv?label_column=0
+ */
+#include <dmlc/data.h>
+#include <dmlc/io.h>
+#include <dmlc/logging.h>
+#include <dmlc/parameter.h>
+#include <dmlc/row_block_recordio.h>
+#include <dmlc/timer.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+/*! \brief output format */
+enum OutputFormat {
+  kRowBlock = 0,
+  kCache = 1
+};
+
+struct ConvertParam : public dmlc::Parameter<ConvertParam> {
+  /*! \brief uri of the input */
+  std::string input;
+  /*! \brief prefix of the output files */
+  std::string output;
+  /*! \brief format of the input */
+  std::string format;
+  /*! \brief output format */
+  int to;
+  /*! \brief number of output shards */
+  int nshard;
+  /*! \brief number of shards converted at the same time */
+  int nworker;
+  /*! \brief maximum rows per record of the rowblock output */
+  int rows_per_record;
+  /*! \brief whether the indices are 64 bits */
+  bool index64;
+  DMLC_DECLARE_PARAMETER(ConvertParam) {
+    DMLC_DECLARE_FIELD(input)
+        .describe("Uri of the input, with the parser arguments after '?'.");
+    DMLC_DECLARE_FIELD(output)
+        .describe("Prefix of the output files, shard i goes to <output>-<i>.<ext>.");
+    DMLC_DECLARE_FIELD(format).set_default("libsvm")
+        .describe("Format of the input: libsvm, libfm, csv, ...");
+    DMLC_DECLARE_FIELD(to).set_default(kRowBlock)
+        .add_enum("rowblock", kRowBlock)
+        .add_enum("cache", kCache)
+        .describe("Output format, RowBlock records in RecordIO files (.rec and .idx) "
+                  "or DiskRowIter caches (.cache).");
+    DMLC_DECLARE_FIELD(nshard).set_default(1).set_lower_bound(1)
+        .describe("Number of output shards.");
+    DMLC_DECLARE_FIELD(nworker).set_default(0).set_lower_bound(0)
+        .describe("Number of shards converted at the same time, "
+                  "0 for one per hardware thread.");
+    DMLC_DECLARE_FIELD(rows_per_record).set_default(4096).set_lower_bound(1)
+        .describe("Maximum number of rows in each record of the rowblock output.");
+    DMLC_DECLARE_FIELD(index64).set_default(false)
+        .describe("Store 64 bit feature indices.");
+  }
+};
+
+DMLC_REGISTER_PARAMETER(ConvertParam);
+
+/*! \brief what a shard produced */
+struct ShardResult {
+  /*! \brief number of rows */
+  size_t num_rows;
+  /*! \brief bytes of input read */
+  size_t bytes_read;
+  /*! \brief seconds spent on the shard */
+  double seconds;
+  ShardResult() : num_rows(0), bytes_read(0), seconds(0.0) {}
+};
+
+/*! \return name of the output file of a shard */
+std::string ShardPath(const ConvertParam &param, int shard, const char *ext) {
+  std::ostringstream os;
+  os << param.output << '-' << shard << '.' << ext;
+  return os.str();
+}
+
+template<typename IndexType>
+ShardResult ConvertToRowBlock(const ConvertParam &param, int shard) {
+  ShardResult result;
+  std::unique_ptr<dmlc::Parser<IndexType> > parser(dmlc::Parser<IndexType>::Create(
+      param.input.c_str(), shard, param.nshard, param.format.c_str()));
+  std::unique_ptr<dmlc::Stream> fo(
+      dmlc::Stream::Create(ShardPath(param, shard, "rec").c_str(), "w"));
+  std::unique_ptr<dmlc::Stream> findex(
+      dmlc::Stream::Create(ShardPath(param, shard, "idx").c_str(), "w"));
+  dmlc::RowBlockRecordIOWriter<IndexType> writer(
+      fo.get(), static_cast<size_t>(param.rows_per_record), findex.get());
+  while (parser->Next()) {
+    const dmlc::RowBlock<IndexType> &batch = parser->Value();
+    writer.Write(batch);
+    result.num_rows += batch.size;
+  }
+  result.bytes_read = parser->BytesRead();
+  return result;
+}
+
+template<typename IndexType>
+ShardResult ConvertToCache(const ConvertParam &param, int shard) {
+  ShardResult result;
+  const std::string uri = param.input + '#' + ShardPath(param, shard, "cache");
+  // the cache is built by the constructor
+  std::unique_ptr<dmlc::RowBlockIter<IndexType> > iter(dmlc::RowBlockIter<IndexType>::Create(
+      uri.c_str(), shard, param.nshard, param.format.c_str()));
+  if (iter->Stats() != NULL) {
+    result.num_rows = static_cast<size_t>(iter->Stats()->num_row);
+  } else {
+    iter->BeforeFirst();
+    while (iter->Next()) result.num_rows += iter->Value().size;
+  }
+  return result;
+}
+
+template<typename IndexType>
+ShardResult ConvertShard(const ConvertParam &param, int shard) {
+  dmlc::Stopwatch watch;
+  ShardResult result = param.to == kCache ?
+      ConvertToCache<IndexType>(param, shard) : ConvertToRowBlock<IndexType>(param, shard);
+  result.seconds = watch.Elapsed();
+  return result;
+}
+}  // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 2) {
+    printf("Usage: input=<uri> output=<prefix> [key=value] ...\n%s",
+           ConvertParam::__DOC__().c_str());
+    return 0;
+  }
+  std::map<std::string, std::string> kwargs;
+  for (int i = 1; i < argc; ++i) {
+    const char *eq = strchr(argv[i], '=');
+    CHECK(eq != NULL) << "arguments are key=value pairs, got " << argv[i];
+    kwargs[std::string(argv[i], eq - argv[i])] = std::string(eq + 1);
+  }
+  ConvertParam param;
+  param.Init(kwargs);
+  int nworker = param.nworker;
+  if (nworker == 0) {
+    nworker = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  nworker = std::min(nworker, param.nshard);
+
+  std::vector<ShardResult> results(param.nshard);
+  std::atomic<int> next_shard(0);
+  dmlc::Stopwatch watch;
+  std::vector<std::thread> workers;
+  for (int i = 0; i < nworker; ++i) {
+    workers.emplace_back([&param, &results, &next_shard]() {
+        for (int shard = next_shard++; shard < param.nshard; shard = next_shard++) {
+          results[shard] = param.index64 ?
+              ConvertShard<uint64_t>(param, shard) : ConvertShard<uint32_t>(param, shard);
+          LOG(INFO) << "shard " << shard << ": " << results[shard].num_rows << " rows, "
+                    << results[shard].bytes_read / 1e6 << " MB in "
+                    << results[shard].seconds << " sec";
+        }
+      });
+  }
+  for (std::thread &worker : workers) worker.join();
+  const double seconds = watch.Elapsed();
+
+  size_t num_rows = 0, bytes_read = 0;
+  for (const ShardResult &result : results) {
+    num_rows += result.num_rows;
+    bytes_read += result.bytes_read;
+  }
+  LOG(INFO) << "converted " << num_rows << " rows into " << param.nshard << " shards in "
+            << seconds << " sec, " << num_rows / std::max(seconds, 1e-9) << " rows/sec";
+  if (bytes_read != 0) {
+    LOG(INFO) << "read " << bytes_read / 1e6 << " MB, "
+              << bytes_read / 1e6 / std::max(seconds, 1e-9) << " MB/sec";
+  }
+  return 0;
+}
@@ -0,0 +1,7 @@
+ALL_TOOL=tools/convert
+
+
+tools/convert: tools/convert.cc libdmlc.a
+
+$(ALL_TOOL) :
+	$(CXX) $(CFLAGS) -o $@ $(filter %.cpp %.o %.c %.cc %.a,  $^) $(LDFLAGS)